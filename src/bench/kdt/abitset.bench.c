@@ -0,0 +1,105 @@
+#include <kdt/abitset.h>
+#include <kdt/bitset.h>
+#include <kdt/def.h>
+#include <kdt/tims.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define _SIZE 4096
+#define _ROUNDS_PER_THREAD 1000000
+#define _HELD 16
+
+typedef struct _Set _Set;
+
+struct _Set {
+    const char *name;
+    bool (*allocate)(void *, size_t *);
+    void (*free)(void *, size_t);
+    void *bits;
+};
+
+static bool AllocateBitset(void *set, size_t *index);
+static void SetBitset(void *set, size_t index);
+static bool AllocateAbitset(void *set, size_t *index);
+static void SetAbitset(void *set, size_t index);
+static void *Churn(void *set);
+static tims_t Run(_Set *set, size_t threads);
+
+static size_t bitset_words[_SIZE / (sizeof(size_t) * 8)];
+static bitset_t bitset;
+
+static atomic_size_t abitset_words[ABITSET_WORDS(_SIZE)];
+static abitset_t abitset;
+
+/*
+ * Has 1 to KDT_THREADS threads repeatedly allocate and free slots of a
+ * mutex protected `bitset_t` and of a lock-free `abitset_t`, each thread
+ * holding up to _HELD slots at a time.
+ */
+void bench_abitset_bench_c() {
+    memset(bitset_words, 0xff, sizeof(bitset_words));
+    bitset_Init(&bitset, (uint8_t *) bitset_words, sizeof(bitset_words));
+    abitset_Init(&abitset, abitset_words, _SIZE);
+
+    _Set sets[] = {
+        {.name = "bitset_t", .allocate = AllocateBitset, .free = SetBitset, .bits = &bitset},
+        {.name = "abitset_t", .allocate = AllocateAbitset, .free = SetAbitset, .bits = &abitset},
+    };
+
+    printf("%-10s %8s %12s %14s\n", "Set", "Threads", "Seconds", "Allocations/s");
+    for (size_t threads = 1; threads <= KDT_THREADS; threads *= 2) {
+        for (size_t i = 0; i < sizeof(sets) / sizeof(_Set); ++i) {
+            const tims_t seconds = Run(&sets[i], threads);
+            printf("%-10s %8zu %12.3f %14.0f\n", sets[i].name, threads, seconds,
+                   (double) (threads * _ROUNDS_PER_THREAD) / seconds);
+        }
+    }
+}
+
+static bool AllocateBitset(void *set, size_t *index) {
+    return bitset_Allocate(set, index);
+}
+
+static void SetBitset(void *set, size_t index) {
+    bitset_Set(set, index);
+}
+
+static bool AllocateAbitset(void *set, size_t *index) {
+    return abitset_Allocate(set, index);
+}
+
+static void SetAbitset(void *set, size_t index) {
+    abitset_Set(set, index);
+}
+
+static void *Churn(void *set) {
+    _Set *_set = set;
+    size_t held[_HELD];
+    for (size_t i = 0; i < _ROUNDS_PER_THREAD; ++i) {
+        size_t *slot = &held[i % _HELD];
+        if (i >= _HELD) {
+            _set->free(_set->bits, *slot);
+        }
+        while (!_set->allocate(_set->bits, slot)) {
+            sched_yield();
+        }
+    }
+    for (size_t i = 0; i < _HELD; ++i) {
+        _set->free(_set->bits, held[i]);
+    }
+    return NULL;
+}
+
+static tims_t Run(_Set *set, size_t threads) {
+    pthread_t churners[KDT_THREADS];
+
+    const tims_t start = tims_Now();
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_create(&churners[i], NULL, Churn, set);
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        pthread_join(churners[i], NULL);
+    }
+    return tims_Now() - start;
+}
@@ -0,0 +1,121 @@
+#include <kdt/cbuf.h>
+#include <kdt/def.h>
+#include <kdt/mpmc.h>
+#include <kdt/tims.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define _CAPACITY 512
+#define _ELEMENTS_PER_THREAD 1000000
+#define _POP_MANY 16
+
+typedef struct _Queue _Queue;
+
+struct _Queue {
+    const char *name;
+    bool (*push)(void *, size_t);
+    size_t (*pop)(void *, size_t *, size_t);
+    void *queue;
+};
+
+static bool PushCbufz(void *queue, size_t element);
+static size_t PopCbufz(void *queue, size_t *out, size_t max);
+static bool PushMpmcz(void *queue, size_t element);
+static size_t PopMpmcz(void *queue, size_t *out, size_t max);
+static size_t PopManyMpmcz(void *queue, size_t *out, size_t max);
+static void *Produce(void *queue);
+static void *Consume(void *queue);
+static tims_t Run(_Queue *queue, size_t pairs);
+
+static size_t cbufz_buffer[_CAPACITY + 1];
+static cbufz_t cbufz;
+
+static mpmcz_Cell mpmcz_buffer[_CAPACITY];
+static mpmcz_t mpmcz;
+
+/*
+ * Moves elements from N producer threads to N consumer threads via a mutex
+ * protected `cbufz_t` and a lock-free `mpmcz_t` of the same capacity, for N
+ * between 1 and KDT_THREADS. The `mpmcz_t` is tested both with consumers
+ * popping one element at a time and up to _POP_MANY elements at a time.
+ */
+void bench_mpmc_bench_c() {
+    cbufz_Init(&cbufz, cbufz_buffer, _CAPACITY + 1);
+    mpmcz_Init(&mpmcz, mpmcz_buffer, _CAPACITY);
+
+    _Queue queues[] = {
+        {.name = "cbufz_t", .push = PushCbufz, .pop = PopCbufz, .queue = &cbufz},
+        {.name = "mpmcz_t", .push = PushMpmcz, .pop = PopMpmcz, .queue = &mpmcz},
+        {.name = "mpmcz_t*", .push = PushMpmcz, .pop = PopManyMpmcz, .queue = &mpmcz},
+    };
+
+    printf("%-10s %8s %12s %14s\n", "Queue", "Threads", "Seconds", "Elements/s");
+    for (size_t pairs = 1; pairs <= KDT_THREADS; pairs *= 2) {
+        for (size_t i = 0; i < sizeof(queues) / sizeof(_Queue); ++i) {
+            const tims_t seconds = Run(&queues[i], pairs);
+            printf("%-10s %4zu+%-3zu %12.3f %14.0f\n", queues[i].name, pairs, pairs,
+                   seconds, (double) (pairs * _ELEMENTS_PER_THREAD) / seconds);
+        }
+    }
+}
+
+static bool PushCbufz(void *queue, size_t element) {
+    return cbufz_Push(queue, element);
+}
+
+static size_t PopCbufz(void *queue, size_t *out, size_t max) {
+    (void) max;
+    return cbufz_Pop(queue, out) ? 1 : 0;
+}
+
+static bool PushMpmcz(void *queue, size_t element) {
+    return mpmcz_Push(queue, element);
+}
+
+static size_t PopMpmcz(void *queue, size_t *out, size_t max) {
+    (void) max;
+    return mpmcz_Pop(queue, out) ? 1 : 0;
+}
+
+static size_t PopManyMpmcz(void *queue, size_t *out, size_t max) {
+    return mpmcz_PopMany(queue, out, max < _POP_MANY ? max : _POP_MANY);
+}
+
+static void *Produce(void *queue) {
+    _Queue *_queue = queue;
+    for (size_t i = 0; i < _ELEMENTS_PER_THREAD; ++i) {
+        while (!_queue->push(_queue->queue, i)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *Consume(void *queue) {
+    _Queue *_queue = queue;
+    size_t elements[_POP_MANY];
+    for (size_t i = 0; i < _ELEMENTS_PER_THREAD;) {
+        const size_t max = _ELEMENTS_PER_THREAD - i;
+        size_t count;
+        while ((count = _queue->pop(_queue->queue, elements, max)) == 0) {
+            sched_yield();
+        }
+        i += count;
+    }
+    return NULL;
+}
+
+static tims_t Run(_Queue *queue, size_t pairs) {
+    pthread_t producers[KDT_THREADS], consumers[KDT_THREADS];
+
+    const tims_t start = tims_Now();
+    for (size_t i = 0; i < pairs; ++i) {
+        pthread_create(&producers[i], NULL, Produce, queue);
+        pthread_create(&consumers[i], NULL, Consume, queue);
+    }
+    for (size_t i = 0; i < pairs; ++i) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+    return tims_Now() - start;
+}
@@ -0,0 +1,153 @@
+#include <kdt/pnet/pnet.h>
+#include <kdt/tims.h>
+#include <stdio.h>
+
+#define _ROUND_TRIPS 200
+#define _BURST 2000
+#define _PAYLOAD_SIZE 64
+#define _TIMEOUT 5.0
+
+typedef struct _Profile _Profile;
+
+struct _Profile {
+    const char *name;
+    pnet_Profile profile;
+};
+
+static err_t Open(const pnet_Profile *profile);
+static err_t Send(pnet_t *from, const pnet_Host *to);
+static size_t Receive(pnet_t *pnet, size_t count, tims_t deadline);
+static void Run(const _Profile *profile);
+
+static pnet_t client, server;
+static pnet_Host client_host, server_host;
+
+/*
+ * Sends small messages back and forth via TCP between two PNET structures on
+ * the loopback interface, once per socket profile. Replies are sent as new
+ * messages via connections of their own, rather than as responses via the
+ * connections of their requests, which means that each connection only ever
+ * carries data in one direction, making the interaction between Nagle's
+ * algorithm and delayed acknowledgements apparent.
+ * The first round trip includes the setup of both connections.
+ */
+void bench_pnet_bench_c() {
+    const _Profile profiles[] = {
+        {.name = "default", .profile = {0}},
+        {.name = "nodelay", .profile = {.no_delay = true}},
+#ifdef KDT_USE_TCP_QUICKACK
+        {.name = "quickack", .profile = {.no_delay = true, .quick_ack = true}},
+#endif
+#ifdef KDT_USE_TCP_FASTOPEN
+        {.name = "fastopen", .profile = {.no_delay = true, .fast_open = true}},
+#endif
+        {.name = "buffers", .profile = {
+            .no_delay = true,
+            .send_buffer_size = 262144,
+            .receive_buffer_size = 262144,
+        }},
+    };
+
+    printf("%-10s %12s %12s %14s\n", "Profile", "First (us)", "RTT (us)", "Messages/s");
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(_Profile); ++i) {
+        Run(&profiles[i]);
+    }
+}
+
+static err_t Open(const pnet_Profile *profile) {
+    client_host = (pnet_Host) {
+        .internet = PNET_INTERNET_IPV4,
+        .transport = PNET_TRANSPORT_TCP,
+        .address = {127, 0, 0, 1},
+    };
+    server_host = client_host;
+
+    err_t err;
+    if ((err = pnet_OpenShardsWithProfile(&client, 1, &client_host, profile)) != ERR_NONE) {
+        return err;
+    }
+    if ((err = pnet_OpenShardsWithProfile(&server, 1, &server_host, profile)) != ERR_NONE) {
+        pnet_Close(&client);
+        return err;
+    }
+    return ERR_NONE;
+}
+
+static err_t Send(pnet_t *from, const pnet_Host *to) {
+    pnet_Message *message = pnet_NewMessageWait(from, _PAYLOAD_SIZE, _TIMEOUT);
+    if (message == NULL) {
+        return ERR_TIMEOUT;
+    }
+    message->receiver = *to;
+    message->nonce = kint_Random();
+    uint8_t payload[_PAYLOAD_SIZE] = {0};
+    mem_Write(&message->data, payload, sizeof(payload));
+    return pnet_SendWait(from, message, _TIMEOUT);
+}
+
+/*
+ * Both structures are polled by the calling thread, as the one not expected
+ * to receive anything may still have messages to send. Both are polled at
+ * least once, even if `deadline` has already passed.
+ */
+static size_t Receive(pnet_t *pnet, size_t count, tims_t deadline) {
+    pnet_t *other = pnet == &client ? &server : &client;
+    size_t received = 0;
+    do {
+        pnet_Event *events[16];
+        size_t n = 0;
+        pnet_PollBatch(other, events, 16, &n);
+        pnet_FreeEvents(other, events, n);
+        if (pnet_PollBatch(pnet, events, 16, &n) != ERR_NONE) {
+            continue;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (events[i]->as_type == PNET_EVENT_MESSAGE) {
+                received += 1;
+            }
+        }
+        pnet_FreeEvents(pnet, events, n);
+    } while (received < count && tims_Now() < deadline);
+    return received;
+}
+
+static void Run(const _Profile *profile) {
+    err_t err = Open(&profile->profile);
+    if (err != ERR_NONE) {
+        printf("%-10s failed to open: %s (%d)\n", profile->name,
+               err_GetDescription(err), err);
+        return;
+    }
+
+    tims_t first = -1.0, rtt = -1.0, rate = -1.0;
+    size_t received = 0;
+    tims_t start = tims_Now();
+    for (size_t i = 0; i <= _ROUND_TRIPS; ++i) {
+        if (Send(&client, &server_host) != ERR_NONE ||
+            Receive(&server, 1, tims_Now() + _TIMEOUT) != 1 ||
+            Send(&server, &client_host) != ERR_NONE ||
+            Receive(&client, 1, tims_Now() + _TIMEOUT) != 1) {
+            goto leave;
+        }
+        if (i == 0) {
+            first = tims_Now() - start;
+            start = tims_Now();
+        }
+    }
+    rtt = (tims_Now() - start) / _ROUND_TRIPS;
+
+    start = tims_Now();
+    for (size_t i = 0; i < _BURST; ++i) {
+        if (Send(&client, &server_host) != ERR_NONE) {
+            goto leave;
+        }
+        received += Receive(&server, _BURST, 0.0);
+    }
+    received += Receive(&server, _BURST - received, tims_Now() + _TIMEOUT);
+    rate = (tims_t) received / (tims_Now() - start);
+
+leave:
+    printf("%-10s %12.1f %12.1f %14.0f\n", profile->name, first * 1e6, rtt * 1e6, rate);
+    pnet_Close(&server);
+    pnet_Close(&client);
+}
@@ -0,0 +1,18 @@
+#include <stdio.h>
+
+void bench_abitset_bench_c();
+void bench_mpmc_bench_c();
+void bench_pnet_bench_c();
+
+int main() {
+    printf("bench/abitset.bench.c\n");
+    bench_abitset_bench_c();
+
+    printf("bench/mpmc.bench.c\n");
+    bench_mpmc_bench_c();
+
+    printf("bench/pnet.bench.c\n");
+    bench_pnet_bench_c();
+
+    return 0;
+}
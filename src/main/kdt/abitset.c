@@ -0,0 +1,117 @@
+#include "abitset.h"
+#include <assert.h>
+#include <kdt/def.h>
+
+/// Word at which the calling thread next starts looking for free bits.
+static _Thread_local size_t hint = SIZE_MAX;
+
+/// Source of initial thread hints.
+static atomic_size_t hints = 0;
+
+static
+size_t CountTrailingZeroes(size_t word);
+
+inline
+void abitset_Init(abitset_t *abitset, atomic_size_t *words, size_t size) {
+    assert(abitset != NULL);
+    assert(words != NULL);
+
+    const size_t count = ABITSET_WORDS(size);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bits = size - i * ABITSET_WORD_BITS;
+        atomic_init(&words[i], bits >= ABITSET_WORD_BITS
+                               ? SIZE_MAX
+                               : ((size_t) 1 << bits) - 1);
+    }
+    abitset->words = words;
+    abitset->count = count;
+}
+
+/*
+ * Threads are given distinct initial hints, spread out across the set, and
+ * then keep starting from the word they last allocated a bit from, which
+ * makes concurrent allocations unlikely to contend for the same word. A bit is
+ * claimed by atomically clearing it, which only fails if another thread
+ * cleared it first, in which case another bit in the same word is tried.
+ */
+bool abitset_Allocate(abitset_t *abitset, size_t *index) {
+    assert(abitset != NULL);
+    assert(index != NULL);
+
+    const size_t count = abitset->count;
+    if (count == 0) {
+        return false;
+    }
+    if (hint == SIZE_MAX) {
+        hint = atomic_fetch_add_explicit(&hints, 7, memory_order_relaxed);
+    }
+    const size_t start = hint % count;
+    for (size_t n = 0; n < count; ++n) {
+        const size_t i = (start + n) % count;
+        atomic_size_t *word = &abitset->words[i];
+
+        size_t bits = atomic_load_explicit(word, memory_order_relaxed);
+        while (bits != 0) {
+            const size_t bit = CountTrailingZeroes(bits);
+            const size_t mask = (size_t) 1 << bit;
+            bits = atomic_fetch_and_explicit(word, ~mask, memory_order_acquire);
+            if ((bits & mask) != 0) {
+                hint = i;
+                *index = i * ABITSET_WORD_BITS + bit;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+inline
+void abitset_Clear(abitset_t *abitset, size_t index) {
+    assert(abitset != NULL);
+    assert(abitset->count > index / ABITSET_WORD_BITS);
+
+    const size_t mask = (size_t) 1 << (index % ABITSET_WORD_BITS);
+    atomic_fetch_and_explicit(&abitset->words[index / ABITSET_WORD_BITS], ~mask,
+                              memory_order_acq_rel);
+}
+
+inline
+void abitset_Set(abitset_t *abitset, size_t index) {
+    assert(abitset != NULL);
+    assert(abitset->count > index / ABITSET_WORD_BITS);
+
+    const size_t mask = (size_t) 1 << (index % ABITSET_WORD_BITS);
+    atomic_fetch_or_explicit(&abitset->words[index / ABITSET_WORD_BITS], mask,
+                             memory_order_release);
+}
+
+void abitset_SetMany(abitset_t *abitset, const size_t *indexes, size_t count) {
+    assert(abitset != NULL);
+    assert(indexes != NULL || count == 0);
+
+    size_t i = 0;
+    while (i < count) {
+        const size_t word = indexes[i] / ABITSET_WORD_BITS;
+        assert(abitset->count > word);
+
+        size_t mask = 0;
+        for (; i < count && indexes[i] / ABITSET_WORD_BITS == word; ++i) {
+            mask |= (size_t) 1 << (indexes[i] % ABITSET_WORD_BITS);
+        }
+        atomic_fetch_or_explicit(&abitset->words[word], mask, memory_order_release);
+    }
+}
+
+static
+size_t CountTrailingZeroes(size_t word) {
+#ifdef KDT_GCC5_BUILTINS
+    return (size_t) __builtin_ctzll((unsigned long long) word);
+#else
+    size_t bit = 0;
+    while ((word & 1u) == 0) {
+        word >>= 1u;
+        bit += 1;
+    }
+    return bit;
+#endif
+}
@@ -0,0 +1,116 @@
+/**
+ * Lock-free bit set utilities.
+ *
+ * @file
+ */
+#ifndef KDT_ABITSET_H
+#define KDT_ABITSET_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Number of bits in each `abitset_t` word.
+ */
+#define ABITSET_WORD_BITS (sizeof(size_t) * 8)
+
+/**
+ * Number of words required to hold a `abitset_t` of `SIZE` bits.
+ */
+#define ABITSET_WORDS(SIZE) \
+    (((SIZE) / ABITSET_WORD_BITS) + (((SIZE) % ABITSET_WORD_BITS) == 0 ? 0 : 1))
+
+typedef struct abitset_t abitset_t;
+
+/**
+ * A collection of individually addressable bits, used for keeping track of
+ * allocated slots in some table.
+ *
+ * Unlike `bitset_t`, bits are read and modified via atomic word operations
+ * rather than while holding a lock. Also, each thread starts looking for free
+ * bits where it last found one, rather than at the beginning of the set,
+ * which means that threads allocating at the same time tend to operate on
+ * different words.
+ */
+struct abitset_t {
+    /// Pointer to first word of bit set.
+    atomic_size_t *words;
+
+    /// Number of words in bit set.
+    size_t count;
+};
+
+/**
+ * Initializes `abitset`, setting the first `size` bits and clearing all other.
+ *
+ * @note Not thread-safe.
+ *
+ * @param abitset Pointer to uninitialized bit set.
+ * @param words Pointer to beginning of bit set memory, which must fit
+ *              `ABITSET_WORDS(size)` words.
+ * @param size Number of bits in bit set.
+ */
+void abitset_Init(abitset_t *abitset, atomic_size_t *words, size_t size);
+
+/**
+ * Finds a free bit in `abitset`, clears it, and writes its position to
+ * `index`.
+ *
+ * @note Set (1) bits are considered free, while cleared (0) bits are
+ * considered already allocated.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param abitset Pointer to bit set.
+ * @param index Pointer to allocated bit index receiver.
+ * @return Whether or not there existed a free bit in `abitset`.
+ */
+bool abitset_Allocate(abitset_t *abitset, size_t *index);
+
+/**
+ * Clears `abitset` bit at `index`.
+ *
+ * @note It is the responsibility of the caller to ensure `index` is not out of
+ * bounds.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param abitset Pointer to bit set.
+ * @param index Index of bit to clear (0).
+ */
+void abitset_Clear(abitset_t *abitset, size_t index);
+
+/**
+ * Sets `abitset` bit at `index`.
+ *
+ * @note It is the responsibility of the caller to ensure `index` is not out of
+ * bounds.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param abitset Pointer to bit set.
+ * @param index Index of bit to set (1).
+ */
+void abitset_Set(abitset_t *abitset, size_t index);
+
+/**
+ * Sets `abitset` bits at each of the `count` `indexes`.
+ *
+ * Bits sharing the same word are set together, which makes setting many bits
+ * cheaper than calling `abitset_Set()` once per bit, especially if `indexes`
+ * are sorted.
+ *
+ * @note It is the responsibility of the caller to ensure no index is out of
+ * bounds.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param abitset Pointer to bit set.
+ * @param indexes Pointer to array of indexes of bits to set (1).
+ * @param count Number of indexes in `indexes`.
+ */
+void abitset_SetMany(abitset_t *abitset, const size_t *indexes, size_t count);
+
+#endif
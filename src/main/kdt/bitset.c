@@ -25,17 +25,17 @@ bool bitset_Allocate(bitset_t *bitset, size_t *index) {
         {
             unsigned long *words = (unsigned long *) bitset->bytes;
             const size_t end = size / sizeof(unsigned long);
-            while (i + sizeof(unsigned long) <= end) {
+            for (; i < end; ++i) {
                 unsigned long word = words[i];
                 if (word != 0) {
                     bit = __builtin_ffsl(word) - 1u;
-                    words[i] &= ~(1u << bit);
-                    *index = (i * 8u) + bit;
+                    words[i] &= ~(1ul << bit);
+                    *index = (i * sizeof(unsigned long) * 8u) + bit;
                     status = true;
                     goto leave;
                 }
-                i += sizeof(unsigned long);
             }
+            i *= sizeof(unsigned long);
         }
         {
             uint8_t *bytes = bitset->bytes;
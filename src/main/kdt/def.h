@@ -38,19 +38,29 @@
 #define KDT_THREADS 4
 #endif
 
+#ifndef KDT_SHARDS
+/// Number of network shards, each polled by its own subset of worker threads.
+#define KDT_SHARDS 1
+#endif
+
+#ifndef KDT_N_ACCEPT
+/// Maximum number of inbound network connections accepted per poll.
+#define KDT_N_ACCEPT 64
+#endif
+
 #ifndef KDT_N_BACKLOG
 /// Highest number of allowed pending network connections.
 #define KDT_N_BACKLOG 24
 #endif
 
 #ifndef KDT_N_BUFFER_I_COUNT
-/// Maximum number of pending inbound network messages.
-#define KDT_N_BUFFER_I_COUNT 128
+/// Maximum number of pending inbound network messages. Must be a power of two.
+#define KDT_N_BUFFER_I_COUNT 512
 #endif
 
 #ifndef KDT_N_BUFFER_O_COUNT
-/// Maximum number of pending outbound network messages.
-#define KDT_N_BUFFER_O_COUNT 256
+/// Maximum number of pending outbound network messages. Must be a power of two.
+#define KDT_N_BUFFER_O_COUNT 512
 #endif
 
 #ifndef KDT_N_BUFFER_SIZE
@@ -58,11 +68,145 @@
 #define KDT_N_BUFFER_SIZE 65536
 #endif
 
+#ifndef KDT_N_BATCH
+/// Maximum number of socket operations submitted together.
+#define KDT_N_BATCH 64
+#endif
+
+#ifndef KDT_N_CONNECTIONS
+/// Maximum number of inbound network connections kept open.
+#define KDT_N_CONNECTIONS 256
+#endif
+
+#ifndef KDT_N_GATHER
+/// Maximum number of outbound network messages sent via the same connection by
+/// a single write.
+#define KDT_N_GATHER 16
+#endif
+
+#ifndef KDT_N_PEER_CREDITS
+/// Maximum number of outbound network requests in flight to any single peer.
+#define KDT_N_PEER_CREDITS 64
+#endif
+
+#ifndef KDT_N_PEER_CREDIT_BUCKETS
+/// Number of in-flight request counters, shared by all peers hashed to each.
+#define KDT_N_PEER_CREDIT_BUCKETS 256
+#endif
+
+#ifndef KDT_N_POLL_EVENTS
+/// Maximum number of socket readiness events collected per epoll_wait() call.
+#define KDT_N_POLL_EVENTS 64
+#endif
+
+#ifndef KDT_N_POOL
+/// Maximum number of reusable outbound network connections kept open.
+#define KDT_N_POOL 64
+#endif
+
+#ifndef KDT_N_POOL_HOST
+/// Maximum number of outbound network connections open to any single host.
+#define KDT_N_POOL_HOST 4
+#endif
+
+#ifndef KDT_N_RECEIVE_RATE
+/// Lowest rate, in bytes per second, at which inbound network messages larger
+/// than their headers must be received, in addition to KDT_T_RECEIVE.
+#define KDT_N_RECEIVE_RATE 16384
+#endif
+
+#ifndef KDT_N_RETRANSMIT
+/// Number of retransmission timeouts after which an outbound network message
+/// that could not be sent, or that was not acknowledged, is abandoned.
+#define KDT_N_RETRANSMIT 4
+#endif
+
+#ifndef KDT_N_RTT_PEERS
+/// Number of peers of which round-trip times are kept track of, per shard.
+#define KDT_N_RTT_PEERS 256
+#endif
+
+#ifndef KDT_N_RTT_PROBES
+/// Number of sent network requests awaiting replies that are kept track of for
+/// measuring round-trip times, per shard.
+#define KDT_N_RTT_PROBES 256
+#endif
+
+#ifndef KDT_N_SLAB_S_COUNT
+/// Number of small network message buffers, per direction.
+#define KDT_N_SLAB_S_COUNT 512
+#endif
+
+#ifndef KDT_N_SLAB_S_SIZE
+/// Maximum payload size of small network message buffers.
+#define KDT_N_SLAB_S_SIZE 256
+#endif
+
+#ifndef KDT_N_SLAB_M_COUNT
+/// Number of medium-sized network message buffers, per direction.
+#define KDT_N_SLAB_M_COUNT 64
+#endif
+
+#ifndef KDT_N_SLAB_M_SIZE
+/// Maximum payload size of medium-sized network message buffers.
+#define KDT_N_SLAB_M_SIZE 4096
+#endif
+
+#ifndef KDT_N_SLAB_L_COUNT
+/// Number of large network message buffers, each fitting KDT_N_BUFFER_SIZE.
+#define KDT_N_SLAB_L_COUNT 16
+#endif
+
+#ifndef KDT_N_SOCKETS
+/// Highest socket file descriptor plus one that can be polled via epoll(), or
+/// be tracked as an inbound connection.
+#define KDT_N_SOCKETS 4096
+#endif
+
+#ifndef KDT_N_WEIGHT_HIGH
+/// Number of queued high priority outbound network messages sent for every
+/// KDT_N_WEIGHT_NORMAL normal and KDT_N_WEIGHT_LOW low priority messages.
+#define KDT_N_WEIGHT_HIGH 16
+#endif
+
+#ifndef KDT_N_WEIGHT_LOW
+/// Number of queued low priority outbound network messages sent for every
+/// KDT_N_WEIGHT_HIGH high and KDT_N_WEIGHT_NORMAL normal priority messages.
+#define KDT_N_WEIGHT_LOW 1
+#endif
+
+#ifndef KDT_N_WEIGHT_NORMAL
+/// Number of queued normal priority outbound network messages sent for every
+/// KDT_N_WEIGHT_HIGH high and KDT_N_WEIGHT_LOW low priority messages.
+#define KDT_N_WEIGHT_NORMAL 4
+#endif
+
+#ifndef KDT_T_CONNECT
+/// Time, in seconds, after which an outbound connection attempt is abandoned.
+#define KDT_T_CONNECT 0.5
+#endif
+
+#ifndef KDT_T_CONNECTION_IDLE
+/// Time, in seconds, after which an inbound connection without traffic is closed.
+#define KDT_T_CONNECTION_IDLE 60
+#endif
+
 #ifndef KDT_T_EXPIRE
 /// Time, in seconds, after which a stored key/value pair expires.
 #define KDT_T_EXPIRE 86410
 #endif
 
+#ifndef KDT_T_POOL_IDLE
+/// Time, in seconds, after which an unused outbound connection is closed.
+#define KDT_T_POOL_IDLE 30
+#endif
+
+#ifndef KDT_T_RECEIVE
+/// Time, in seconds, after which an inbound network message, of which some but
+/// not all bytes have been received, is abandoned and its connection closed.
+#define KDT_T_RECEIVE 2.0
+#endif
+
 #ifndef KDT_T_REFRESH
 /// Time, in seconds, after which an unaccessed bucket must be refreshed.
 #define KDT_T_REFRESH 3600
@@ -78,6 +222,32 @@
 #define KDT_T_REPUBLISH 86400
 #endif
 
+#ifndef KDT_T_RETRANSMIT
+/// Retransmission timeout, in seconds, of peers with unknown round-trip times.
+/// An unacknowledged datagram is sent again when its timeout expires.
+#define KDT_T_RETRANSMIT 0.25
+#endif
+
+#ifndef KDT_T_RTO_MAX
+/// Largest retransmission timeout, in seconds, estimated from round-trip times.
+#define KDT_T_RTO_MAX 5.0
+#endif
+
+#ifndef KDT_T_RTO_MIN
+/// Smallest retransmission timeout, in seconds, estimated from round-trip times.
+#define KDT_T_RTO_MIN 0.05
+#endif
+
+#ifndef KDT_T_TICK
+/// Resolution, in seconds, of network message timers.
+#define KDT_T_TICK 0.001
+#endif
+
+#ifndef KDT_T_WAIT_PENDING
+/// Maximum time, in seconds, sockets are waited for while messages are pending.
+#define KDT_T_WAIT_PENDING 0.001
+#endif
+
 #if KDT_B % 8 != 0
 #error KDT_B must be a multiple of 8.
 #endif
@@ -90,6 +260,38 @@
 //#error KDT_THREADS must be at least 1.
 //#endif
 
+#if KDT_N_CONNECTIONS < 1 || KDT_N_CONNECTIONS > KDT_N_SOCKETS
+#error KDT_N_CONNECTIONS must be at least 1 and at most KDT_N_SOCKETS.
+#endif
+
+#if KDT_N_GATHER < 1 || KDT_N_GATHER > 512
+#error KDT_N_GATHER must be at least 1 and at most 512.
+#endif
+
+#if KDT_N_RECEIVE_RATE < 1
+#error KDT_N_RECEIVE_RATE must be at least 1.
+#endif
+
+#if KDT_N_RETRANSMIT < 1
+#error KDT_N_RETRANSMIT must be at least 1.
+#endif
+
+#if KDT_N_RTT_PEERS < 1 || KDT_N_RTT_PROBES < 1
+#error KDT_N_RTT_PEERS and KDT_N_RTT_PROBES must be at least 1.
+#endif
+
+#if KDT_N_WEIGHT_HIGH < 1 || KDT_N_WEIGHT_NORMAL < 1 || KDT_N_WEIGHT_LOW < 1
+#error KDT_N_WEIGHT_HIGH, KDT_N_WEIGHT_NORMAL and KDT_N_WEIGHT_LOW must be at least 1.
+#endif
+
+#if KDT_SHARDS < 1
+#error KDT_SHARDS must be at least 1.
+#endif
+
+#if KDT_SHARDS > KDT_THREADS
+#error KDT_SHARDS must not be larger than KDT_THREADS.
+#endif
+
 #if KDT_T_EXPIRE <= KDT_T_REPUBLISH
 #error KDT_T_EXPIRE must be larger than KDT_T_REPUBLISH.
 #endif
@@ -12,6 +12,9 @@
      }                        \
 } while (0)
 
+/// Maximum number of events handled per poll.
+#define _POLL_BATCH 16
+
 err_t _kdm_InitProtocol(_kdm_Protocol *protocol, kvs_t *store, pnet_t *pnet) {
     // Load or generate client ID.
     {
@@ -45,7 +48,7 @@ kint_t *_kdm_GetClientID(_kdm_Protocol *protocol) {
 }
 
 err_t _kdm_Join(_kdm_Protocol *protocol, const pnet_Host *peer) {
-    pnet_Message *message = pnet_NewMessage(protocol->pnet);
+    pnet_Message *message = pnet_NewMessage(protocol->pnet, 2 * sizeof(kint_t));
     if (message == NULL) {
         return ENOMEM;
     }
@@ -66,26 +69,30 @@ err_t _kdm_Join(_kdm_Protocol *protocol, const pnet_Host *peer) {
 
 void LogError(pnet_EventError *error);
 
-err_t _kdm_Poll(_kdm_Protocol *protocol) {
-    pnet_Event *event = NULL;
-    _TRY(pnet_Poll(protocol->pnet, &event));
-    if (event == NULL) {
+err_t _kdm_Poll(pnet_t *pnet, tims_t timeout) {
+    pnet_Event *events[_POLL_BATCH];
+    size_t count;
+    _TRY(pnet_PollBatchWait(pnet, events, _POLL_BATCH, &count, timeout));
+    if (count == 0) {
         return ERR_NOT_FOUND;
     }
-    switch (event->as_type) {
-    case PNET_EVENT_ERROR:
-        LogError(&event->as_error);
-        break;
-
-    case PNET_EVENT_MESSAGE:
-        log_Note("Message received!"); // TODO: Handle message.
-        break;
-
-    default:
-        log_BugF("Unexpected event type: %d", event->as_type);
-        break;
+    for (size_t i = 0; i < count; ++i) {
+        pnet_Event *event = events[i];
+        switch (event->as_type) {
+        case PNET_EVENT_ERROR:
+            LogError(&event->as_error);
+            break;
+
+        case PNET_EVENT_MESSAGE:
+            log_Note("Message received!"); // TODO: Handle message.
+            break;
+
+        default:
+            log_BugF("Unexpected event type: %d", event->as_type);
+            break;
+        }
     }
-    pnet_FreeEvent(protocol->pnet, event);
+    pnet_FreeEvents(pnet, events, count);
     return ERR_NONE;
 }
 
@@ -4,6 +4,7 @@
 #include "table.h"
 #include <kdt/err.h>
 #include <kdt/kint.h>
+#include <kdt/tims.h>
 
 typedef struct _kdm_Protocol _kdm_Protocol;
 typedef struct kvs_t kvs_t;
@@ -24,13 +25,13 @@ struct _kdm_Protocol {
     /// Key/value store.
     kvs_t *store;
 
-    /// Peer-to-peer networking node.
+    /// Peer-to-peer networking node, or first shard thereof, used for sending.
     pnet_t *pnet;
 };
 
 err_t _kdm_InitProtocol(_kdm_Protocol *protocol, kvs_t *store, pnet_t *pnet);
 kint_t *_kdm_GetClientID(_kdm_Protocol *protocol);
 err_t _kdm_Join(_kdm_Protocol *protocol, const pnet_Host *peer);
-err_t _kdm_Poll(_kdm_Protocol *protocol);
+err_t _kdm_Poll(pnet_t *pnet, tims_t timeout);
 
 #endif
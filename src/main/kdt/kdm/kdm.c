@@ -22,12 +22,28 @@
      }                        \
 } while (0)
 
+/// Time, in seconds, workers wait for events before checking if still running.
+#define _WORKER_POLL_TIMEOUT 0.1
+
+typedef struct _Worker _Worker;
+
+struct _Worker {
+    /// Kademlia protocol handler.
+    _kdm_Protocol *protocol;
+
+    /// Network shard polled by worker.
+    pnet_t *pnet;
+};
+
 static struct {
     /// Kademlia protocol handler.
     _kdm_Protocol protocol;
 
     /// Worker threads.
     pthread_t threads[KDT_THREADS];
+
+    /// Worker thread arguments.
+    _Worker workers[KDT_THREADS];
 } _kdm;
 
 static
@@ -48,12 +64,19 @@ void OnUserSet(void *data, const char *key, const char *value);
 static
 void *StartWorker(void *_arg);
 
-err_t kdm_Start(kvs_t *store, pnet_t *pnet, const pnet_Host *peer) {
+err_t kdm_Start(kvs_t *store, pnet_t *shards, size_t shard_count, const pnet_Host *peer) {
+    // Shards without workers would never send the messages handed off to them.
+    if (shard_count == 0 || shard_count > KDT_THREADS) {
+        log_WarnF("Cannot assign %zu network shards to %zu worker threads.",
+                  shard_count, (size_t) KDT_THREADS);
+        return ERR_NOT_VALID;
+    }
+
     // Setup and report.
     {
         _kdm.protocol.running = true;
 
-        _TRY(_kdm_InitProtocol(&_kdm.protocol, store, pnet));
+        _TRY(_kdm_InitProtocol(&_kdm.protocol, store, &shards[0]));
 
         uint8_t _mem[64];
         mem_t mem = mem_FromBuffer(_mem, sizeof(_mem));
@@ -63,15 +86,20 @@ err_t kdm_Start(kvs_t *store, pnet_t *pnet, const pnet_Host *peer) {
         log_NoteF("Node ID: %s", mem.begin);
 
         mem_Reset(&mem);
-        _TRY(pnet_WriteHostText(pnet_GetInterface(pnet), &mem));
+        _TRY(pnet_WriteHostText(pnet_GetInterface(&shards[0]), &mem));
         log_NoteF("Accepting connections on interface: %s", mem.begin);
     }
 
     // Spawn worker threads.
     for (size_t i = KDT_THREADS; i-- != 0;) {
-        _TRY(pthread_create(&_kdm.threads[i], NULL, StartWorker, &_kdm.protocol));
+        _kdm.workers[i] = (_Worker) {
+            .protocol = &_kdm.protocol,
+            .pnet = &shards[i % shard_count],
+        };
+        _TRY(pthread_create(&_kdm.threads[i], NULL, StartWorker, &_kdm.workers[i]));
     }
-    log_NoteF("Using %zu worker threads.", KDT_THREADS);
+    log_NoteF("Using %zu worker threads and %zu network shards.", (size_t) KDT_THREADS,
+              shard_count);
 
     // Start network join attempt via `peer`.
     {
@@ -181,27 +209,17 @@ void kdm_Shutdown() {
 
 static
 void *StartWorker(void *_arg) {
-    _kdm_Protocol *protocol = _arg;
+    _Worker *worker = _arg;
+    _kdm_Protocol *protocol = worker->protocol;
 
     struct timespec out;
     while (atomic_load(&protocol->running)) {
-        err_t err;
-        if ((err = _kdm_Poll(protocol)) == ERR_NONE) {
+        err_t err = _kdm_Poll(worker->pnet, _WORKER_POLL_TIMEOUT);
+        if (err == ERR_NONE || err == ERR_NOT_FOUND) {
             continue;
         }
-        long sleep_nsec;
-        if (err == ERR_NOT_FOUND) {
-            sleep_nsec = 30000000;
-            goto sleep;
-        }
-        if (err == ERR_TRY_AGAIN) {
-            sleep_nsec = 20000000;
-            goto sleep;
-        }
         log_WarnF("Poll failed. Reason: %s (%d)", err_GetDescription(err), err);
-        sleep_nsec = 10000000;
-sleep:
-        nanosleep(&(struct timespec) {.tv_nsec = sleep_nsec, .tv_sec = 0}, &out);
+        nanosleep(&(struct timespec) {.tv_nsec = 10000000, .tv_sec = 0}, &out);
     }
     return NULL;
 }
\ No newline at end of file
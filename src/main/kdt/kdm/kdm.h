@@ -8,6 +8,7 @@
 
 #include <kdt/pnet/host.h>
 #include <kdt/err.h>
+#include <stddef.h>
 
 typedef struct kvs_t kvs_t;
 typedef struct pnet_t pnet_t;
@@ -15,12 +16,18 @@ typedef struct pnet_t pnet_t;
 /**
  * Starts kademlia worker pool.
  *
+ * Workers are assigned to the given network shards in a round-robin fashion,
+ * each worker only ever polling its own shard. Every shard must be given at
+ * least one worker, which is why ERR_NOT_VALID is returned if there are no
+ * shards, or more than KDT_THREADS.
+ *
  * @param store Pointer to key/value store to use for storing data.
- * @param pnet Pointer to PNET structure, used to handle message passing.
+ * @param shards Pointer to PNET structures, used to handle message passing.
+ * @param shard_count Number of PNET structures in `shards`.
  * @param peer Network peer to use for joining Kademlia network.
  * @return ERR_NONE, only if operation was successful.
  */
-err_t kdm_Start(kvs_t *store, pnet_t *pnet, const pnet_Host *peer);
+err_t kdm_Start(kvs_t *store, pnet_t *shards, size_t shard_count, const pnet_Host *peer);
 
 /**
  * Blocks the calling thread until all Kademlia workers have been terminated.
@@ -2,6 +2,7 @@
 
 #ifdef KDT_USE_LMDB
 #include <assert.h>
+#include <kdt/endian.h>
 #include <limits.h>
 
 #ifdef KDT_USE_POSIX
@@ -62,7 +63,8 @@ err_t kvs_Open(const char *directory, kvs_t *out) {
     if ((code = mdb_env_create(&out->env)) != MDB_SUCCESS) {
         goto leave;
     }
-    if ((code = mdb_env_open(out->env, directory, 0, 0660)) != MDB_SUCCESS) {
+    // Read transactions of views may be released by any thread.
+    if ((code = mdb_env_open(out->env, directory, MDB_NOTLS, 0660)) != MDB_SUCCESS) {
         switch (code) {
         case MDB_VERSION_MISMATCH:
             code = ERR_NOT_COMPATIBLE;
@@ -237,6 +239,50 @@ leave:
     return code;
 }
 
+/*
+ * The read transaction is kept open until the view is released, as values
+ * returned by LMDB are only valid while the transaction reading them is.
+ */
+err_t kvs_GetView(kvs_t *store, const kint_t *key, kvs_View *out) {
+    assert(store != NULL);
+    assert(key != NULL);
+    assert(out != NULL);
+
+    int code;
+    MDB_txn *txn;
+    if ((code = mdb_txn_begin(store->env, NULL, MDB_RDONLY, &txn)) != MDB_SUCCESS) {
+        if (code == MDB_PANIC) {
+            code = ERR_PANIC;
+        }
+        goto leave;
+    }
+    MDB_val k = {.mv_size = KDT_B8, .mv_data = (void *) key};
+    MDB_val v;
+    if ((code = mdb_get(txn, store->dbi, &k, &v)) != MDB_SUCCESS) {
+        if (code == MDB_NOTFOUND) {
+            code = ERR_NOT_FOUND;
+        }
+        goto leave_abort_txn;
+    }
+    out->txn = txn;
+    out->data = v.mv_data;
+    out->size = v.mv_size;
+    goto leave;
+
+leave_abort_txn:
+    mdb_txn_abort(txn);
+leave:
+    return code;
+}
+
+inline
+void kvs_ReleaseView(kvs_View *view) {
+    assert(view != NULL);
+
+    mdb_txn_abort(view->txn);
+    view->txn = NULL;
+}
+
 inline
 const char *kvs_GetImplErrDescription(err_t err) {
     return mdb_strerror(err);
@@ -277,6 +323,204 @@ leave:
     return code;
 }
 
+/// Size of chunk keys, which are value keys followed by big-endian offsets.
+#define _CHUNK_KEY_SIZE (KDT_B8 + sizeof(uint64_t))
+
+static
+void WriteChunkKey(uint8_t *out, const kint_t *key, size_t offset) {
+    const uint64_t offset_be = endian_IntoBE64((uint64_t) offset);
+    memcpy(out, key, KDT_B8);
+    memcpy(&out[KDT_B8], &offset_be, sizeof(uint64_t));
+}
+
+static
+bool IsChunkOf(const MDB_val *k, const kint_t *key) {
+    return k->mv_size == _CHUNK_KEY_SIZE && memcmp(k->mv_data, key, KDT_B8) == 0;
+}
+
+static
+size_t ReadChunkOffset(const MDB_val *k) {
+    uint64_t offset_be;
+    memcpy(&offset_be, &((const uint8_t *) k->mv_data)[KDT_B8], sizeof(uint64_t));
+    return (size_t) endian_FromBE64(offset_be);
+}
+
+/*
+ * Chunks are stored in the same database as values, but with longer keys,
+ * which are the keys of their values followed by their offsets. As keys are
+ * ordered by their bytes, the chunks of a value are ordered by offset, and
+ * are all found right after the value itself.
+ */
+err_t kvs_SetChunk(kvs_t *store, const kint_t *key, size_t offset, size_t size,
+                   const uint8_t *data) {
+    assert(store != NULL);
+    assert(key != NULL);
+    assert(size == 0 || data != NULL);
+
+    int code;
+    MDB_txn *txn;
+    if ((code = mdb_txn_begin(store->env, NULL, 0, &txn)) != MDB_SUCCESS) {
+        if (code == MDB_PANIC) {
+            code = ERR_PANIC;
+        }
+        goto leave;
+    }
+    uint8_t chunk_key[_CHUNK_KEY_SIZE];
+    WriteChunkKey(chunk_key, key, offset);
+    MDB_val k = {.mv_size = _CHUNK_KEY_SIZE, .mv_data = chunk_key};
+    MDB_val v = {.mv_size = size, .mv_data = (void *) data};
+    if ((code = mdb_put(txn, store->dbi, &k, &v, 0)) != MDB_SUCCESS) {
+        if (code == MDB_MAP_FULL) {
+            code = ERR_FULL;
+        }
+        goto leave_abort_txn;
+    }
+    code = mdb_txn_commit(txn);
+    goto leave;
+
+leave_abort_txn:
+    mdb_txn_abort(txn);
+leave:
+    return code;
+}
+
+/*
+ * The value is reserved in full before any chunk is copied into it, which means
+ * that the value is assembled directly in store memory, one chunk at a time.
+ * Chunks are deleted only after all of them have been copied, as the reserved
+ * memory is only valid until the next update made by the same transaction.
+ */
+err_t kvs_CommitChunks(kvs_t *store, const kint_t *key, size_t size) {
+    assert(store != NULL);
+    assert(key != NULL);
+
+    int code;
+    MDB_txn *txn;
+    if ((code = mdb_txn_begin(store->env, NULL, 0, &txn)) != MDB_SUCCESS) {
+        if (code == MDB_PANIC) {
+            code = ERR_PANIC;
+        }
+        goto leave;
+    }
+    MDB_cursor *cursor;
+    if ((code = mdb_cursor_open(txn, store->dbi, &cursor)) != MDB_SUCCESS) {
+        goto leave_abort_txn;
+    }
+    uint8_t first_key[_CHUNK_KEY_SIZE];
+    WriteChunkKey(first_key, key, 0);
+    MDB_val k, v;
+
+    // Ensure chunks are contiguous and make up exactly `size` bytes.
+    size_t expected = 0;
+    k = (MDB_val) {.mv_size = _CHUNK_KEY_SIZE, .mv_data = first_key};
+    for (code = mdb_cursor_get(cursor, &k, &v, MDB_SET_RANGE);
+         code == MDB_SUCCESS && IsChunkOf(&k, key);
+         code = mdb_cursor_get(cursor, &k, &v, MDB_NEXT)) {
+        if (ReadChunkOffset(&k) != expected || v.mv_size > size - expected) {
+            code = ERR_NOT_VALID;
+            goto leave_close_cursor;
+        }
+        expected += v.mv_size;
+    }
+    if (code != MDB_SUCCESS && code != MDB_NOTFOUND) {
+        goto leave_close_cursor;
+    }
+    if (expected != size) {
+        code = ERR_NOT_VALID;
+        goto leave_close_cursor;
+    }
+
+    // Reserve value and copy chunks into it.
+    MDB_val value_k = {.mv_size = KDT_B8, .mv_data = (void *) key};
+    MDB_val value_v = {.mv_size = size, .mv_data = NULL};
+    if ((code = mdb_put(txn, store->dbi, &value_k, &value_v, MDB_RESERVE)) != MDB_SUCCESS) {
+        if (code == MDB_MAP_FULL) {
+            code = ERR_FULL;
+        }
+        goto leave_close_cursor;
+    }
+    k = (MDB_val) {.mv_size = _CHUNK_KEY_SIZE, .mv_data = first_key};
+    for (code = mdb_cursor_get(cursor, &k, &v, MDB_SET_RANGE);
+         code == MDB_SUCCESS && IsChunkOf(&k, key);
+         code = mdb_cursor_get(cursor, &k, &v, MDB_NEXT)) {
+        memcpy(&((uint8_t *) value_v.mv_data)[ReadChunkOffset(&k)], v.mv_data, v.mv_size);
+    }
+    if (code != MDB_SUCCESS && code != MDB_NOTFOUND) {
+        goto leave_close_cursor;
+    }
+
+    // Delete chunks.
+    for (;;) {
+        k = (MDB_val) {.mv_size = _CHUNK_KEY_SIZE, .mv_data = first_key};
+        if ((code = mdb_cursor_get(cursor, &k, &v, MDB_SET_RANGE)) != MDB_SUCCESS ||
+            !IsChunkOf(&k, key)) {
+            break;
+        }
+        if ((code = mdb_cursor_del(cursor, 0)) != MDB_SUCCESS) {
+            goto leave_close_cursor;
+        }
+    }
+    if (code != MDB_SUCCESS && code != MDB_NOTFOUND) {
+        goto leave_close_cursor;
+    }
+    mdb_cursor_close(cursor);
+    code = mdb_txn_commit(txn);
+    goto leave;
+
+leave_close_cursor:
+    mdb_cursor_close(cursor);
+leave_abort_txn:
+    mdb_txn_abort(txn);
+leave:
+    return code;
+}
+
+err_t kvs_DropChunks(kvs_t *store, const kint_t *key) {
+    assert(store != NULL);
+    assert(key != NULL);
+
+    int code;
+    MDB_txn *txn;
+    if ((code = mdb_txn_begin(store->env, NULL, 0, &txn)) != MDB_SUCCESS) {
+        if (code == MDB_PANIC) {
+            code = ERR_PANIC;
+        }
+        goto leave;
+    }
+    MDB_cursor *cursor;
+    if ((code = mdb_cursor_open(txn, store->dbi, &cursor)) != MDB_SUCCESS) {
+        goto leave_abort_txn;
+    }
+    uint8_t first_key[_CHUNK_KEY_SIZE];
+    WriteChunkKey(first_key, key, 0);
+    for (;;) {
+        MDB_val k = {.mv_size = _CHUNK_KEY_SIZE, .mv_data = first_key};
+        MDB_val v;
+        if ((code = mdb_cursor_get(cursor, &k, &v, MDB_SET_RANGE)) != MDB_SUCCESS ||
+            !IsChunkOf(&k, key)) {
+            break;
+        }
+        if ((code = mdb_cursor_del(cursor, 0)) != MDB_SUCCESS) {
+            goto leave_close_cursor;
+        }
+    }
+    if (code != MDB_SUCCESS && code != MDB_NOTFOUND) {
+        goto leave_close_cursor;
+    }
+    mdb_cursor_close(cursor);
+    code = mdb_txn_commit(txn);
+    goto leave;
+
+leave_close_cursor:
+    mdb_cursor_close(cursor);
+leave_abort_txn:
+    mdb_txn_abort(txn);
+leave:
+    return code;
+}
+
+#undef _CHUNK_KEY_SIZE
+
 #else
 #error No supported KVS implementation.
 #endif
\ No newline at end of file
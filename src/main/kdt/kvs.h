@@ -16,6 +16,7 @@
 #endif
 
 typedef struct kvs_t kvs_t;
+typedef struct kvs_View kvs_View;
 
 /**
  * A key/value store, maintaining entries with keys of KDT_B bits and values of
@@ -28,6 +29,23 @@ struct kvs_t {
 #endif
 };
 
+/**
+ * A read-only view of a stored value, referring directly to the memory of the
+ * store rather than to a copy of the value.
+ */
+struct kvs_View {
+#ifdef KDT_USE_LMDB
+    /// Read transaction keeping value memory valid.
+    MDB_txn *txn;
+#endif
+
+    /// Pointer to first byte of value.
+    const uint8_t *data;
+
+    /// Size of value, in bytes.
+    size_t size;
+};
+
 /**
  * Opens key/value store, allowing it to be used.
  *
@@ -99,6 +117,39 @@ err_t kvs_Delete(kvs_t *store, const kint_t *key);
  */
 err_t kvs_Get(kvs_t *store, const kint_t *key, mem_t *out);
 
+/**
+ * Attempts to acquire a view of value `key`, without copying it.
+ *
+ * Returns ERR_NOT_FOUND if no entry exists with given key. The viewed value
+ * remains valid and unchanged until the view is passed to `kvs_ReleaseView()`,
+ * even if the entry is updated or deleted in the meantime.
+ *
+ * @note Views may be released by other threads than the ones acquiring them.
+ * As every view holds on to the store memory it refers to, views should be
+ * released as soon as they are no longer needed. If the LMDB implementation is
+ * used, at most 126 views may be held at any one time.
+ *
+ * @note Thread-safe.
+ *
+ * @param store Pointer to store.
+ * @param key Pointer to key.
+ * @param out Pointer to uninitialized view.
+ * @return ERR_NONE only if operation succeeded.
+ */
+err_t kvs_GetView(kvs_t *store, const kint_t *key, kvs_View *out);
+
+/**
+ * Releases view acquired via `kvs_GetView()`.
+ *
+ * After this function returns, the view is to be regarded as being
+ * uninitialized.
+ *
+ * @note Thread-safe.
+ *
+ * @param view Pointer to view.
+ */
+void kvs_ReleaseView(kvs_View *view);
+
 /**
  * Provides string representation of error code, if given code is specific to
  * the current KVS implementation.
@@ -142,4 +193,53 @@ bool kvs_IsImplErr(err_t err);
  */
 err_t kvs_Set(kvs_t *store, const kint_t *key, size_t size, uint8_t *data);
 
+/**
+ * Stores `size` bytes of `data` as the chunk at `offset` of the value of `key`
+ * being assembled.
+ *
+ * Chunks are kept apart from stored values until passed to
+ * `kvs_CommitChunks()`, which allows for values too large to be held in memory
+ * to be stored as they are received, in any order and by any thread.
+ *
+ * Returns ERR_FULL if the store has no room for the chunk.
+ *
+ * @note Thread-safe.
+ *
+ * @param store Pointer to store.
+ * @param key Pointer to key of value being assembled.
+ * @param offset Offset of chunk within value, in bytes.
+ * @param size Chunk size, in bytes.
+ * @param data Pointer to beginning of chunk data.
+ * @return ERR_NONE only if operation succeeded.
+ */
+err_t kvs_SetChunk(kvs_t *store, const kint_t *key, size_t offset, size_t size,
+                   const uint8_t *data);
+
+/**
+ * Sets value of `key` to the `size` bytes of its chunks, previously stored via
+ * `kvs_SetChunk()`, and deletes those chunks.
+ *
+ * Returns ERR_NOT_VALID, leaving all chunks in place, if the chunks do not
+ * cover exactly the first `size` bytes of the value without overlapping.
+ *
+ * @note Thread-safe.
+ *
+ * @param store Pointer to store.
+ * @param key Pointer to key of assembled value.
+ * @param size Size of assembled value, in bytes.
+ * @return ERR_NONE only if operation succeeded.
+ */
+err_t kvs_CommitChunks(kvs_t *store, const kint_t *key, size_t size);
+
+/**
+ * Deletes all chunks of the value of `key` stored via `kvs_SetChunk()`.
+ *
+ * @note Thread-safe.
+ *
+ * @param store Pointer to store.
+ * @param key Pointer to key of value no longer being assembled.
+ * @return ERR_NONE only if operation succeeded.
+ */
+err_t kvs_DropChunks(kvs_t *store, const kint_t *key);
+
 #endif
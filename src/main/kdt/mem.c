@@ -45,6 +45,7 @@ size_t mem_Read(mem_t *mem, size_t size, uint8_t *out) {
         size = space;
     }
     memcpy(out, mem->offset, size);
+    mem->offset = &mem->offset[size];
     return size;
 }
 
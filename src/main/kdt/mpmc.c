@@ -0,0 +1,138 @@
+#include "mpmc.h"
+#include <assert.h>
+#include <stdint.h>
+
+inline
+void mpmcz_Init(mpmcz_t *mpmc, mpmcz_Cell *origin, size_t capacity) {
+    assert(mpmc != NULL);
+    assert(origin != NULL);
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+    for (size_t i = 0; i < capacity; ++i) {
+        atomic_init(&origin[i].sequence, i);
+    }
+    mpmc->origin = origin;
+    mpmc->mask = capacity - 1;
+    atomic_init(&mpmc->write, 0);
+    atomic_init(&mpmc->read, 0);
+}
+
+/*
+ * Each cell sequence number tells which position the cell is ready for. A
+ * writer at position `p` may claim a cell only if its sequence is `p`, after
+ * which it sets the sequence to `p + 1`, making it ready for the reader at
+ * that same position. The reader, in turn, sets it to `p + capacity`, making
+ * it ready for the writer of the next lap. Positions are claimed by advancing
+ * `write` or `read` with compare-and-swap, which only fails if another thread
+ * claimed the same position first.
+ */
+bool mpmcz_Push(mpmcz_t *mpmc, size_t element) {
+    assert(mpmc != NULL);
+
+    size_t position = atomic_load_explicit(&mpmc->write, memory_order_relaxed);
+    for (;;) {
+        mpmcz_Cell *cell = &mpmc->origin[position & mpmc->mask];
+        const size_t sequence = atomic_load_explicit(&cell->sequence,
+                                                     memory_order_acquire);
+        const intptr_t diff = (intptr_t) sequence - (intptr_t) position;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mpmc->write, &position,
+                                                      position + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->element = element;
+                atomic_store_explicit(&cell->sequence, position + 1,
+                                      memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // Cell not yet read since previous lap. Queue is full.
+            return false;
+        }
+        else {
+            position = atomic_load_explicit(&mpmc->write, memory_order_relaxed);
+        }
+    }
+}
+
+bool mpmcz_Pop(mpmcz_t *mpmc, size_t *out) {
+    assert(mpmc != NULL);
+    assert(out != NULL);
+
+    size_t position = atomic_load_explicit(&mpmc->read, memory_order_relaxed);
+    for (;;) {
+        mpmcz_Cell *cell = &mpmc->origin[position & mpmc->mask];
+        const size_t sequence = atomic_load_explicit(&cell->sequence,
+                                                     memory_order_acquire);
+        const intptr_t diff = (intptr_t) sequence - (intptr_t) (position + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mpmc->read, &position,
+                                                      position + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *out = cell->element;
+                atomic_store_explicit(&cell->sequence, position + mpmc->mask + 1,
+                                      memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // Cell not yet written to during this lap. Queue is empty.
+            return false;
+        }
+        else {
+            position = atomic_load_explicit(&mpmc->read, memory_order_relaxed);
+        }
+    }
+}
+
+/*
+ * The cells following the read position are scanned for as long as they are
+ * ready for their readers, after which the whole range is claimed with a
+ * single compare-and-swap. No other thread can modify the sequence of any
+ * cell in the range without first advancing `read`, which would make the
+ * compare-and-swap fail, making the range safe to read once claimed.
+ */
+size_t mpmcz_PopMany(mpmcz_t *mpmc, size_t *out, size_t max) {
+    assert(mpmc != NULL);
+    assert(out != NULL || max == 0);
+
+    if (max == 0) {
+        return 0;
+    }
+    size_t position = atomic_load_explicit(&mpmc->read, memory_order_relaxed);
+    for (;;) {
+        size_t count = 0;
+        intptr_t diff = 0;
+        while (count < max) {
+            mpmcz_Cell *cell = &mpmc->origin[(position + count) & mpmc->mask];
+            const size_t sequence = atomic_load_explicit(&cell->sequence,
+                                                         memory_order_acquire);
+            diff = (intptr_t) sequence - (intptr_t) (position + count + 1);
+            if (diff != 0) {
+                break;
+            }
+            count += 1;
+        }
+        if (count == 0 && diff < 0) {
+            // Cell not yet written to during this lap. Queue is empty.
+            return 0;
+        }
+        if (count != 0 &&
+            atomic_compare_exchange_weak_explicit(&mpmc->read, &position,
+                                                  position + count,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            for (size_t i = 0; i < count; ++i) {
+                mpmcz_Cell *cell = &mpmc->origin[(position + i) & mpmc->mask];
+                out[i] = cell->element;
+                atomic_store_explicit(&cell->sequence,
+                                      position + i + mpmc->mask + 1,
+                                      memory_order_release);
+            }
+            return count;
+        }
+        position = atomic_load_explicit(&mpmc->read, memory_order_relaxed);
+    }
+}
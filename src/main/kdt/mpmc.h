@@ -0,0 +1,100 @@
+/**
+ * Lock-free multi-producer/multi-consumer queue utilities.
+ *
+ * @file
+ */
+#ifndef KDT_MPMC_H
+#define KDT_MPMC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct mpmcz_Cell mpmcz_Cell;
+typedef struct mpmcz_t mpmcz_t;
+
+/**
+ * A `mpmcz_t` queue element slot.
+ */
+struct mpmcz_Cell {
+    /// Position at which cell can next be written to or read from.
+    atomic_size_t sequence;
+
+    /// Stored element.
+    size_t element;
+};
+
+/**
+ * A fixed-size queue containing `size_t` elements.
+ *
+ * Unlike `cbufz_t`, no locks are taken when pushing or popping elements, which
+ * makes the queue suitable for being accessed by many threads at once.
+ *
+ * @note Unlike `cbufz_t`, a queue can fit exactly `capacity` elements, which
+ * must be a power of two.
+ */
+struct mpmcz_t {
+    /// Pointer to origin cell in buffer.
+    mpmcz_Cell *origin;
+
+    /// Buffer capacity, in elements, minus one.
+    size_t mask;
+
+    /// Position of next element to be written to.
+    _Alignas(64) atomic_size_t write;
+
+    /// Position of next element to be read from.
+    _Alignas(64) atomic_size_t read;
+};
+
+/**
+ * Initializes `mpmc`.
+ *
+ * @note Not thread-safe.
+ *
+ * @param mpmc Pointer to uninitialized queue.
+ * @param origin Pointer to beginning of buffer memory.
+ * @param capacity Buffer memory capacity, in elements. Must be a power of two.
+ */
+void mpmcz_Init(mpmcz_t *mpmc, mpmcz_Cell *origin, size_t capacity);
+
+/**
+ * Attempts to push `element` into `mpmc`.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param mpmc Pointer to queue.
+ * @param element Element to enqueue.
+ * @return Whether or not there was room for element.
+ */
+bool mpmcz_Push(mpmcz_t *mpmc, size_t element);
+
+/**
+ * Attempts to pop element from `mpmc` to `out`.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param mpmc Pointer to queue.
+ * @param out Receiver of dequeued element.
+ * @return Whether or not there was any element to pop.
+ */
+bool mpmcz_Pop(mpmcz_t *mpmc, size_t *out);
+
+/**
+ * Attempts to pop up to `max` elements from `mpmc` to `out`.
+ *
+ * Works as calling `mpmcz_Pop()` repeatedly, except for that all popped
+ * elements are claimed at once, which makes the operation considerably cheaper
+ * than popping the same elements one at a time when the queue is contended.
+ * The popped elements are consecutive, in the order they were pushed.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param mpmc Pointer to queue.
+ * @param out Pointer to array able to hold at least `max` elements.
+ * @param max Maximum number of elements to pop.
+ * @return Number of popped elements.
+ */
+size_t mpmcz_PopMany(mpmcz_t *mpmc, size_t *out, size_t max);
+
+#endif
@@ -0,0 +1,108 @@
+#include "park.h"
+
+#ifdef KDT_USE_POSIX
+#include <assert.h>
+#include <kdt/log.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef KDT_USE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static
+void Wake(park_t *park, int count);
+
+inline
+void park_Init(park_t *park) {
+    assert(park != NULL);
+
+    atomic_init(&park->sequence, 0);
+    atomic_init(&park->waiters, 0);
+#ifndef KDT_USE_FUTEX
+    int status;
+    if ((status = pthread_mutex_init(&park->ptm, NULL)) != 0 ||
+        (status = pthread_cond_init(&park->ptc, NULL)) != 0) {
+        log_PanicF("Failed to initialize PTHREAD park; status: %d", status);
+    }
+#endif
+}
+
+inline
+unsigned park_Prepare(park_t *park) {
+    return atomic_load(&park->sequence);
+}
+
+/*
+ * Returns when `park` is woken after `ticket` was taken, or when `timeout`
+ * seconds have passed, whichever happens first. Spurious wakeups are possible.
+ */
+void park_Wait(park_t *park, unsigned ticket, tims_t timeout) {
+    assert(park != NULL);
+
+    if (timeout <= 0.0) {
+        return;
+    }
+    atomic_fetch_add(&park->waiters, 1);
+#ifdef KDT_USE_FUTEX
+    struct timespec ts = {
+        .tv_sec = (time_t) timeout,
+        .tv_nsec = (long) ((timeout - (tims_t) (time_t) timeout) * 1e9),
+    };
+    syscall(SYS_futex, (unsigned *) &park->sequence, FUTEX_WAIT_PRIVATE, ticket,
+            &ts, NULL, 0);
+#else
+    const tims_t deadline = tims_Now() + timeout;
+    struct timespec ts = {
+        .tv_sec = (time_t) deadline,
+        .tv_nsec = (long) ((deadline - (tims_t) (time_t) deadline) * 1e9),
+    };
+    pthread_mutex_lock(&park->ptm);
+    while (atomic_load(&park->sequence) == ticket) {
+        if (pthread_cond_timedwait(&park->ptc, &park->ptm, &ts) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&park->ptm);
+#endif
+    atomic_fetch_sub(&park->waiters, 1);
+}
+
+inline
+void park_WakeOne(park_t *park) {
+    Wake(park, 1);
+}
+
+inline
+void park_WakeAll(park_t *park) {
+    Wake(park, -1);
+}
+
+static
+void Wake(park_t *park, int count) {
+    assert(park != NULL);
+
+    atomic_fetch_add(&park->sequence, 1);
+    if (atomic_load(&park->waiters) == 0) {
+        return;
+    }
+#ifdef KDT_USE_FUTEX
+    syscall(SYS_futex, (unsigned *) &park->sequence, FUTEX_WAKE_PRIVATE,
+            count < 0 ? INT32_MAX : count, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&park->ptm);
+    if (count < 0) {
+        pthread_cond_broadcast(&park->ptc);
+    }
+    else {
+        pthread_cond_signal(&park->ptc);
+    }
+    pthread_mutex_unlock(&park->ptm);
+#endif
+}
+
+#else
+#error No supported PARK implementation.
+#endif
@@ -0,0 +1,45 @@
+#ifndef KDT_PARK_H
+#define KDT_PARK_H
+
+#include <kdt/tims.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#ifdef KDT_USE_POSIX
+#ifndef KDT_USE_FUTEX
+#include <pthread.h>
+#endif
+#endif
+
+typedef struct park_t park_t;
+
+/**
+ * A place where threads can wait, or park, until woken by other threads.
+ *
+ * A thread intending to park first takes a ticket via `park_Prepare()`, then
+ * checks whether it still needs to wait and, if so, calls `park_Wait()` with
+ * that ticket. As any wakeup after the ticket was taken makes `park_Wait()`
+ * return immediately, no wakeups are lost between the check and the wait.
+ */
+struct park_t {
+    /// Number of times parked threads were woken.
+    atomic_uint sequence;
+
+    /// Number of currently parked threads.
+    atomic_uint waiters;
+
+#ifdef KDT_USE_POSIX
+#ifndef KDT_USE_FUTEX
+    pthread_mutex_t ptm;
+    pthread_cond_t ptc;
+#endif
+#endif
+};
+
+void park_Init(park_t *park);
+unsigned park_Prepare(park_t *park);
+void park_Wait(park_t *park, unsigned ticket, tims_t timeout);
+void park_WakeOne(park_t *park);
+void park_WakeAll(park_t *park);
+
+#endif
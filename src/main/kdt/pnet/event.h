@@ -5,6 +5,7 @@
 #include "message.h"
 #include <kdt/kint.h>
 #include <kdt/mem.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -40,6 +41,21 @@ struct pnet_EventMessage {
 
     /// Message payload data.
     mem_t data;
+
+    /// Offset of `data` within the complete message payload, in bytes.
+    size_t offset;
+
+    /**
+     * Whether the message payload continues in the next message received from
+     * `sender`.
+     *
+     * Payloads larger than a single message buffer are sent as sequences of
+     * messages, each carrying the nonce and tag of the first. The receiver is
+     * expected to consume each part as it arrives, such as by passing it on to
+     * `kvs_SetChunk()`, rather than by holding on to every part until the last
+     * one arrives. The part at `offset` 0 is the first of its sequence.
+     */
+    bool is_continued;
 };
 
 /**
@@ -41,6 +41,9 @@ const char *pnet_GetTransportDescription(uint8_t transport) {
     case PNET_TRANSPORT_TCP:
         s = "TCP";
         break;
+    case PNET_TRANSPORT_UDP:
+        s = "UDP";
+        break;
     default:
         s = NULL;
         break;
@@ -48,6 +51,45 @@ const char *pnet_GetTransportDescription(uint8_t transport) {
     return s;
 }
 
+bool pnet_IsHostEqual(const pnet_Host *a, const pnet_Host *b) {
+    assert(a != NULL);
+    assert(b != NULL);
+
+    if (a->internet != b->internet || a->transport != b->transport ||
+        a->port != b->port) {
+        return false;
+    }
+    const size_t size = a->internet == PNET_INTERNET_IPV4
+        ? 4
+        : PNET_ADDRESS_SIZE;
+    return memcmp(a->address, b->address, size) == 0;
+}
+
+/*
+ * Calculates a 32-bit FNV-1a hash of all fields compared by
+ * `pnet_IsHostEqual()`.
+ */
+uint32_t pnet_HashHost(const pnet_Host *host) {
+    assert(host != NULL);
+
+    uint8_t bytes[4 + PNET_ADDRESS_SIZE] = {
+        host->internet,
+        host->transport,
+        (uint8_t) (host->port >> 8),
+        (uint8_t) host->port,
+    };
+    const size_t size = host->internet == PNET_INTERNET_IPV4
+        ? 4
+        : PNET_ADDRESS_SIZE;
+    memcpy(&bytes[4], host->address, size);
+
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < 4 + size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
 err_t pnet_ReadAddressText(mem_t *mem, uint8_t internet, uint8_t *out) {
     assert(mem != NULL);
     assert(out != NULL);
@@ -177,6 +219,11 @@ err_t pnet_ReadTransportText(mem_t *mem, uint8_t *out) {
         mem_Skip(mem, 3);
         return ERR_NONE;
     }
+    if (strncasecmp((char *) mem->offset, "udp", 3) == 0) {
+        *out = PNET_TRANSPORT_UDP;
+        mem_Skip(mem, 3);
+        return ERR_NONE;
+    }
     if (strncasecmp((char *) mem->offset, "none", 4) == 0) {
         *out = PNET_TRANSPORT_NONE;
         mem_Skip(mem, 4);
@@ -4,6 +4,7 @@
 #include <kdt/err.h>
 #include <kdt/mem.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define PNET_ADDRESS_SIZE 16
 
@@ -24,6 +25,7 @@ enum {
 enum {
     PNET_TRANSPORT_NONE = (uint8_t) 0,
     PNET_TRANSPORT_TCP,
+    PNET_TRANSPORT_UDP,
 };
 
 /**
@@ -59,6 +61,29 @@ const char *pnet_GetInternetDescription(uint8_t internet);
  */
 const char *pnet_GetTransportDescription(uint8_t transport);
 
+/**
+ * Determines whether `a` and `b` identify the same network host.
+ *
+ * Only as many address bytes as used by the internet protocol of the hosts are
+ * compared.
+ *
+ * @param a Pointer to first host.
+ * @param b Pointer to second host.
+ * @return Whether or not hosts are equal.
+ */
+bool pnet_IsHostEqual(const pnet_Host *a, const pnet_Host *b);
+
+/**
+ * Calculates hash of `host`.
+ *
+ * Hosts considered equal by `pnet_IsHostEqual()` are guaranteed to have the
+ * same hash.
+ *
+ * @param host Pointer to host.
+ * @return Host hash.
+ */
+uint32_t pnet_HashHost(const pnet_Host *host);
+
 /**
  * Reads textual representation of address to `out`.
  *
@@ -0,0 +1,231 @@
+#ifdef KDT_USE_ACCEPT4
+#define _GNU_SOURCE
+#endif
+
+#include "batch.h"
+
+#ifdef KDT_USE_POSIX
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+
+static
+_pnet_BatchOp *PushOp(_pnet_Batch *batch, _pnet_BatchOpType type,
+                      _pnet_Socket *socket, size_t size, void *context);
+
+#ifdef KDT_USE_IO_URING
+
+inline
+err_t _pnet_InitBatch(_pnet_Batch *batch) {
+    batch->count = 0;
+    batch->submitted = 0;
+    return _pnet_InitRing(&batch->ring, KDT_N_BATCH);
+}
+
+inline
+void _pnet_TermBatch(_pnet_Batch *batch) {
+    _pnet_TermRing(&batch->ring);
+}
+
+static
+struct io_uring_sqe *PushSQE(_pnet_Batch *batch, _pnet_BatchOp *op, uint8_t opcode) {
+    struct io_uring_sqe *sqe = _pnet_GetRingSQE(&batch->ring);
+    assert(sqe != NULL);
+
+    sqe->opcode = opcode;
+    sqe->fd = op->socket.fd;
+    sqe->user_data = (uint64_t) (op - batch->ops);
+    batch->submitted += 1;
+    return sqe;
+}
+
+void _pnet_BatchReceive(_pnet_Batch *batch, _pnet_Socket *socket, uint8_t *out,
+                        size_t size, void *context) {
+    _pnet_BatchOp *op = PushOp(batch, _PNET_BATCH_RECEIVE, socket, size, context);
+
+    struct io_uring_sqe *sqe = PushSQE(batch, op, IORING_OP_RECV);
+    sqe->addr = (uint64_t) (uintptr_t) out;
+    sqe->len = (uint32_t) size;
+    sqe->msg_flags = MSG_DONTWAIT;
+}
+
+/*
+ * Sends are submitted as vectored sends, the message headers and buffers of
+ * which are kept in their operations until completed.
+ */
+void _pnet_BatchSend(_pnet_Batch *batch, _pnet_Socket *socket,
+                     const _pnet_Buffer *buffers, size_t count, void *context) {
+    assert(buffers != NULL || count == 0);
+    assert(count <= _PNET_SEND_BUFFERS);
+
+    _pnet_BatchOp *op = PushOp(batch, _PNET_BATCH_SEND, socket, 0, context);
+
+    size_t iovecs_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (buffers[i].size == 0) {
+            continue;
+        }
+        op->iovecs[iovecs_count++] = (struct iovec) {
+            .iov_base = (void *) buffers[i].data,
+            .iov_len = buffers[i].size,
+        };
+        op->size += buffers[i].size;
+    }
+    op->header = (struct msghdr) {
+        .msg_iov = op->iovecs,
+        .msg_iovlen = iovecs_count,
+    };
+    struct io_uring_sqe *sqe = PushSQE(batch, op, IORING_OP_SENDMSG);
+    sqe->addr = (uint64_t) (uintptr_t) &op->header;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+}
+
+err_t _pnet_FlushBatch(_pnet_Batch *batch, void *data, _pnet_OnBatchOp callback) {
+    const size_t count = batch->count;
+    const size_t submitted = batch->submitted;
+    batch->count = 0;
+    batch->submitted = 0;
+
+    err_t err = ERR_NONE;
+    if (submitted > 0) {
+        err = _pnet_SubmitRing(&batch->ring, (unsigned) submitted,
+                               (unsigned) submitted);
+    }
+    if (err == ERR_NONE) {
+        uint64_t index;
+        int32_t res;
+        while (_pnet_PopRingCQE(&batch->ring, &index, &res)) {
+            assert(index < count);
+
+            _pnet_BatchOp *op = &batch->ops[index];
+            if (res < 0) {
+                op->err = -res;
+                op->size = 0;
+                continue;
+            }
+            op->err = ERR_NONE;
+            op->size = (size_t) res;
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        _pnet_BatchOp *op = &batch->ops[i];
+        if (err != ERR_NONE && (op->type == _PNET_BATCH_RECEIVE ||
+                                op->type == _PNET_BATCH_SEND)) {
+            op->err = err;
+        }
+        if (op->err != ERR_NONE) {
+            op->size = 0;
+        }
+        callback(data, op);
+    }
+    return err;
+}
+
+#else
+
+inline
+err_t _pnet_InitBatch(_pnet_Batch *batch) {
+    batch->count = 0;
+    return ERR_NONE;
+}
+
+inline
+void _pnet_TermBatch(_pnet_Batch *batch) {
+    (void) batch;
+}
+
+void _pnet_BatchReceive(_pnet_Batch *batch, _pnet_Socket *socket, uint8_t *out,
+                        size_t size, void *context) {
+    _pnet_BatchOp *op = PushOp(batch, _PNET_BATCH_RECEIVE, socket, size, context);
+    op->err = _pnet_Receive(socket, &op->size, out);
+}
+
+void _pnet_BatchSend(_pnet_Batch *batch, _pnet_Socket *socket,
+                     const _pnet_Buffer *buffers, size_t count, void *context) {
+    _pnet_BatchOp *op = PushOp(batch, _PNET_BATCH_SEND, socket, 0, context);
+    op->err = _pnet_Send(socket, buffers, count, &op->size);
+}
+
+err_t _pnet_FlushBatch(_pnet_Batch *batch, void *data, _pnet_OnBatchOp callback) {
+    const size_t count = batch->count;
+    batch->count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        _pnet_BatchOp *op = &batch->ops[i];
+        if (op->err != ERR_NONE) {
+            op->size = 0;
+        }
+        callback(data, op);
+    }
+    return ERR_NONE;
+}
+
+#endif
+
+/*
+ * Accepted sockets are made non-blocking and close-on-exec, atomically if
+ * KDT_USE_ACCEPT4 is defined.
+ */
+void _pnet_BatchAccept(_pnet_Batch *batch, _pnet_Socket *listener, void *context) {
+    _pnet_BatchOp *op = PushOp(batch, _PNET_BATCH_ACCEPT, listener, 0, context);
+
+#ifdef KDT_USE_ACCEPT4
+    int fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        op->err = errno;
+        return;
+    }
+#else
+    int fd = accept(listener->fd, NULL, NULL);
+    if (fd < 0) {
+        op->err = errno;
+        return;
+    }
+    int flags;
+    if ((flags = fcntl(fd, F_GETFL, 0)) < 0 ||
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0 ||
+        fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) {
+        op->err = errno;
+        close(fd);
+        return;
+    }
+#endif
+    op->socket.fd = fd;
+}
+
+void _pnet_BatchConnect(_pnet_Batch *batch, _pnet_Socket *socket,
+                        const struct sockaddr *address, socklen_t size, void *context) {
+    _pnet_BatchOp *op = PushOp(batch, _PNET_BATCH_CONNECT, socket, 0, context);
+
+    if (connect(socket->fd, address, size) != 0) {
+        op->err = errno;
+    }
+}
+
+inline
+bool _pnet_IsBatchFull(const _pnet_Batch *batch) {
+    return batch->count == KDT_N_BATCH;
+}
+
+static
+_pnet_BatchOp *PushOp(_pnet_Batch *batch, _pnet_BatchOpType type,
+                      _pnet_Socket *socket, size_t size, void *context) {
+    assert(batch != NULL);
+    assert(socket != NULL);
+    assert(!_pnet_IsBatchFull(batch));
+
+    _pnet_BatchOp *op = &batch->ops[batch->count++];
+    op->type = type;
+    op->socket = *socket;
+    op->context = context;
+    op->size = size;
+    op->err = ERR_NONE;
+    return op;
+}
+
+#else
+#error No supported internal PNET batch implementation.
+#endif
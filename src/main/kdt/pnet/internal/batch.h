@@ -0,0 +1,103 @@
+#ifndef KDT_PNET_INTERNAL_BATCH_H
+#define KDT_PNET_INTERNAL_BATCH_H
+
+#include "socket.h"
+#include "uring.h"
+#include <kdt/def.h>
+#include <kdt/err.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef KDT_USE_POSIX
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+typedef struct _pnet_Batch _pnet_Batch;
+typedef struct _pnet_BatchOp _pnet_BatchOp;
+
+/**
+ * Kinds of batchable socket operations.
+ */
+typedef enum _pnet_BatchOpType {
+    _PNET_BATCH_ACCEPT,
+    _PNET_BATCH_CONNECT,
+    _PNET_BATCH_RECEIVE,
+    _PNET_BATCH_SEND,
+} _pnet_BatchOpType;
+
+/**
+ * A queued socket operation, and eventually its result.
+ */
+struct _pnet_BatchOp {
+    /// Type of operation.
+    _pnet_BatchOpType type;
+
+    /// Socket operated on. Replaced by accepted socket if type is ACCEPT.
+    _pnet_Socket socket;
+
+    /// Arbitrary data provided when operation was queued.
+    void *context;
+
+    /// Bytes to transfer, or actual number of bytes transferred when done.
+    size_t size;
+
+    /// Operation result.
+    err_t err;
+
+#ifdef KDT_USE_IO_URING
+    /// Message header of submitted vectored send, if any.
+    struct msghdr header;
+
+    /// Buffers referred to by `header`.
+    struct iovec iovecs[_PNET_SEND_BUFFERS];
+#endif
+};
+
+/**
+ * A batch of socket operations.
+ *
+ * Operations are queued and then completed together by `_pnet_FlushBatch()`.
+ * If KDT_USE_IO_URING is defined, all queued receives and sends are submitted
+ * and reaped via a single system call. Otherwise, and always for accepts and
+ * connects, each operation is carried out immediately when queued, and only
+ * its completion is deferred.
+ *
+ * @note As all sockets are non-blocking, operations that cannot complete
+ * immediately fail with EAGAIN rather than being left pending.
+ */
+struct _pnet_Batch {
+#ifdef KDT_USE_IO_URING
+    /// Submission/completion queue pair.
+    _pnet_Ring ring;
+
+    /// Number of queued operations submitted via `ring`.
+    size_t submitted;
+#endif
+
+    /// Number of queued operations.
+    size_t count;
+
+    /// Queued operations.
+    _pnet_BatchOp ops[KDT_N_BATCH];
+};
+
+/**
+ * Function invoked for each operation completed by `_pnet_FlushBatch()`.
+ */
+typedef void (*_pnet_OnBatchOp)(void *data, _pnet_BatchOp *op);
+
+err_t _pnet_InitBatch(_pnet_Batch *batch);
+void _pnet_TermBatch(_pnet_Batch *batch);
+bool _pnet_IsBatchFull(const _pnet_Batch *batch);
+void _pnet_BatchAccept(_pnet_Batch *batch, _pnet_Socket *listener, void *context);
+void _pnet_BatchConnect(_pnet_Batch *batch, _pnet_Socket *socket,
+                        const struct sockaddr *address, socklen_t size, void *context);
+void _pnet_BatchReceive(_pnet_Batch *batch, _pnet_Socket *socket, uint8_t *out,
+                        size_t size, void *context);
+void _pnet_BatchSend(_pnet_Batch *batch, _pnet_Socket *socket,
+                     const _pnet_Buffer *buffers, size_t count, void *context);
+err_t _pnet_FlushBatch(_pnet_Batch *batch, void *data, _pnet_OnBatchOp callback);
+
+#endif
@@ -0,0 +1,373 @@
+#include "connections.h"
+
+#ifdef KDT_USE_POSIX
+#include <assert.h>
+
+static
+_pnet_Connection *Find(_pnet_Connections *connections, const _pnet_Socket *socket);
+
+static
+void Link(_pnet_Connections *connections, int fd);
+
+static
+void Unlink(_pnet_Connections *connections, int fd);
+
+static
+bool IsReferredTo(const _pnet_Connection *connection);
+
+static
+void Reset(_pnet_Connection *connection);
+
+inline
+void _pnet_InitConnections(_pnet_Connections *connections) {
+    assert(connections != NULL);
+
+    connections->count = 0;
+    connections->head = -1;
+    connections->tail = -1;
+    for (size_t i = 0; i < KDT_N_SOCKETS; ++i) {
+        connections->entries[i].is_tracked = false;
+        Reset(&connections->entries[i]);
+    }
+}
+
+/*
+ * If KDT_N_CONNECTIONS connections are already tracked, the least recently
+ * active one is evicted to make room for the added connection, and is then
+ * assigned to `evicted`, after which it must be closed by the caller.
+ * `evicted` is set to SOCKET_EMPTY if no connection had to be evicted. False
+ * is returned only if the socket cannot be tracked at all.
+ */
+bool _pnet_AddConnection(_pnet_Connections *connections, const _pnet_Socket *socket,
+                         tims_t now, _pnet_Socket *evicted) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+    assert(evicted != NULL);
+
+    *evicted = SOCKET_EMPTY;
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return false;
+    }
+    _pnet_Connection *connection = &connections->entries[socket->fd];
+    if (connection->is_tracked) {
+        Unlink(connections, socket->fd);
+    }
+    else {
+        if (connections->count == KDT_N_CONNECTIONS) {
+            evicted->fd = connections->head;
+            Unlink(connections, evicted->fd);
+            connections->entries[evicted->fd].is_tracked = false;
+        }
+        else {
+            connections->count += 1;
+        }
+    }
+    connection->is_tracked = true;
+    connection->accepted = now;
+    connection->active = now;
+    connection->bytes_received = 0;
+    connection->bytes_sent = 0;
+    connection->offset = 0;
+    Link(connections, socket->fd);
+    return true;
+}
+
+inline
+void _pnet_RemoveConnection(_pnet_Connections *connections, const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    _pnet_Connection *connection = Find(connections, socket);
+    if (connection == NULL) {
+        return;
+    }
+    Unlink(connections, socket->fd);
+    connection->is_tracked = false;
+    connections->count -= 1;
+}
+
+inline
+const _pnet_Connection *_pnet_GetConnection(const _pnet_Connections *connections,
+                                            const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    return Find((_pnet_Connections *) connections, socket);
+}
+
+/*
+ * Touched connections become the most recently active ones. Sockets not being
+ * tracked, such as those of outbound connections, are ignored.
+ */
+void _pnet_TouchConnection(_pnet_Connections *connections, const _pnet_Socket *socket,
+                           tims_t now, size_t received, size_t sent) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    _pnet_Connection *connection = Find(connections, socket);
+    if (connection == NULL) {
+        return;
+    }
+    connection->active = now;
+    connection->bytes_received += received;
+    connection->bytes_sent += sent;
+    if (connections->tail != socket->fd) {
+        Unlink(connections, socket->fd);
+        Link(connections, socket->fd);
+    }
+}
+
+/*
+ * Returns the offset of a received frame of `size` payload bytes within its
+ * message payload, and records where the next frame begins, which is at
+ * offset 0 unless the frame `is_continued`. Frames are kept track of whether
+ * or not the connection is tracked, as outbound connections carry framed
+ * responses too. Sockets that cannot be indexed have no frames in progress.
+ */
+size_t _pnet_ContinueConnection(_pnet_Connections *connections,
+                                const _pnet_Socket *socket, size_t size,
+                                bool is_continued) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return 0;
+    }
+    _pnet_Connection *connection = &connections->entries[socket->fd];
+    const size_t offset = connection->offset;
+    connection->offset = is_continued ? offset + size : 0;
+    return offset;
+}
+
+/*
+ * Parks `event` with the socket, replacing any event already parked with it.
+ * False is returned only if the socket cannot be indexed.
+ */
+bool _pnet_ParkConnectionEvent(_pnet_Connections *connections,
+                               const _pnet_Socket *socket, size_t event) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return false;
+    }
+    connections->entries[socket->fd].event = event;
+    return true;
+}
+
+/*
+ * Takes the event parked with the socket, if any, leaving no event parked.
+ */
+bool _pnet_UnparkConnectionEvent(_pnet_Connections *connections,
+                                 const _pnet_Socket *socket, size_t *out) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+    assert(out != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS ||
+        connections->entries[socket->fd].event == SIZE_MAX) {
+        return false;
+    }
+    *out = connections->entries[socket->fd].event;
+    connections->entries[socket->fd].event = SIZE_MAX;
+    return true;
+}
+
+/*
+ * As connections are ordered by when they were last active, only the least
+ * recently active connection needs to be considered.
+ */
+bool _pnet_PopIdleConnection(_pnet_Connections *connections, tims_t before,
+                             _pnet_Socket *out) {
+    assert(connections != NULL);
+    assert(out != NULL);
+
+    const int fd = connections->head;
+    if (fd == -1 || connections->entries[fd].active > before) {
+        return false;
+    }
+    Unlink(connections, fd);
+    connections->entries[fd].is_tracked = false;
+    connections->count -= 1;
+    out->fd = fd;
+    return true;
+}
+
+/*
+ * Sockets being closed cannot be pinned again. False is returned if the socket
+ * is being closed or cannot be indexed.
+ */
+bool _pnet_PinConnection(_pnet_Connections *connections, const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS ||
+        connections->entries[socket->fd].is_closing) {
+        return false;
+    }
+    connections->entries[socket->fd].pins += 1;
+    return true;
+}
+
+/*
+ * True is returned only if the socket was being closed and is no longer
+ * referred to, in which case it must now be closed by the caller.
+ */
+bool _pnet_UnpinConnection(_pnet_Connections *connections, const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return false;
+    }
+    _pnet_Connection *connection = &connections->entries[socket->fd];
+    assert(connection->pins > 0);
+    connection->pins -= 1;
+    if (!connection->is_closing || IsReferredTo(connection)) {
+        return false;
+    }
+    Reset(connection);
+    return true;
+}
+
+/*
+ * Stops tracking the connection of the socket, if tracked. True is returned
+ * if the socket may be closed at once, while it is otherwise marked as closing
+ * until no longer pinned or parked with. Sockets that cannot be indexed may
+ * always be closed at once.
+ */
+bool _pnet_CloseConnection(_pnet_Connections *connections, const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    _pnet_RemoveConnection(connections, socket);
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return true;
+    }
+    _pnet_Connection *connection = &connections->entries[socket->fd];
+    if (IsReferredTo(connection)) {
+        connection->is_closing = true;
+        return false;
+    }
+    Reset(connection);
+    return true;
+}
+
+inline
+bool _pnet_IsConnectionClosing(const _pnet_Connections *connections,
+                               const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    return socket->fd >= 0 && socket->fd < KDT_N_SOCKETS &&
+           connections->entries[socket->fd].is_closing;
+}
+
+inline
+size_t _pnet_GetConnectionWriter(const _pnet_Connections *connections,
+                                 const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return SIZE_MAX;
+    }
+    return connections->entries[socket->fd].writer;
+}
+
+inline
+void _pnet_SetConnectionWriter(_pnet_Connections *connections,
+                               const _pnet_Socket *socket, size_t writer) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd >= 0 && socket->fd < KDT_N_SOCKETS) {
+        connections->entries[socket->fd].writer = writer;
+    }
+}
+
+inline
+size_t _pnet_GetConnectionWaiting(const _pnet_Connections *connections,
+                                  const _pnet_Socket *socket) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS) {
+        return SIZE_MAX;
+    }
+    return connections->entries[socket->fd].waiting;
+}
+
+inline
+void _pnet_SetConnectionWaiting(_pnet_Connections *connections,
+                                const _pnet_Socket *socket, size_t waiting) {
+    assert(connections != NULL);
+    assert(socket != NULL);
+
+    if (socket->fd >= 0 && socket->fd < KDT_N_SOCKETS) {
+        connections->entries[socket->fd].waiting = waiting;
+    }
+}
+
+static
+_pnet_Connection *Find(_pnet_Connections *connections, const _pnet_Socket *socket) {
+    if (socket->fd < 0 || socket->fd >= KDT_N_SOCKETS ||
+        !connections->entries[socket->fd].is_tracked) {
+        return NULL;
+    }
+    return &connections->entries[socket->fd];
+}
+
+static
+void Link(_pnet_Connections *connections, int fd) {
+    _pnet_Connection *connection = &connections->entries[fd];
+    connection->prev = connections->tail;
+    connection->next = -1;
+    if (connections->tail != -1) {
+        connections->entries[connections->tail].next = fd;
+    }
+    else {
+        connections->head = fd;
+    }
+    connections->tail = fd;
+}
+
+static
+void Unlink(_pnet_Connections *connections, int fd) {
+    _pnet_Connection *connection = &connections->entries[fd];
+    if (connection->prev != -1) {
+        connections->entries[connection->prev].next = connection->next;
+    }
+    else {
+        connections->head = connection->next;
+    }
+    if (connection->next != -1) {
+        connections->entries[connection->next].prev = connection->prev;
+    }
+    else {
+        connections->tail = connection->prev;
+    }
+}
+
+static
+bool IsReferredTo(const _pnet_Connection *connection) {
+    return connection->pins > 0 || connection->event != SIZE_MAX;
+}
+
+/*
+ * Forgets all about the socket, as its descriptor may be reused by another.
+ */
+static
+void Reset(_pnet_Connection *connection) {
+    connection->offset = 0;
+    connection->event = SIZE_MAX;
+    connection->pins = 0;
+    connection->is_closing = false;
+    connection->writer = SIZE_MAX;
+    connection->waiting = SIZE_MAX;
+}
+
+#else
+#error No supported internal PNET connections implementation.
+#endif
@@ -0,0 +1,136 @@
+#ifndef KDT_PNET_INTERNAL_CONNECTIONS_H
+#define KDT_PNET_INTERNAL_CONNECTIONS_H
+
+#include "socket.h"
+#include <kdt/def.h>
+#include <kdt/tims.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct _pnet_Connection _pnet_Connection;
+typedef struct _pnet_Connections _pnet_Connections;
+
+struct _pnet_Connection {
+#ifdef KDT_USE_POSIX
+    /// Descriptor of next less recently active connection, or -1 if none.
+    int prev;
+
+    /// Descriptor of next more recently active connection, or -1 if none.
+    int next;
+#endif
+
+    /// Whether connection is tracked.
+    bool is_tracked;
+
+    /// Time at which connection was accepted.
+    tims_t accepted;
+
+    /// Time at which bytes were last received or sent via connection.
+    tims_t active;
+
+    /// Number of bytes received via connection.
+    uint64_t bytes_received;
+
+    /// Number of bytes sent via connection.
+    uint64_t bytes_sent;
+
+    /// Offset within its message payload of next frame received via connection.
+    /// Kept even if connection is not tracked, until its socket is closed.
+    size_t offset;
+
+    /// Index of event waiting for connection to become readable, or SIZE_MAX if
+    /// none. Kept even if connection stops being tracked, as its socket remains
+    /// open until the event is taken.
+    size_t event;
+
+    /// Number of messages being sent via socket, which keep it from being
+    /// closed until unpinned.
+    size_t pins;
+
+    /// Whether socket is to be closed once neither pinned nor parked with.
+    bool is_closing;
+
+    /// Index of message partially sent via socket, which must be sent in full
+    /// before any other message is sent via the socket, or SIZE_MAX if none.
+    size_t writer;
+
+    /// Index of first message of list of messages waiting for socket to become
+    /// writable, or SIZE_MAX if none. The list is linked by the messages.
+    size_t waiting;
+};
+
+/**
+ * A table of inbound connections, ordered by when they were last active.
+ *
+ * Connections are indexed directly by their sockets, which makes it possible
+ * to keep track of their activity at constant cost. At most KDT_N_CONNECTIONS
+ * connections are tracked at a time. The least recently active connection is
+ * evicted if another is added while that many are tracked.
+ *
+ * Every socket that can be indexed, inbound or outbound, may also have an
+ * event parked in the table, which lets a socket reported as readable be
+ * mapped directly to the event receiving from it, whether or not its
+ * connection is tracked. The same goes for the offset of the frame being
+ * received via the socket.
+ *
+ * Sockets may also be pinned by messages being sent via them. Sockets being
+ * closed while pinned or parked with are only marked as closing, and must be
+ * closed by whoever removes their last pin or takes their parked event, which
+ * keeps their descriptors from being reused while still referred to.
+ *
+ * Lastly, each socket may have a writer, which is the only message allowed to
+ * be sent via it until the rest of its bytes have been sent, as well as a list
+ * of messages waiting for it to become writable, which lets a socket reported
+ * as writable be mapped directly to the messages to send via it.
+ *
+ * @note The table never opens or closes any sockets itself.
+ */
+struct _pnet_Connections {
+    /// Number of tracked connections.
+    size_t count;
+
+#ifdef KDT_USE_POSIX
+    /// Descriptor of least recently active connection, or -1 if none.
+    int head;
+
+    /// Descriptor of most recently active connection, or -1 if none.
+    int tail;
+#endif
+
+    /// Connections, indexed by socket.
+    _pnet_Connection entries[KDT_N_SOCKETS];
+};
+
+void _pnet_InitConnections(_pnet_Connections *connections);
+bool _pnet_AddConnection(_pnet_Connections *connections, const _pnet_Socket *socket,
+                         tims_t now, _pnet_Socket *evicted);
+void _pnet_RemoveConnection(_pnet_Connections *connections, const _pnet_Socket *socket);
+const _pnet_Connection *_pnet_GetConnection(const _pnet_Connections *connections,
+                                            const _pnet_Socket *socket);
+void _pnet_TouchConnection(_pnet_Connections *connections, const _pnet_Socket *socket,
+                           tims_t now, size_t received, size_t sent);
+size_t _pnet_ContinueConnection(_pnet_Connections *connections,
+                                const _pnet_Socket *socket, size_t size,
+                                bool is_continued);
+bool _pnet_ParkConnectionEvent(_pnet_Connections *connections,
+                                const _pnet_Socket *socket, size_t event);
+bool _pnet_UnparkConnectionEvent(_pnet_Connections *connections,
+                                 const _pnet_Socket *socket, size_t *out);
+bool _pnet_PopIdleConnection(_pnet_Connections *connections, tims_t before,
+                             _pnet_Socket *out);
+bool _pnet_PinConnection(_pnet_Connections *connections, const _pnet_Socket *socket);
+bool _pnet_UnpinConnection(_pnet_Connections *connections, const _pnet_Socket *socket);
+bool _pnet_CloseConnection(_pnet_Connections *connections, const _pnet_Socket *socket);
+bool _pnet_IsConnectionClosing(const _pnet_Connections *connections,
+                               const _pnet_Socket *socket);
+size_t _pnet_GetConnectionWriter(const _pnet_Connections *connections,
+                                 const _pnet_Socket *socket);
+void _pnet_SetConnectionWriter(_pnet_Connections *connections,
+                               const _pnet_Socket *socket, size_t writer);
+size_t _pnet_GetConnectionWaiting(const _pnet_Connections *connections,
+                                  const _pnet_Socket *socket);
+void _pnet_SetConnectionWaiting(_pnet_Connections *connections,
+                                const _pnet_Socket *socket, size_t waiting);
+
+#endif
@@ -2,7 +2,11 @@
 #define KDT_PNET_INTERNAL_EVENT_H
 
 #include "../event.h"
+#include "header.h"
 #include "socket.h"
+#include <kdt/tims.h>
+#include <kdt/wheel.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -21,8 +25,20 @@ struct _pnet_Event {
     /// Number of bytes received.
     size_t bytes_received;
 
-    /// Event body buffer.
-    uint8_t data[KDT_N_BUFFER_SIZE];
+    /// Time at which the first byte of the message being received arrived.
+    tims_t started;
+
+    /// Timer armed while event waits for the rest of its message.
+    wheel_Timer timer;
+
+    /// Event header and body buffer, or NULL if event carries no message.
+    uint8_t *data;
+
+    /// Size of `data`, in bytes.
+    size_t size;
+
+    /// Number of references held to event, which is freed when reaching zero.
+    atomic_uint references;
 };
 
 static inline _pnet_Event *_pnet_AsPrivateEvent(pnet_Event *event) {
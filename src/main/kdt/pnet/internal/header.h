@@ -1,6 +1,10 @@
 #ifndef KDT_PNET_INTERNAL_HEADER_H
 #define KDT_PNET_INTERNAL_HEADER_H
 
+#include <kdt/def.h>
+#include <kdt/kint.h>
+#include <stdint.h>
+
 /**
  * The number of bytes preceding the payload of a transmitted or received
  * message.
@@ -12,4 +16,18 @@
  */
 #define _PNET_HEADER_SIZE (sizeof(kint_t) + sizeof(uint16_t) + sizeof(uint16_t))
 
+/**
+ * The largest number of payload bytes carried by a single frame.
+ *
+ * Messages with larger payloads are sent as sequences of frames, each with its
+ * own header and all but the last carrying exactly this many payload bytes.
+ */
+#define _PNET_FRAME_SIZE (KDT_N_BUFFER_SIZE < UINT16_MAX ? KDT_N_BUFFER_SIZE : UINT16_MAX)
+
+/**
+ * Tag bit set in the header of every frame followed by another frame of the
+ * same message.
+ */
+#define _PNET_TAG_MORE 0x8000
+
 #endif
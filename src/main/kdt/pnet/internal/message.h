@@ -2,8 +2,12 @@
 #define KDT_PNET_INTERNAL_MESSAGE_H
 
 #include "../message.h"
+#include "header.h"
 #include "socket.h"
 #include <kdt/tims.h>
+#include <kdt/wheel.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -19,14 +23,66 @@ struct _pnet_Message {
     /// Associated socket, or SOCKET_NONE if not known.
     _pnet_Socket socket;
 
+    /// Whether message is sent via the connection of the request it answers.
+    bool is_response;
+
+    /// Whether message has pinned its socket, which keeps it open until the
+    /// message is freed.
+    bool pins_socket;
+
+    /// Index of sender credit counter held by message, or SIZE_MAX if none.
+    size_t credit;
+
+    /// Whether the connection attempt of message socket is yet to complete.
+    bool is_connecting;
+
+    /// Time at which connection attempt of message socket times out.
+    tims_t connect_timeout;
+
     /// Number of bytes sent of message, including header bytes.
     size_t bytes_sent;
 
     /// Time at which message sending times out and the message is discarded.
     tims_t timeout;
 
-    /// Message body buffer.
-    uint8_t data[KDT_N_BUFFER_SIZE];
+    /// Retransmission timeout of message receiver, in seconds.
+    tims_t rto;
+
+    /// Time at which datagram is sent again, or 0 if not sent or not in use.
+    tims_t retransmit;
+
+    /// Whether a datagram with the same nonce was received from the receiver.
+    atomic_bool acknowledged;
+
+    /// Buffer index of next datagram in the same list of sender datagrams not
+    /// yet acknowledged, or SIZE_MAX if last.
+    size_t unacknowledged_next;
+
+    /// Timer armed while datagram awaits acknowledgement, retransmission or
+    /// timeout, or while message waits for its socket to become writable.
+    wheel_Timer timer;
+
+    /// Buffer index of next message waiting for the same socket to become
+    /// writable, or SIZE_MAX if last.
+    size_t waiting_next;
+
+    /// Message header and body buffer.
+    uint8_t *data;
+
+    /// Header of frame being sent, unless it is the first frame of message.
+    uint8_t frame_header[_PNET_HEADER_SIZE];
+
+    /// Payload bytes sent after those of `message.data`, not owned by message.
+    const uint8_t *attachment;
+
+    /// Size of `attachment`, in bytes.
+    size_t attachment_size;
+
+    /// Function releasing `attachment` when message is freed, if any.
+    pnet_OnRelease attachment_release;
+
+    /// Arbitrary data passed on to `attachment_release`.
+    void *attachment_context;
 };
 
 static inline _pnet_Message *_pnet_AsPrivateMessage(pnet_Message *message) {
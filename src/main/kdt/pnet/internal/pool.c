@@ -0,0 +1,127 @@
+#include "pool.h"
+#include <assert.h>
+
+inline
+void _pnet_InitPool(_pnet_Pool *pool) {
+    assert(pool != NULL);
+
+    for (size_t i = 0; i < KDT_N_POOL; ++i) {
+        pool->entries[i].socket = SOCKET_EMPTY;
+    }
+}
+
+/*
+ * Returns ERR_NONE if an idle socket connected to `host` was taken,
+ * ERR_TRY_AGAIN if no socket is idle and no more may be opened to `host`, or
+ * ERR_NOT_FOUND if no socket is idle but another may be opened.
+ */
+err_t _pnet_TakePooledSocket(_pnet_Pool *pool, const pnet_Host *host, _pnet_Socket *out) {
+    assert(pool != NULL);
+    assert(host != NULL);
+    assert(out != NULL);
+
+    size_t count = 0;
+    for (size_t i = 0; i < KDT_N_POOL; ++i) {
+        _pnet_PoolEntry *entry = &pool->entries[i];
+        if (_pnet_IsSocketEmpty(&entry->socket) ||
+            !pnet_IsHostEqual(&entry->host, host)) {
+            continue;
+        }
+        if (entry->expires != 0) {
+            entry->expires = 0;
+            *out = entry->socket;
+            return ERR_NONE;
+        }
+        count += 1;
+    }
+    return count < KDT_N_POOL_HOST
+        ? ERR_NOT_FOUND
+        : ERR_TRY_AGAIN;
+}
+
+/*
+ * If the pool is full, the idle socket closest to expiring is evicted to make
+ * room for the added socket, which is then assigned to `evicted` and must be
+ * closed by the caller. `evicted` is set to SOCKET_EMPTY if no socket had to
+ * be evicted. False is returned only if no entry could be made available.
+ */
+bool _pnet_AddPooledSocket(_pnet_Pool *pool, const pnet_Host *host,
+                           const _pnet_Socket *socket, _pnet_Socket *evicted) {
+    assert(pool != NULL);
+    assert(host != NULL);
+    assert(socket != NULL);
+    assert(evicted != NULL);
+
+    *evicted = SOCKET_EMPTY;
+
+    _pnet_PoolEntry *target = NULL;
+    for (size_t i = 0; i < KDT_N_POOL; ++i) {
+        _pnet_PoolEntry *entry = &pool->entries[i];
+        if (_pnet_IsSocketEmpty(&entry->socket)) {
+            target = entry;
+            break;
+        }
+        if (entry->expires != 0 &&
+            (target == NULL || entry->expires < target->expires)) {
+            target = entry;
+        }
+    }
+    if (target == NULL) {
+        return false;
+    }
+    if (!_pnet_IsSocketEmpty(&target->socket)) {
+        *evicted = target->socket;
+    }
+    target->host = *host;
+    target->socket = *socket;
+    target->expires = 0;
+    return true;
+}
+
+inline
+bool _pnet_ReleasePooledSocket(_pnet_Pool *pool, const _pnet_Socket *socket,
+                               tims_t expires) {
+    assert(pool != NULL);
+    assert(socket != NULL);
+    assert(expires != 0);
+
+    for (size_t i = 0; i < KDT_N_POOL; ++i) {
+        _pnet_PoolEntry *entry = &pool->entries[i];
+        if (_pnet_IsSocketEqual(&entry->socket, socket)) {
+            entry->expires = expires;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline
+void _pnet_RemovePooledSocket(_pnet_Pool *pool, const _pnet_Socket *socket) {
+    assert(pool != NULL);
+    assert(socket != NULL);
+
+    for (size_t i = 0; i < KDT_N_POOL; ++i) {
+        _pnet_PoolEntry *entry = &pool->entries[i];
+        if (_pnet_IsSocketEqual(&entry->socket, socket)) {
+            entry->socket = SOCKET_EMPTY;
+            return;
+        }
+    }
+}
+
+inline
+bool _pnet_PopExpiredSocket(_pnet_Pool *pool, tims_t now, _pnet_Socket *out) {
+    assert(pool != NULL);
+    assert(out != NULL);
+
+    for (size_t i = 0; i < KDT_N_POOL; ++i) {
+        _pnet_PoolEntry *entry = &pool->entries[i];
+        if (!_pnet_IsSocketEmpty(&entry->socket) && entry->expires != 0 &&
+            entry->expires <= now) {
+            *out = entry->socket;
+            entry->socket = SOCKET_EMPTY;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
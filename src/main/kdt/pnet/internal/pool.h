@@ -0,0 +1,49 @@
+#ifndef KDT_PNET_INTERNAL_POOL_H
+#define KDT_PNET_INTERNAL_POOL_H
+
+#include "../host.h"
+#include "socket.h"
+#include <kdt/def.h>
+#include <kdt/err.h>
+#include <kdt/tims.h>
+#include <stdbool.h>
+
+typedef struct _pnet_Pool _pnet_Pool;
+typedef struct _pnet_PoolEntry _pnet_PoolEntry;
+
+struct _pnet_PoolEntry {
+    /// Host connected to.
+    pnet_Host host;
+
+    /// Connected socket, or SOCKET_EMPTY if entry is unused.
+    _pnet_Socket socket;
+
+    /// Time at which socket, if idle, expires, or 0 if socket is in use.
+    tims_t expires;
+};
+
+/**
+ * A pool of outbound connections, keyed by the hosts connected to.
+ *
+ * Each connection is either in use or idle. Idle connections may be taken and
+ * reused for sending further messages to the same host, until they expire.
+ * No more than KDT_N_POOL_HOST connections are allowed to be open to any one
+ * host at a time.
+ *
+ * @note The pool never opens or closes any sockets itself.
+ */
+struct _pnet_Pool {
+    /// Pool entries.
+    _pnet_PoolEntry entries[KDT_N_POOL];
+};
+
+void _pnet_InitPool(_pnet_Pool *pool);
+err_t _pnet_TakePooledSocket(_pnet_Pool *pool, const pnet_Host *host, _pnet_Socket *out);
+bool _pnet_AddPooledSocket(_pnet_Pool *pool, const pnet_Host *host,
+                           const _pnet_Socket *socket, _pnet_Socket *evicted);
+bool _pnet_ReleasePooledSocket(_pnet_Pool *pool, const _pnet_Socket *socket,
+                               tims_t expires);
+void _pnet_RemovePooledSocket(_pnet_Pool *pool, const _pnet_Socket *socket);
+bool _pnet_PopExpiredSocket(_pnet_Pool *pool, tims_t now, _pnet_Socket *out);
+
+#endif
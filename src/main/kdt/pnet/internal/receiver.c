@@ -1,3 +1,4 @@
+#include "batch.h"
 #include "header.h"
 #include "receiver.h"
 #include "server.h"
@@ -14,63 +15,246 @@ typedef struct _Context _Context;
 struct _Context {
     _pnet_Receiver *receiver;
     _pnet_Server *server;
+
+    /// Time at which receive round started.
+    tims_t now;
+
+    /// Whether receiving was held back during the previous receive round.
+    bool was_stalled;
+
+    /// Number of events in `pending`.
+    size_t pending_count;
+
+    /**
+     * Indexes of events which received all bytes requested from their sockets,
+     * meaning that more bytes may be available without the sockets again being
+     * reported as readable.
+     */
+    size_t pending[KDT_N_BUFFER_I_COUNT];
 };
 
 inline
 void _pnet_InitReceiver(_pnet_Receiver *receiver) {
-    const size_t size = _BUFFER_I_COUNT_SIZE_T * sizeof(size_t);
-    bitset_Init(&receiver->allocations, (uint8_t *) receiver->_allocations, size);
-    memset(receiver->_allocations, 0xff, size);
-
     const size_t count = KDT_N_BUFFER_I_COUNT;
-    cbufz_Init(&receiver->queue_ready, receiver->_queue_ready, count);
-    cbufz_Init(&receiver->queue_unready, receiver->_queue_unready, count);
+    abitset_Init(&receiver->allocations, receiver->_allocations, count);
+
+    mpmcz_Init(&receiver->queue_ready, receiver->_queue_ready, count);
+    mpmcz_Init(&receiver->queue_stalled, receiver->_queue_stalled, count);
+
+    wheel_Init(&receiver->wheel, tims_Now(), KDT_T_TICK);
+
+    _pnet_InitSlab(&receiver->slab);
+
+    for (size_t i = 0; i < count; ++i) {
+        atomic_init(&receiver->buffer[i].references, 0);
+        wheel_InitTimer(&receiver->buffer[i].timer);
+    }
+
+    receiver->datagrams_pending = false;
+    atomic_init(&receiver->stalled, false);
+
+    park_Init(&receiver->park);
 }
 
-inline
-_pnet_Event *_pnet_AllocateEvent(_pnet_Receiver *receiver) {
+/*
+ * Unless `size` is 0, the event is given the smallest available data buffer
+ * able to fit `size` bytes, header included. NULL is returned if no event, or
+ * no such buffer, is available.
+ */
+_pnet_Event *_pnet_AllocateEvent(_pnet_Receiver *receiver, size_t size) {
     size_t index;
-    if (!bitset_Allocate(&receiver->allocations, &index)) {
+    if (!abitset_Allocate(&receiver->allocations, &index)) {
         return NULL;
     }
     _pnet_Event *event = &receiver->buffer[index];
+    if (size == 0) {
+        event->data = NULL;
+        event->size = 0;
+    }
+    else if ((event->data = _pnet_AllocateSlab(&receiver->slab, size, &event->size)) == NULL) {
+        abitset_Set(&receiver->allocations, index);
+        return NULL;
+    }
     memset(&event->event, 0, sizeof(pnet_Event));
     event->index = index;
     event->socket = SOCKET_EMPTY;
     event->bytes_received = 0;
+    event->started = 0.0;
+    atomic_store_explicit(&event->references, 1, memory_order_relaxed);
     return event;
 }
 
+inline
+void _pnet_RetainEvent(_pnet_Event *event) {
+    atomic_fetch_add_explicit(&event->references, 1, memory_order_relaxed);
+}
+
+/*
+ * The release ordering of each decrement, and the acquire ordering of the
+ * last one, make sure that all uses of the event by other threads happen
+ * before it is freed.
+ */
+bool _pnet_ReleaseEvent(_pnet_Receiver *receiver, _pnet_Event *event) {
+    if (atomic_fetch_sub_explicit(&event->references, 1,
+                                  memory_order_acq_rel) != 1) {
+        return false;
+    }
+    _pnet_FreeEvent(receiver, event);
+    return true;
+}
+
+/*
+ * Works as `_pnet_ReleaseEvent()` for each event, except for that the buffer
+ * allocations of all freed events are returned with one atomic operation per
+ * bit set word, rather than one per event.
+ */
+bool _pnet_ReleaseEvents(_pnet_Receiver *receiver, pnet_Event **events, size_t count) {
+    size_t indexes[KDT_N_BATCH];
+    size_t index_count = 0;
+    bool is_any_freed = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        _pnet_Event *event = _pnet_AsPrivateEvent(events[i]);
+        if (atomic_fetch_sub_explicit(&event->references, 1,
+                                      memory_order_acq_rel) != 1) {
+            continue;
+        }
+        if (event->data != NULL) {
+            _pnet_FreeSlab(&receiver->slab, event->data);
+        }
+        indexes[index_count++] = event->index;
+        if (index_count == KDT_N_BATCH) {
+            abitset_SetMany(&receiver->allocations, indexes, index_count);
+            index_count = 0;
+        }
+        is_any_freed = true;
+    }
+    abitset_SetMany(&receiver->allocations, indexes, index_count);
+    return is_any_freed;
+}
+
 inline
 void _pnet_FreeEvent(_pnet_Receiver *receiver, _pnet_Event *event) {
-    bitset_Set(&receiver->allocations, event->index);
+    if (event->data != NULL) {
+        _pnet_FreeSlab(&receiver->slab, event->data);
+    }
+    abitset_Set(&receiver->allocations, event->index);
 }
 
-_pnet_Event *_pnet_PopReceivedEvent(_pnet_Receiver *receiver) {
-    size_t index;
-    if (cbufz_Pop(&receiver->queue_ready, &index)) {
-        return &receiver->buffer[index];
+size_t _pnet_PopReceivedEvents(_pnet_Receiver *receiver, pnet_Event **out, size_t max) {
+    size_t count = 0;
+    while (count < max) {
+        size_t indexes[KDT_N_BATCH];
+        const size_t limit = max - count < KDT_N_BATCH
+            ? max - count
+            : KDT_N_BATCH;
+        const size_t popped = mpmcz_PopMany(&receiver->queue_ready, indexes, limit);
+        for (size_t i = 0; i < popped; ++i) {
+            out[count + i] = &receiver->buffer[indexes[i]].event;
+        }
+        count += popped;
+        if (popped < limit) {
+            break;
+        }
     }
-    return NULL;
+    return count;
 }
 
 inline
 bool _pnet_PushEvent(_pnet_Receiver *receiver, _pnet_Event *event) {
-    return cbufz_Push(&receiver->queue_ready, event->index);
+    if (!mpmcz_Push(&receiver->queue_ready, event->index)) {
+        return false;
+    }
+    park_WakeOne(&receiver->park);
+    return true;
 }
 
+static
+err_t ReceiveDatagrams(_Context *context);
+
+static
+void DispatchDatagram(_Context *context, _pnet_Event *event,
+                      const _pnet_Datagram *datagram);
+
 static
 bool OnSocketReady(void *context, _pnet_Socket *socket);
 
 static
 void ReceiveOne(_Context *context, _pnet_Event *event);
 
+static
+void OnBatchOp(void *context, _pnet_BatchOp *op);
+
+static
+void DispatchMessages(_Context *context, _pnet_Event *event, bool drained);
+
+static
+bool IsComplete(_pnet_Event *event);
+
+static
+void Park(_Context *context, _pnet_Event *event);
+
+static
+void Stall(_Context *context, _pnet_Event *event);
+
+static
+bool IsOverdue(_pnet_Event *event, tims_t now);
+
+static
+tims_t GetDeadline(_pnet_Event *event);
+
+static
+bool IsFull(const _pnet_Event *event);
+
+static
+bool Resize(_pnet_Receiver *receiver, _pnet_Event *event, size_t size);
+
+static
+err_t ReadHeader(_pnet_Event *event);
+
+static
+void HandleError(_Context *context, _pnet_Event *event, err_t err);
+
+static
+void WarnFull(_Context *context);
+
+#define _TRY_FLUSH() do {                                                 \
+    if ((err = _pnet_FlushBatch(&server->batch, &context, OnBatchOp)) != \
+        ERR_NONE) {                                                       \
+        return err;                                                       \
+    }                                                                     \
+} while (0)
+
+/*
+ * Inbound connections carry requests, while outbound connections carry the
+ * responses to requests sent via them, and both are read alike. Each
+ * connection is read by at most one event at a time, which buffers received
+ * bytes until a complete message has been received. Reads are not
+ * limited to the size of the message being received, which means that one
+ * read may yield any number of back-to-back messages. Any bytes following a
+ * complete message are moved to a new event, which takes over reading from
+ * the connection. See `DispatchMessages()`. Events waiting for more bytes are
+ * parked with their sockets, which are mapped directly to their events when
+ * reported as readable, making the cost of each round proportional to the
+ * number of ready sockets rather than to the number of messages in progress.
+ * Connections not delivering the rest of a partially received message in time
+ * are closed when the timer of its event expires, as described in
+ * `GetDeadline()`, which frees the event buffers they would otherwise hold on
+ * to indefinitely. Only events waiting for event buffers to be freed are
+ * revisited every round.
+ */
 err_t _pnet_ReceiveIncoming(_pnet_Receiver *receiver, _pnet_Server *server) {
     assert(receiver != NULL);
     assert(server != NULL);
 
     err_t err;
-    _Context context = {.receiver = receiver, .server = server};
+    _Context context = {
+        .receiver = receiver,
+        .server = server,
+        .now = tims_Now(),
+        .was_stalled = atomic_exchange(&receiver->stalled, false),
+        .pending_count = 0,
+    };
     bool pending_accepts = false;
 
     _pnet_SocketSet socket_set;
@@ -78,106 +262,476 @@ err_t _pnet_ReceiveIncoming(_pnet_Receiver *receiver, _pnet_Server *server) {
         return err;
     }
 
-    // Handle data for existing/unready events.
-    while (true) {
+    // Close connections of overdue parked events.
+    wheel_Timer *timer;
+    while ((timer = wheel_Pop(&receiver->wheel, context.now)) != NULL) {
+        _pnet_Event *event = WHEEL_CONTAINER(timer, _pnet_Event, timer);
+        size_t index;
+        _pnet_UnparkSocket(server, &event->socket, &index);
+        if (_pnet_IsSocketReady(&socket_set, &event->socket)) {
+            _pnet_ClearSocket(&socket_set, &event->socket);
+        }
+        HandleError(&context, event, ERR_TIMEOUT);
+    }
+
+    // Handle events held back by lack of event buffers.
+    for (size_t i = KDT_N_BUFFER_I_COUNT; i-- != 0;) {
         size_t index;
-        if (!cbufz_Pop(&receiver->queue_unready, &index)) {
+        if (!mpmcz_Pop(&receiver->queue_stalled, &index)) {
             break;
         }
         _pnet_Event *event = &receiver->buffer[index];
-        if (!_pnet_IsSocketReady(&socket_set, &event->socket)) {
-            cbufz_Push(&receiver->queue_unready, event->index);
+        const _pnet_Socket socket = event->socket;
+        if (_pnet_IsSocketReady(&socket_set, &event->socket)) {
+            _pnet_ClearSocket(&socket_set, &event->socket);
+        }
+        if (_pnet_IsSocketClosing(server, &socket)) {
+            // Connection closed by sender while event was stalled.
+            HandleError(&context, event, ECONNRESET);
+            _pnet_UnpinSocket(server, &socket);
             continue;
         }
-        _pnet_ClearSocket(&socket_set, &event->socket);
+        _pnet_UnpinSocket(server, &socket);
+        if (IsComplete(event)) {
+            // No event was available for the bytes following the message.
+            DispatchMessages(&context, event, false);
+            continue;
+        }
+        if (IsOverdue(event, context.now)) {
+            HandleError(&context, event, ERR_TIMEOUT);
+            continue;
+        }
+        // No larger buffer was available for the rest of the message.
         ReceiveOne(&context, event);
+        if (_pnet_IsBatchFull(&server->batch)) {
+            _TRY_FLUSH();
+        }
     }
 
-    // Handle data for new events.
+    // Handle data for parked and new events.
     _pnet_ForEachReadySocket(&socket_set, &pending_accepts, &context, OnSocketReady);
+    _TRY_FLUSH();
+
+    // Keep receiving for as long as complete reads are made.
+    while (context.pending_count > 0) {
+        do {
+            const size_t index = context.pending[--context.pending_count];
+            ReceiveOne(&context, &receiver->buffer[index]);
+        } while (context.pending_count > 0 && !_pnet_IsBatchFull(&server->batch));
+        _TRY_FLUSH();
+    }
 
-    return pending_accepts
+    if (server->interface->transport == PNET_TRANSPORT_UDP) {
+        return pending_accepts || receiver->datagrams_pending
+            ? ReceiveDatagrams(&context)
+            : ERR_NONE;
+    }
+    return pending_accepts || server->accepts_pending
         ? _pnet_Accept(server)
         : ERR_NONE;
 }
 
+#undef _TRY_FLUSH
+
+/*
+ * Datagrams are received via the interface socket directly into newly
+ * allocated events, up to KDT_N_BATCH at a time, until the socket is drained.
+ * If event buffers run out first, receiving is resumed during the next poll,
+ * as the socket may not be reported readable again.
+ */
+static
+err_t ReceiveDatagrams(_Context *context) {
+    _pnet_Receiver *receiver = context->receiver;
+
+    _pnet_Socket socket;
+    _pnet_GetInterfaceSocket(context->server, &socket);
+
+    for (;;) {
+        _pnet_Event *events[KDT_N_BATCH];
+        _pnet_Datagram datagrams[KDT_N_BATCH];
+
+        size_t count;
+        for (count = 0; count < KDT_N_BATCH; ++count) {
+            _pnet_Event *event = _pnet_AllocateEvent(receiver, _PNET_SLAB_L_SIZE);
+            if (event == NULL) {
+                break;
+            }
+            events[count] = event;
+            datagrams[count] = (_pnet_Datagram) {
+                .data = event->data,
+                .size = event->size,
+            };
+        }
+        if (count == 0) {
+            WarnFull(context);
+            receiver->datagrams_pending = true;
+            atomic_store(&receiver->stalled, true);
+            return ERR_NONE;
+        }
+
+        size_t received;
+        err_t err = _pnet_ReceiveDatagrams(&socket, datagrams, count, &received);
+        for (size_t i = 0; i < received; ++i) {
+            DispatchDatagram(context, events[i], &datagrams[i]);
+        }
+        for (size_t i = received; i < count; ++i) {
+            _pnet_FreeEvent(receiver, events[i]);
+        }
+        if (err != ERR_NONE || received < count) {
+            receiver->datagrams_pending = false;
+            return err == EAGAIN || err == EWOULDBLOCK
+                ? ERR_NONE
+                : err;
+        }
+    }
+}
+
+/*
+ * Each datagram must contain exactly one complete message, which must not be
+ * continued by any other, or it is silently discarded. Every received message
+ * is reported to the server, as it may acknowledge a sent datagram.
+ */
+static
+void DispatchDatagram(_Context *context, _pnet_Event *event,
+                      const _pnet_Datagram *datagram) {
+    event->bytes_received = datagram->size;
+    if (event->bytes_received < _PNET_HEADER_SIZE || ReadHeader(event) != ERR_NONE ||
+        event->bytes_received != _PNET_HEADER_SIZE +
+                                 mem_Capacity(&event->event.as_message.data) ||
+        event->event.as_message.is_continued) {
+        _pnet_FreeEvent(context->receiver, event);
+        return;
+    }
+    event->event.as_message.sender = datagram->host;
+
+    // Free large buffer for further receiving, if a smaller one is available.
+    if (event->bytes_received <= _PNET_SLAB_M_SIZE) {
+        Resize(context->receiver, event, event->bytes_received);
+    }
+
+    _pnet_HandleReply(context->server, &event->event.as_message.nonce,
+                      &event->event.as_message.sender);
+
+    if (!_pnet_PushEvent(context->receiver, event)) {
+        log_Warn("Receiver event queue is full; message discarded.");
+        _pnet_FreeEvent(context->receiver, event);
+    }
+}
+
+/*
+ * Sockets with parked events are received from via those events, while other
+ * sockets are given new events, unless being closed, as closing sockets are
+ * only kept open for as long as they remain pinned.
+ */
 static
 bool OnSocketReady(void *context, _pnet_Socket *socket) {
     _Context *_context = context;
 
-    _pnet_Event *event = _pnet_AllocateEvent(_context->receiver);
+    if (_pnet_IsBatchFull(&_context->server->batch)) {
+        err_t err = _pnet_FlushBatch(&_context->server->batch, context, OnBatchOp);
+        if (err != ERR_NONE) {
+            return false;
+        }
+    }
+    size_t index;
+    if (_pnet_UnparkSocket(_context->server, socket, &index)) {
+        _pnet_Event *parked = &_context->receiver->buffer[index];
+        wheel_Cancel(&_context->receiver->wheel, &parked->timer);
+        ReceiveOne(_context, parked);
+        return true;
+    }
+    if (_pnet_IsSocketClosing(_context->server, socket)) {
+        return true;
+    }
+    _pnet_Event *event = _pnet_AllocateEvent(_context->receiver, _PNET_HEADER_SIZE);
     if (event == NULL) {
-        log_Warn("All receiver message buffers are full.");
+        WarnFull(_context);
+        atomic_store(&_context->receiver->stalled, true);
         return false;
     }
     event->socket = *socket;
+
+    // Get IP address of sending host. Connections failing before any message
+    // was received, such as outbound connections that could not be set up,
+    // are closed without reporting anything, as there is nothing to report.
+    err_t err = _pnet_ResolveHost(_context->server, &event->socket,
+                                  &event->event.as_message.sender);
+    if (err != ERR_NONE) {
+        _pnet_CloseSocket(_context->server, &event->socket);
+        _pnet_FreeEvent(_context->receiver, event);
+        return true;
+    }
+
     ReceiveOne(_context, event);
     return true;
 }
 
-#define _TRY(ERR) do {               \
-    if ((err = (ERR)) != ERR_NONE) { \
-        goto error;                  \
-    }                                \
-} while (0)
-
+/*
+ * Event buffers start out small, and are replaced by larger ones only when
+ * full and known to belong to larger messages. If no larger buffer is
+ * available, the event is stalled until some buffer is freed.
+ */
 static
 void ReceiveOne(_Context *context, _pnet_Event *event) {
-    pnet_EventMessage *message = &event->event.as_message;
-    size_t bytes_remaining;
-    size_t n;
-    err_t err;
+    if (IsFull(event)) {
+        const size_t size = _PNET_HEADER_SIZE +
+                            mem_Capacity(&event->event.as_message.data);
+        if (!Resize(context->receiver, event, size)) {
+            Stall(context, event);
+            return;
+        }
+    }
+
+    // Receive as many bytes as fit in the event buffer.
+    _pnet_BatchReceive(&context->server->batch, &event->socket,
+                       &event->data[event->bytes_received],
+                       event->size - event->bytes_received, event);
+}
+
+static
+void OnBatchOp(void *context, _pnet_BatchOp *op) {
+    _Context *_context = context;
+    _pnet_Event *event = op->context;
+
+    assert(op->type == _PNET_BATCH_RECEIVE);
+
+    if (op->err == EAGAIN || op->err == EWOULDBLOCK) {
+        Park(_context, event);
+        return;
+    }
+    if (op->err != ERR_NONE) {
+        HandleError(_context, event, op->err);
+        return;
+    }
+    if (op->size == 0) {
+        if (event->bytes_received == 0) {
+            // Connection closed before any new message was sent.
+            _pnet_CloseSocket(_context->server, &event->socket);
+            _pnet_FreeEvent(_context->receiver, event);
+        }
+        else {
+            HandleError(_context, event, ECONNRESET);
+        }
+        return;
+    }
+
+    _pnet_TouchSocket(_context->server, &event->socket, op->size, 0);
+    _pnet_RenewQuickAck(_context->server, &event->socket);
 
-    // Get IP address of sending host, if haven't already.
     if (event->bytes_received == 0) {
-        _TRY(_pnet_ResolveHost(context->server, &event->socket,
-                               &event->event.as_message.sender));
+        event->started = _context->now;
     }
 
-    // Receive message header, if haven't already.
-    if (event->bytes_received < _PNET_HEADER_SIZE) {
-        bytes_remaining = _PNET_HEADER_SIZE - event->bytes_received;
+    // A short read means the socket has no more data to offer right now.
+    const bool drained = op->size < event->size - event->bytes_received;
+
+    const bool had_header = event->bytes_received >= _PNET_HEADER_SIZE;
+    event->bytes_received += op->size;
+    if (!had_header && event->bytes_received >= _PNET_HEADER_SIZE) {
+        err_t err = ReadHeader(event);
+        if (err != ERR_NONE) {
+            HandleError(_context, event, err);
+            return;
+        }
+    }
+
+    DispatchMessages(_context, event, drained);
+}
+
+/*
+ * Publishes every complete message buffered by `event`, moving any bytes
+ * following each such message to a new event. The last event, which holds
+ * either an incomplete message or no bytes at all, is then either parked until
+ * the connection again becomes readable, if `drained`, or kept pending for
+ * reading more bytes during the same round. Empty events are never parked. As
+ * frames of the same message are sent in sequence via the same connection,
+ * the offset of each frame is kept track of by the connection. The first frame
+ * of every message is reported to the server, as it may reply to a request.
+ */
+static
+void DispatchMessages(_Context *context, _pnet_Event *event, bool drained) {
+    while (IsComplete(event)) {
+        const size_t end = _PNET_HEADER_SIZE +
+                           mem_Capacity(&event->event.as_message.data);
+        const size_t surplus = event->bytes_received - end;
+
+        _pnet_Event *next = NULL;
+        if (surplus > 0 || !drained) {
+            next = _pnet_AllocateEvent(context->receiver, _PNET_HEADER_SIZE + surplus);
+            if (next == NULL) {
+                // Try again when some event buffer has been freed.
+                Stall(context, event);
+                return;
+            }
+            next->socket = event->socket;
+            next->event.as_message.sender = event->event.as_message.sender;
+            memcpy(next->data, &event->data[end], surplus);
+            next->bytes_received = surplus;
+            next->started = context->now;
+            event->bytes_received = end;
+        }
 
-        n = bytes_remaining;
-        _TRY(_pnet_Receive(&event->socket, &n, &event->data[event->bytes_received]));
-        event->bytes_received += n;
+        pnet_EventMessage *message = &event->event.as_message;
+        message->offset = _pnet_ContinueSocket(context->server, &event->socket,
+                                               mem_Capacity(&message->data),
+                                               message->is_continued);
+        if (message->offset == 0) {
+            _pnet_HandleReply(context->server, &message->nonce, &message->sender);
+        }
 
-        if (event->bytes_received < _PNET_HEADER_SIZE) {
-            goto requeue;
+        if (!_pnet_PushEvent(context->receiver, event)) {
+            log_Warn("Receiver event queue is full; message discarded.");
+            _pnet_FreeEvent(context->receiver, event);
         }
 
-        mem_t mem = mem_FromBuffer(event->data, _PNET_HEADER_SIZE);
-        mem_Read(&mem, sizeof(kint_t), message->nonce.as_u8s);
-        mem_ReadU16BE(&mem, &message->tag);
-        uint16_t size;
-        if (!mem_ReadU16BE(&mem, &size)) {
-            size = 0;
+        if (next == NULL) {
+            return;
+        }
+        event = next;
+        if (event->bytes_received >= _PNET_HEADER_SIZE) {
+            err_t err = ReadHeader(event);
+            if (err != ERR_NONE) {
+                HandleError(context, event, err);
+                return;
+            }
         }
-        message->data = mem_FromBuffer(event->data, size);
     }
 
-    // Receive more of or all of message body.
-    {
-        bytes_remaining = _PNET_HEADER_SIZE + mem_Size(&message->data) -
-                          event->bytes_received;
+    if (drained) {
+        Park(context, event);
+    }
+    else {
+        context->pending[context->pending_count++] = event->index;
+    }
+}
 
-        n = bytes_remaining;
-        _TRY(_pnet_Receive(&event->socket, &n, &event->data[event->bytes_received]));
-        event->bytes_received += n;
+static
+bool IsComplete(_pnet_Event *event) {
+    return event->bytes_received >= _PNET_HEADER_SIZE &&
+           event->bytes_received >= _PNET_HEADER_SIZE +
+                                    mem_Capacity(&event->event.as_message.data);
+}
 
-        if (event->bytes_received < bytes_remaining) {
-            goto requeue;
+/*
+ * Leaves `event` waiting for its socket to become readable, with its timer
+ * armed to expire when its message becomes overdue. Events without any bytes
+ * are freed instead, as nothing would be lost by receiving into a new event
+ * once more bytes arrive. A closing socket no longer parked with is closed
+ * when its event is freed, as no new event would be given to it.
+ */
+static
+void Park(_Context *context, _pnet_Event *event) {
+    if (event->bytes_received == 0) {
+        if (_pnet_IsSocketClosing(context->server, &event->socket)) {
+            _pnet_CloseSocket(context->server, &event->socket);
         }
+        _pnet_FreeEvent(context->receiver, event);
+        return;
     }
+    if (!_pnet_ParkSocket(context->server, &event->socket, event->index)) {
+        HandleError(context, event, ERR_NOT_VALID);
+        return;
+    }
+    wheel_Arm(&context->receiver->wheel, &event->timer, GetDeadline(event));
+}
+
+/*
+ * Holds `event` back until the next receive round. Its socket is pinned until
+ * then, as the sender may close outbound sockets, and their descriptors must
+ * not be reused while stalled events still refer to them.
+ */
+static
+void Stall(_Context *context, _pnet_Event *event) {
+    if (!_pnet_PinSocket(context->server, &event->socket)) {
+        HandleError(context, event, ECONNRESET);
+        return;
+    }
+    atomic_store(&context->receiver->stalled, true);
+    mpmcz_Push(&context->receiver->queue_stalled, event->index);
+}
 
-requeue:
-    cbufz_Push(&context->receiver->queue_unready, event->index);
-    return;
+static
+bool IsOverdue(_pnet_Event *event, tims_t now) {
+    return event->bytes_received != 0 && !IsComplete(event) &&
+           now >= GetDeadline(event);
+}
+
+/*
+ * A message is overdue if not received in full within KDT_T_RECEIVE seconds
+ * of its first byte arriving, plus the time it would take to receive its bytes
+ * at KDT_N_RECEIVE_RATE bytes per second. The size of a message is only known
+ * after its header has been received, which is why it is assumed to consist of
+ * only a header until then. Peers sending messages too slowly, or never
+ * finishing them, would otherwise be able to hold on to event buffers, and
+ * their connections, for as long as they keep sending any bytes at all.
+ */
+static
+tims_t GetDeadline(_pnet_Event *event) {
+    const size_t size = event->bytes_received >= _PNET_HEADER_SIZE
+        ? _PNET_HEADER_SIZE + mem_Capacity(&event->event.as_message.data)
+        : _PNET_HEADER_SIZE;
+    return event->started + KDT_T_RECEIVE +
+           (tims_t) size / (tims_t) KDT_N_RECEIVE_RATE;
+}
 
-error:
-    if (err == EAGAIN) {
-        goto requeue;
+/*
+ * A full event buffer that does not contain a complete message must be
+ * replaced by a larger one before more bytes can be received.
+ */
+static
+bool IsFull(const _pnet_Event *event) {
+    return event->bytes_received == event->size;
+}
+
+/*
+ * Moves the bytes received by `event` to the smallest available buffer able to
+ * fit `size` bytes. False is returned only if no such buffer is available.
+ */
+static
+bool Resize(_pnet_Receiver *receiver, _pnet_Event *event, size_t size) {
+    size_t capacity;
+    uint8_t *data = _pnet_AllocateSlab(&receiver->slab, size, &capacity);
+    if (data == NULL) {
+        return false;
+    }
+    memcpy(data, event->data, event->bytes_received);
+    _pnet_FreeSlab(&receiver->slab, event->data);
+    event->data = data;
+    event->size = capacity;
+
+    // Let message payload refer to new buffer.
+    if (event->bytes_received >= _PNET_HEADER_SIZE) {
+        ReadHeader(event);
+    }
+    return true;
+}
+
+static
+err_t ReadHeader(_pnet_Event *event) {
+    pnet_EventMessage *message = &event->event.as_message;
+
+    mem_t mem = mem_FromBuffer(event->data, _PNET_HEADER_SIZE);
+    mem_Read(&mem, sizeof(kint_t), message->nonce.as_u8s);
+    mem_ReadU16BE(&mem, &message->tag);
+    message->is_continued = (message->tag & _PNET_TAG_MORE) != 0;
+    message->tag &= (uint16_t) ~_PNET_TAG_MORE;
+    uint16_t size;
+    if (!mem_ReadU16BE(&mem, &size)) {
+        size = 0;
+    }
+#if KDT_N_BUFFER_SIZE < UINT16_MAX
+    // Frames can only be too large if buffers cannot fit the largest size.
+    if (size > KDT_N_BUFFER_SIZE) {
+        return ERR_TOO_LARGE;
     }
+#endif
+    message->type = PNET_EVENT_MESSAGE;
+    message->data = mem_FromBuffer(&event->data[_PNET_HEADER_SIZE], size);
+    return ERR_NONE;
+}
+
+static
+void HandleError(_Context *context, _pnet_Event *event, err_t err) {
     _pnet_CloseSocket(context->server, &event->socket);
 
     _pnet_Error serr = {
@@ -193,6 +747,17 @@ error:
         serr.tag = 0;
     }
     _pnet_HandleError(context->server, &serr);
+    _pnet_FreeEvent(context->receiver, event);
 }
 
-#undef _TRY
\ No newline at end of file
+/*
+ * Warns only once per stall, as the receiver may remain full for many
+ * consecutive receive rounds.
+ */
+static
+void WarnFull(_Context *context) {
+    if (!context->was_stalled) {
+        log_Warn("All receiver message buffers are full.");
+        context->was_stalled = true;
+    }
+}
\ No newline at end of file
@@ -2,12 +2,12 @@
 #define KDT_PNET_INTERNAL_RECEIVER_H
 
 #include "event.h"
-#include <kdt/bitset.h>
-#include <kdt/cbuf.h>
-
-#define _BUFFER_I_COUNT_SIZE_T \
-    ((KDT_N_BUFFER_I_COUNT / (sizeof(size_t) * 8)) + \
-     ((KDT_N_BUFFER_I_COUNT % (sizeof(size_t) * 8)) == 0 ? 0 : 1))
+#include "slab.h"
+#include <kdt/abitset.h>
+#include <kdt/mpmc.h>
+#include <kdt/park.h>
+#include <kdt/wheel.h>
+#include <stdatomic.h>
 
 typedef struct _pnet_Receiver _pnet_Receiver;
 typedef struct _pnet_Server _pnet_Server;
@@ -16,29 +16,47 @@ struct _pnet_Receiver {
     /// Event buffer.
     _pnet_Event buffer[KDT_N_BUFFER_I_COUNT];
 
+    /// Event data buffers.
+    _pnet_Slab slab;
+
     /// Bit set for keeping track of event buffer allocations.
-    bitset_t allocations;
+    abitset_t allocations;
 
     /// Queue with buffer indexes of fully received events.
-    cbufz_t queue_ready;
+    mpmcz_t queue_ready;
+
+    /// Queue with buffer indexes of events waiting for event buffers to be freed.
+    mpmcz_t queue_stalled;
+
+    /// Timers of events waiting for their sockets to become readable.
+    wheel_t wheel;
+
+    /// Whether datagrams were left unreceived due to lack of event buffers.
+    bool datagrams_pending;
+
+    /// Whether receiving was held back during the last poll due to lack of buffers.
+    atomic_bool stalled;
 
-    /// Queue with buffer indexes of partially received events.
-    cbufz_t queue_unready;
+    /// Threads waiting for events to become ready.
+    park_t park;
 
     /// Backing memory for bit set.
-    size_t _allocations[_BUFFER_I_COUNT_SIZE_T];
+    atomic_size_t _allocations[ABITSET_WORDS(KDT_N_BUFFER_I_COUNT)];
 
     /// Backing memory for ready queue.
-    size_t _queue_ready[KDT_N_BUFFER_I_COUNT];
+    mpmcz_Cell _queue_ready[KDT_N_BUFFER_I_COUNT];
 
-    /// Backing memory for unready queue.
-    size_t _queue_unready[KDT_N_BUFFER_I_COUNT];
+    /// Backing memory for stalled queue, which must be able to fit all events.
+    mpmcz_Cell _queue_stalled[KDT_N_BUFFER_I_COUNT];
 };
 
 void _pnet_InitReceiver(_pnet_Receiver *receiver);
-_pnet_Event *_pnet_AllocateEvent(_pnet_Receiver *receiver);
+_pnet_Event *_pnet_AllocateEvent(_pnet_Receiver *receiver, size_t size);
 void _pnet_FreeEvent(_pnet_Receiver *receiver, _pnet_Event *event);
-_pnet_Event *_pnet_PopReceivedEvent(_pnet_Receiver *receiver);
+void _pnet_RetainEvent(_pnet_Event *event);
+bool _pnet_ReleaseEvent(_pnet_Receiver *receiver, _pnet_Event *event);
+bool _pnet_ReleaseEvents(_pnet_Receiver *receiver, pnet_Event **events, size_t count);
+size_t _pnet_PopReceivedEvents(_pnet_Receiver *receiver, pnet_Event **out, size_t max);
 bool _pnet_PushEvent(_pnet_Receiver *receiver, _pnet_Event *event);
 err_t _pnet_ReceiveIncoming(_pnet_Receiver *receiver, _pnet_Server *server);
 
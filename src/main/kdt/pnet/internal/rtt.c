@@ -0,0 +1,150 @@
+#include "rtt.h"
+#include <assert.h>
+
+static
+_pnet_RttProbe *GetProbe(_pnet_Rtt *rtt, const kint_t *nonce);
+
+inline
+void _pnet_InitRtt(_pnet_Rtt *rtt) {
+    assert(rtt != NULL);
+
+    for (size_t i = 0; i < KDT_N_RTT_PEERS; ++i) {
+        rtt->peers[i].is_set = false;
+    }
+    for (size_t i = 0; i < KDT_N_RTT_PROBES; ++i) {
+        rtt->probes[i].sent = 0;
+    }
+}
+
+/*
+ * Any request already awaiting a reply in the entry of `nonce` is forgotten.
+ */
+void _pnet_AddRttProbe(_pnet_Rtt *rtt, const kint_t *nonce, const pnet_Host *host,
+                       tims_t sent) {
+    assert(rtt != NULL);
+    assert(nonce != NULL);
+    assert(host != NULL);
+    assert(sent > 0);
+
+    _pnet_RttProbe *probe = GetProbe(rtt, nonce);
+    probe->nonce = *nonce;
+    probe->host = *host;
+    probe->sent = sent;
+}
+
+/*
+ * Requests sent more than once must be forgotten, as it cannot be known which
+ * of the sent copies a reply would answer.
+ */
+void _pnet_RemoveRttProbe(_pnet_Rtt *rtt, const kint_t *nonce) {
+    assert(rtt != NULL);
+    assert(nonce != NULL);
+
+    _pnet_RttProbe *probe = GetProbe(rtt, nonce);
+    if (probe->sent != 0 && kint_EQU(&probe->nonce, nonce)) {
+        probe->sent = 0;
+    }
+}
+
+/*
+ * Updates the estimate of `host` if a request with `nonce` was sent to it and
+ * is still awaiting a reply, after which the request is forgotten. Returns
+ * false only if no such request was found.
+ */
+bool _pnet_MeasureRtt(_pnet_Rtt *rtt, const kint_t *nonce, const pnet_Host *host,
+                      tims_t now) {
+    assert(rtt != NULL);
+    assert(nonce != NULL);
+    assert(host != NULL);
+
+    _pnet_RttProbe *probe = GetProbe(rtt, nonce);
+    if (probe->sent == 0 || !kint_EQU(&probe->nonce, nonce) ||
+        !pnet_IsHostEqual(&probe->host, host)) {
+        return false;
+    }
+    const tims_t sent = probe->sent;
+    probe->sent = 0;
+    if (now >= sent) {
+        _pnet_UpdateRtt(rtt, host, now - sent);
+    }
+    return true;
+}
+
+/*
+ * The first sample of a host becomes its smoothed round-trip time, with half of
+ * it as variation. Later samples are weighed in with gains of 1/8 and 1/4,
+ * respectively, as recommended by RFC 6298.
+ */
+void _pnet_UpdateRtt(_pnet_Rtt *rtt, const pnet_Host *host, tims_t sample) {
+    assert(rtt != NULL);
+    assert(host != NULL);
+    assert(sample >= 0.0);
+
+    _pnet_RttPeer *peer = &rtt->peers[pnet_HashHost(host) % KDT_N_RTT_PEERS];
+    if (!peer->is_set || !pnet_IsHostEqual(&peer->host, host)) {
+        peer->host = *host;
+        peer->is_set = true;
+        peer->srtt = sample;
+        peer->rttvar = sample / 2.0;
+        return;
+    }
+    const tims_t error = peer->srtt > sample
+        ? peer->srtt - sample
+        : sample - peer->srtt;
+    peer->rttvar = 0.75 * peer->rttvar + 0.25 * error;
+    peer->srtt = 0.875 * peer->srtt + 0.125 * sample;
+}
+
+inline
+bool _pnet_GetRtt(const _pnet_Rtt *rtt, const pnet_Host *host, tims_t *srtt,
+                  tims_t *rttvar) {
+    assert(rtt != NULL);
+    assert(host != NULL);
+    assert(srtt != NULL);
+    assert(rttvar != NULL);
+
+    const _pnet_RttPeer *peer = &rtt->peers[pnet_HashHost(host) % KDT_N_RTT_PEERS];
+    if (!peer->is_set || !pnet_IsHostEqual(&peer->host, host)) {
+        return false;
+    }
+    *srtt = peer->srtt;
+    *rttvar = peer->rttvar;
+    return true;
+}
+
+/*
+ * Returns the retransmission timeout of `host`, which is its smoothed
+ * round-trip time plus four times its variation, but no less than KDT_T_TICK
+ * more than the former. The timeout is kept within KDT_T_RTO_MIN and
+ * KDT_T_RTO_MAX, and is KDT_T_RETRANSMIT for hosts not yet measured.
+ */
+tims_t _pnet_GetRto(const _pnet_Rtt *rtt, const pnet_Host *host) {
+    assert(rtt != NULL);
+    assert(host != NULL);
+
+    tims_t srtt, rttvar;
+    if (!_pnet_GetRtt(rtt, host, &srtt, &rttvar)) {
+        return KDT_T_RETRANSMIT;
+    }
+    tims_t rto = srtt + (4.0 * rttvar > KDT_T_TICK ? 4.0 * rttvar : KDT_T_TICK);
+    if (rto < KDT_T_RTO_MIN) {
+        rto = KDT_T_RTO_MIN;
+    }
+    else if (rto > KDT_T_RTO_MAX) {
+        rto = KDT_T_RTO_MAX;
+    }
+    return rto;
+}
+
+/*
+ * Nonces are expected to be random, which is why their leading bytes are used
+ * as index without further hashing.
+ */
+static
+_pnet_RttProbe *GetProbe(_pnet_Rtt *rtt, const kint_t *nonce) {
+    const uint32_t index = (uint32_t) nonce->as_u8s[0] << 24 |
+                           (uint32_t) nonce->as_u8s[1] << 16 |
+                           (uint32_t) nonce->as_u8s[2] << 8 |
+                           (uint32_t) nonce->as_u8s[3];
+    return &rtt->probes[index % KDT_N_RTT_PROBES];
+}
@@ -0,0 +1,68 @@
+#ifndef KDT_PNET_INTERNAL_RTT_H
+#define KDT_PNET_INTERNAL_RTT_H
+
+#include "../host.h"
+#include <kdt/def.h>
+#include <kdt/kint.h>
+#include <kdt/tims.h>
+#include <stdbool.h>
+
+typedef struct _pnet_Rtt _pnet_Rtt;
+typedef struct _pnet_RttPeer _pnet_RttPeer;
+typedef struct _pnet_RttProbe _pnet_RttProbe;
+
+struct _pnet_RttPeer {
+    /// Host round-trip times are measured to.
+    pnet_Host host;
+
+    /// Whether entry holds any measurements.
+    bool is_set;
+
+    /// Smoothed round-trip time, in seconds.
+    tims_t srtt;
+
+    /// Round-trip time variation, in seconds.
+    tims_t rttvar;
+};
+
+struct _pnet_RttProbe {
+    /// Nonce of request awaiting reply.
+    kint_t nonce;
+
+    /// Receiver of request.
+    pnet_Host host;
+
+    /// Time at which request was sent, or 0 if entry is unused.
+    tims_t sent;
+};
+
+/**
+ * Round-trip time estimates of peers, measured from the time requests are sent
+ * to the time replies with the same nonces are received from their receivers.
+ *
+ * Estimates are smoothed as described by Jacobson and Karels, and are kept in
+ * a table indexed by host hashes, each host replacing any other host already
+ * occupying its entry. Requests awaiting replies are likewise kept in a table
+ * indexed by their nonces, which means that a request may be forgotten before
+ * its reply arrives, in which case no measurement is made.
+ */
+struct _pnet_Rtt {
+    /// Round-trip time estimates, indexed by host hashes.
+    _pnet_RttPeer peers[KDT_N_RTT_PEERS];
+
+    /// Requests awaiting replies, indexed by nonces.
+    _pnet_RttProbe probes[KDT_N_RTT_PROBES];
+};
+
+void _pnet_InitRtt(_pnet_Rtt *rtt);
+void _pnet_AddRttProbe(_pnet_Rtt *rtt, const kint_t *nonce, const pnet_Host *host,
+                       tims_t sent);
+void _pnet_RemoveRttProbe(_pnet_Rtt *rtt, const kint_t *nonce);
+bool _pnet_MeasureRtt(_pnet_Rtt *rtt, const kint_t *nonce, const pnet_Host *host,
+                      tims_t now);
+void _pnet_UpdateRtt(_pnet_Rtt *rtt, const pnet_Host *host, tims_t sample);
+bool _pnet_GetRtt(const _pnet_Rtt *rtt, const pnet_Host *host, tims_t *srtt,
+                  tims_t *rttvar);
+tims_t _pnet_GetRto(const _pnet_Rtt *rtt, const pnet_Host *host);
+
+#endif
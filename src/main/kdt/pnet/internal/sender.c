@@ -1,3 +1,4 @@
+#include "batch.h"
 #include "header.h"
 #include "sender.h"
 #include "server.h"
@@ -7,153 +8,1355 @@
 #include <errno.h>
 #include <string.h>
 
+typedef struct _Context _Context;
+typedef struct _Gather _Gather;
+
+/**
+ * Messages sent together via the same socket by a single write.
+ */
+struct _Gather {
+    /// Socket messages are sent via.
+    _pnet_Socket socket;
+
+    /// Whether more messages may be added.
+    bool is_open;
+
+    /// Number of messages in `messages`.
+    size_t count;
+
+    /// Messages, in the order their bytes are sent.
+    _pnet_Message *messages[KDT_N_GATHER];
+
+    /// Number of bytes of each message in `messages` being sent.
+    size_t sizes[KDT_N_GATHER];
+};
+
+struct _Context {
+    _pnet_Sender *sender;
+    _pnet_Server *server;
+    _pnet_SocketSet *socket_set;
+
+    /// Time at which send round started.
+    tims_t now;
+
+    /// Number of messages in `connected`.
+    size_t connected_count;
+
+    /// Indexes of messages of which sockets were connected during this poll.
+    size_t connected[KDT_N_BUFFER_O_COUNT];
+
+    /// Number of gathers in `gathers`.
+    size_t gather_count;
+
+    /// Messages to send when the batch is next flushed, one gather per socket.
+    _Gather gathers[KDT_N_BATCH];
+};
+
+static
+bool AcquireCredit(_pnet_Sender *sender, _pnet_Message *message);
+
+static
+void ReleaseCredit(_pnet_Sender *sender, _pnet_Message *message);
+
+static
+void FreeMessage(_pnet_Sender *sender, _pnet_Message *message);
+
+static
+size_t *GetUnacknowledged(_pnet_Sender *sender, const kint_t *nonce);
+
+static
+size_t GetWireSize(_pnet_Message *message);
+
+static
+tims_t GetLifetime(_pnet_Message *message);
+
+static
+bool PushLane(_pnet_Sender *sender, _pnet_Message *message);
+
+static
+bool PopLane(_pnet_Sender *sender, size_t *index);
+
+/// Number of messages popped from each lane before the next, by priority.
+static const size_t _LANE_WEIGHTS[_PNET_LANE_COUNT] = {
+    [PNET_PRIORITY_NORMAL] = KDT_N_WEIGHT_NORMAL,
+    [PNET_PRIORITY_HIGH] = KDT_N_WEIGHT_HIGH,
+    [PNET_PRIORITY_LOW] = KDT_N_WEIGHT_LOW,
+};
+
 inline
 void _pnet_InitSender(_pnet_Sender *sender) {
-    size_t size = _BUFFER_O_COUNT_SIZE_T * sizeof(size_t);
-    bitset_Init(&sender->allocations, (uint8_t *) sender->_allocations, size);
-    memset(sender->_allocations, 0xff, size);
-
     const size_t count = KDT_N_BUFFER_O_COUNT;
-    cbufz_Init(&sender->queue, sender->_queue, count);
+    abitset_Init(&sender->allocations, sender->_allocations, count);
+
+    for (size_t i = 0; i < _PNET_LANE_COUNT; ++i) {
+        mpmcz_Init(&sender->lanes[i], sender->_lanes[i], count);
+    }
+    sender->lane = 0;
+    sender->lane_budget = _LANE_WEIGHTS[0];
+    sender->requeued_count = 0;
+
+    wheel_Init(&sender->wheel, tims_Now(), KDT_T_TICK);
+    mpmcz_Init(&sender->acknowledged, sender->_acknowledged, count);
+    for (size_t i = 0; i < count; ++i) {
+        sender->unacknowledged[i] = SIZE_MAX;
+    }
+    mtx_Init(&sender->unacknowledged_lock);
+
+    for (size_t i = 0; i < KDT_N_PEER_CREDIT_BUCKETS; ++i) {
+        atomic_init(&sender->credits[i], 0);
+    }
+    park_Init(&sender->park);
+
+    _pnet_InitRtt(&sender->rtt);
+    mtx_Init(&sender->rtt_lock);
+
+    _pnet_InitSlab(&sender->slab);
+
+    for (size_t i = 0; i < count; ++i) {
+        sender->buffer[i].retransmit = 0;
+        wheel_InitTimer(&sender->buffer[i].timer);
+    }
 }
 
-_pnet_Message *_pnet_AllocateMessage(_pnet_Sender *sender) {
+/*
+ * The message is given the smallest available data buffer able to fit a
+ * payload of `size` bytes. Its payload capacity may exceed `size`.
+ */
+_pnet_Message *_pnet_AllocateMessage(_pnet_Sender *sender, size_t size) {
+    if (size > _PNET_FRAME_SIZE) {
+        return NULL;
+    }
     size_t index;
-    if (!bitset_Allocate(&sender->allocations, &index)) {
+    if (!abitset_Allocate(&sender->allocations, &index)) {
+        return NULL;
+    }
+    size_t capacity;
+    uint8_t *data = _pnet_AllocateSlab(&sender->slab, _PNET_HEADER_SIZE + size,
+                                       &capacity);
+    if (data == NULL) {
+        abitset_Set(&sender->allocations, index);
         return NULL;
     }
     _pnet_Message *_message = &sender->buffer[index];
     memset(&_message->message, 0, sizeof(pnet_Message));
-    _message->message.data = mem_FromBuffer(_message->data, KDT_N_BUFFER_SIZE);
+    if (capacity > _PNET_HEADER_SIZE + _PNET_FRAME_SIZE) {
+        capacity = _PNET_HEADER_SIZE + _PNET_FRAME_SIZE;
+    }
+    _message->message.data = mem_FromBuffer(&data[_PNET_HEADER_SIZE],
+                                            capacity - _PNET_HEADER_SIZE);
+    _message->data = data;
     _message->index = index;
     _message->socket = SOCKET_EMPTY;
+    _message->is_response = false;
+    _message->pins_socket = false;
+    _message->credit = SIZE_MAX;
+    _message->is_connecting = false;
     _message->bytes_sent = 0;
-    _message->timeout = tims_Now() + 1.0;
+    _message->attachment = NULL;
+    _message->attachment_size = 0;
+    _message->attachment_release = NULL;
     return _message;
 }
 
-inline
-bool _pnet_PushMessage(_pnet_Sender *sender, _pnet_Message *message) {
-    return cbufz_Push(&sender->queue, message->index);
+/*
+ * Requests are only queued if their receivers hold credits, which they do if
+ * fewer than KDT_N_PEER_CREDITS requests are in flight to them, or to any other
+ * receivers sharing the same credit counter. Credits are returned when their
+ * messages are freed. Responses are never held back, as their receivers are
+ * waiting for them. Messages time out after KDT_N_RETRANSMIT retransmission
+ * timeouts of their receivers, plus the time it would take to send their bytes
+ * at KDT_N_RECEIVE_RATE bytes per second, as receivers would not wait longer.
+ * Messages to TCP receivers are given another KDT_T_CONNECT seconds, as they
+ * may have to wait for connections to be established, and have their clocks
+ * restarted when given sockets, as described in `RestartTimeout()`.
+ */
+err_t _pnet_PushMessage(_pnet_Sender *sender, _pnet_Message *message) {
+    assert(sender != NULL);
+    assert(message != NULL);
+
+    if (!message->is_response && !AcquireCredit(sender, message)) {
+        return ERR_TRY_AGAIN;
+    }
+    message->rto = _pnet_EstimateTimeout(sender, &message->message.receiver);
+    message->timeout = tims_Now() + GetLifetime(message);
+    if (message->message.receiver.transport == PNET_TRANSPORT_TCP) {
+        message->timeout += KDT_T_CONNECT;
+    }
+    if (!PushLane(sender, message)) {
+        ReleaseCredit(sender, message);
+        return ENOMEM;
+    }
+    return ERR_NONE;
+}
+
+/*
+ * The message is copied into a message buffer of `target`, which is then
+ * queued by that sender. The original message is freed only if the copy could
+ * be queued, and is otherwise left in the possession of the caller. Attached
+ * payloads are moved to the copy rather than being copied.
+ */
+err_t _pnet_HandOffMessage(_pnet_Sender *sender, _pnet_Sender *target,
+                           _pnet_Message *message) {
+    assert(sender != NULL);
+    assert(target != NULL);
+    assert(message != NULL);
+
+    const size_t size = mem_Size(&message->message.data);
+    _pnet_Message *copy = _pnet_AllocateMessage(target, size);
+    if (copy == NULL) {
+        return ERR_TRY_AGAIN;
+    }
+    copy->message.receiver = message->message.receiver;
+    copy->message.nonce = message->message.nonce;
+    copy->message.tag = message->message.tag;
+    copy->message.priority = message->message.priority;
+    mem_Write(&copy->message.data, message->message.data.begin, size);
+    copy->attachment = message->attachment;
+    copy->attachment_size = message->attachment_size;
+
+    const err_t err = _pnet_PushMessage(target, copy);
+    if (err != ERR_NONE) {
+        copy->attachment = NULL;
+        copy->attachment_size = 0;
+        FreeMessage(target, copy);
+        return err;
+    }
+    copy->attachment_release = message->attachment_release;
+    copy->attachment_context = message->attachment_context;
+    message->attachment_release = NULL;
+    FreeMessage(sender, message);
+    return ERR_NONE;
+}
+
+/*
+ * Replies may be received by any shard, which is why only datagrams listed as
+ * not yet acknowledged are searched, under a lock of their own. Acknowledged
+ * messages are queued once, and freed during the next send round.
+ */
+void _pnet_AcknowledgeMessage(_pnet_Sender *sender, const kint_t *nonce,
+                              const pnet_Host *host) {
+    assert(sender != NULL);
+    assert(nonce != NULL);
+    assert(host != NULL);
+
+    mtx_Lock(&sender->unacknowledged_lock);
+    size_t index = *GetUnacknowledged(sender, nonce);
+    while (index != SIZE_MAX) {
+        _pnet_Message *message = &sender->buffer[index];
+        if (kint_EQU(&message->message.nonce, nonce) &&
+            pnet_IsHostEqual(&message->message.receiver, host) &&
+            !atomic_exchange(&message->acknowledged, true)) {
+            mpmcz_Push(&sender->acknowledged, index);
+        }
+        index = message->unacknowledged_next;
+    }
+    mtx_Unlock(&sender->unacknowledged_lock);
 }
 
+/*
+ * Replies may be received by any shard, which is why the round-trip times of
+ * each sender are guarded by a lock of their own, rather than by the critical
+ * region of its shard.
+ */
+void _pnet_MeasureRoundTrip(_pnet_Sender *sender, const kint_t *nonce,
+                            const pnet_Host *host) {
+    assert(sender != NULL);
+    assert(nonce != NULL);
+    assert(host != NULL);
+
+    mtx_Lock(&sender->rtt_lock);
+    _pnet_MeasureRtt(&sender->rtt, nonce, host, tims_Now());
+    mtx_Unlock(&sender->rtt_lock);
+}
+
+bool _pnet_GetRoundTrip(_pnet_Sender *sender, const pnet_Host *host, tims_t *srtt,
+                        tims_t *rttvar) {
+    assert(sender != NULL);
+
+    mtx_Lock(&sender->rtt_lock);
+    const bool is_found = _pnet_GetRtt(&sender->rtt, host, srtt, rttvar);
+    mtx_Unlock(&sender->rtt_lock);
+    return is_found;
+}
+
+tims_t _pnet_EstimateTimeout(_pnet_Sender *sender, const pnet_Host *host) {
+    assert(sender != NULL);
+
+    mtx_Lock(&sender->rtt_lock);
+    const tims_t rto = _pnet_GetRto(&sender->rtt, host);
+    mtx_Unlock(&sender->rtt_lock);
+    return rto;
+}
+
+static
+err_t SendDatagrams(_pnet_Sender *sender, _pnet_Server *server);
+
+static
+void ExpireDatagrams(_Context *context);
+
+static
+void SendDatagramBatch(_Context *context, _pnet_Socket *socket,
+                       _pnet_Message **messages, _pnet_Datagram *datagrams,
+                       size_t count);
+
+static
+void OnDatagramSent(_Context *context, _pnet_Message *message);
+
+static
+void WriteHeader(_pnet_Message *message);
+
+static
+size_t GetPayloadSize(_pnet_Message *message);
+
+static
+void WriteFrameHeader(_pnet_Message *message, size_t frame);
+
+static
+void RestartTimeout(_Context *context, _pnet_Message *message, tims_t delay);
+
+static
+void AddUnacknowledged(_pnet_Sender *sender, _pnet_Message *message);
+
+static
+void RemoveUnacknowledged(_pnet_Sender *sender, _pnet_Message *message);
+
+static
+void AddProbe(_Context *context, _pnet_Message *message);
+
 static
-void SendOne(_pnet_Sender *sender, _pnet_Server *server, _pnet_Message *message);
+bool IsConnectedTo(_pnet_Server *server, _pnet_Socket *socket, const pnet_Host *host);
 
+static
+bool IsBatchFull(const _Context *context);
+
+static
+err_t Flush(_Context *context);
+
+static
+_Gather *FindGather(_Context *context, const _pnet_Socket *socket);
+
+static
+bool JoinGather(_Context *context, _pnet_Message *message);
+
+static
+void AddToGather(_Gather *gather, _pnet_Message *message);
+
+static
+void SendOne(_Context *context, _pnet_Message *message);
+
+static
+void GetBuffers(_pnet_Message *message, _pnet_Buffer *out);
+
+static
+bool IsLastFrame(_pnet_Message *message);
+
+static
+void SendIfConnected(_Context *context, _pnet_Message *message);
+
+static
+void OnBatchOp(void *context, _pnet_BatchOp *op);
+
+static
+void OnGatherSent(_Context *context, _Gather *gather, _pnet_BatchOp *op);
+
+static
+void RequeueOrTimeout(_Context *context, _pnet_Message *message);
+
+static
+void Wait(_Context *context, _pnet_Message *message);
+
+static
+void Unwait(_Context *context, _pnet_Message *message);
+
+static
+void OnSocketWritable(void *context, _pnet_Socket *socket);
+
+static
+void ExpireWaiting(_Context *context);
+
+static
+void ClearWriter(_Context *context, _pnet_Message *message);
+
+static
+void RequeueGathered(_Context *context, _pnet_Message *message);
+
+static
+void HandleError(_Context *context, _pnet_Message *message, err_t err);
+
+#define _TRY_FLUSH() do {                      \
+    if ((err = Flush(&context)) != ERR_NONE) { \
+        return err;                            \
+    }                                          \
+} while (0)
+
+/*
+ * Sends are carried out in two rounds. Before the first, messages waiting for
+ * sockets that have become writable are queued again, as described in
+ * `Wait()`. During the first, each queued message either has an idle pooled
+ * socket assigned and sent via, has its socket connected or, if its socket is
+ * writable, more of its bytes sent. During the second, sockets are polled
+ * again and the messages of any newly connected sockets are sent, as connects
+ * to nearby hosts typically complete almost at once. Operations are batched,
+ * as described in `batch.h`. Messages sent via the same socket during the same
+ * round are gathered and sent by a single write, as described in `SendOne()`.
+ */
 err_t _pnet_SendOutgoing(_pnet_Sender *sender, _pnet_Server *server) {
     assert(sender != NULL);
     assert(server != NULL);
 
+    sender->requeued_count = 0;
+
+    if (server->interface->transport == PNET_TRANSPORT_UDP) {
+        return SendDatagrams(sender, server);
+    }
+
     err_t err;
 
+    _pnet_ExpireSockets(server);
+
     _pnet_SocketSet socket_set;
     if ((err = _pnet_PollWritableSockets(server, &socket_set)) != ERR_NONE) {
         return err;
     }
 
+    _Context context = {
+        .sender = sender,
+        .server = server,
+        .socket_set = &socket_set,
+        .now = tims_Now(),
+        .connected_count = 0,
+        .gather_count = 0,
+    };
+
+    ExpireWaiting(&context);
+    _pnet_ForEachWritableSocket(&socket_set, &context, OnSocketWritable);
+
     for (size_t i = KDT_N_BUFFER_O_COUNT; i-- != 0;) {
         size_t index;
-        if (!cbufz_Pop(&sender->queue, &index)) {
+        if (!PopLane(sender, &index)) {
             break;
         }
         _pnet_Message *message = &sender->buffer[index];
 
+        // The request connection of a response may have been closed, and its
+        // socket descriptor reused, before the response was first popped. Its
+        // socket is then pinned, which keeps it open until the response is
+        // freed.
+        if (message->is_response && !message->pins_socket) {
+            if (IsConnectedTo(server, &message->socket, &message->message.receiver) &&
+                _pnet_PinSocket(server, &message->socket)) {
+                message->pins_socket = true;
+            }
+            else {
+                message->socket = SOCKET_EMPTY;
+                message->is_response = false;
+            }
+        }
+
         if (_pnet_IsSocketEmpty(&message->socket)) {
-            _pnet_Socket socket;
-            err = _pnet_Connect(server, &message->message.receiver, &socket);
-            if (err != ERR_NONE) {
-                goto handle_error;
+            if (JoinGather(&context, message)) {
+                continue;
             }
-            message->socket = socket;
-        }
-        else if (!_pnet_IsSocketReady(&socket_set, &message->socket)) {
-            if (tims_Now() < message->timeout) {
-                cbufz_Push(&sender->queue, message->index);
-            } else {
-                err = ERR_TIMEOUT;
-                goto handle_error;
+            err = _pnet_TakeSocket(server, &message->message.receiver,
+                                   &message->socket);
+            switch (err) {
+            case ERR_NONE:
+                RestartTimeout(&context, message, 0.0);
+                SendOne(&context, message);
+                break;
+
+            case ERR_NOT_FOUND:
+                err = _pnet_Connect(server, &message->message.receiver, message,
+                                    &message->socket);
+                if (err != ERR_NONE) {
+                    HandleError(&context, message, err);
+                    continue;
+                }
+                RestartTimeout(&context, message, KDT_T_CONNECT);
+                break;
+
+            case ERR_TRY_AGAIN:
+                // Too many connections to receiver are already in use.
+                RequeueOrTimeout(&context, message);
+                continue;
+
+            default:
+                HandleError(&context, message, err);
+                continue;
             }
+        }
+        else if (message->is_connecting) {
+            SendIfConnected(&context, message);
+        }
+        else if (_pnet_IsSocketReady(&socket_set, &message->socket)) {
+            SendOne(&context, message);
+        }
+        else {
+            Wait(&context, message);
             continue;
         }
-        SendOne(sender, server, message);
-        continue;
+        if (IsBatchFull(&context)) {
+            _TRY_FLUSH();
+        }
+    }
+    _TRY_FLUSH();
 
-handle_error:
-        _pnet_HandleError(server, &(_pnet_Error) {
-            .nonce = &message->message.nonce,
-            .host = &message->message.receiver,
-            .tag = message->message.tag,
-            .err = err,
-        });
+    if (context.connected_count == 0) {
+        return ERR_NONE;
     }
+    if ((err = _pnet_PollWritableSockets(server, &socket_set)) != ERR_NONE) {
+        return err;
+    }
+    for (size_t i = 0; i < context.connected_count; ++i) {
+        _pnet_Message *message = &sender->buffer[context.connected[i]];
+        if (message->is_connecting) {
+            SendIfConnected(&context, message);
+        }
+        else {
+            SendOne(&context, message);
+        }
+        if (IsBatchFull(&context)) {
+            _TRY_FLUSH();
+        }
+    }
+    context.connected_count = 0;
+    _TRY_FLUSH();
 
     return ERR_NONE;
 }
 
-#define _TRY(ERR) do {               \
-    if ((err = (ERR)) != ERR_NONE) { \
-        goto error;                  \
-    }                                \
-} while (0)
+#undef _TRY_FLUSH
 
-static inline
-void SendOne(_pnet_Sender *sender, _pnet_Server *server, _pnet_Message *message) {
-    size_t bytes_remaining;
-    size_t n;
-    err_t err;
+/*
+ * Datagrams are sent via the interface socket in batches of up to KDT_N_BATCH.
+ * IPv4 receivers are reached via IPv4-mapped addresses if the interface socket
+ * is a dual-stack IPv6 socket, while IPv6 receivers cannot be reached at all
+ * via IPv4 interface sockets.
+ * Requests are sent again every retransmission timeout of their receivers
+ * until acknowledged by any datagram with the same nonce arriving from their
+ * receivers, or until timing out. Only requests sent once are used to measure
+ * round-trip times. Responses are sent only once. Sent requests are kept out of the
+ * sender queue, and are only queued again when their timers expire.
+ */
+static
+err_t SendDatagrams(_pnet_Sender *sender, _pnet_Server *server) {
+    _pnet_Socket socket;
+    _pnet_GetInterfaceSocket(server, &socket);
 
-    // Send message header, if haven't already.
-    if (message->bytes_sent < _PNET_HEADER_SIZE) {
-        uint8_t buffer[_PNET_HEADER_SIZE];
-        mem_t mem = mem_FromBuffer(buffer, _PNET_HEADER_SIZE);
-        mem_Write(&mem, message->message.nonce.as_u8s, sizeof(kint_t));
-        mem_WriteU16BE(&mem, message->message.tag);
-        mem_WriteU16BE(&mem, (uint16_t) mem_Size(&message->message.data));
+    _Context context = {
+        .sender = sender,
+        .server = server,
+        .socket_set = NULL,
+        .now = tims_Now(),
+        .connected_count = 0,
+        .gather_count = 0,
+    };
 
-        n = _PNET_HEADER_SIZE - message->bytes_sent;
-        _TRY(_pnet_Send(&message->socket, &n, &buffer[message->bytes_sent]));
-        message->bytes_sent += n;
+    ExpireDatagrams(&context);
 
-        if (n < _PNET_HEADER_SIZE) {
-            goto requeue;
+    _pnet_Message *messages[KDT_N_BATCH];
+    _pnet_Datagram datagrams[KDT_N_BATCH];
+    size_t count = 0;
+
+    for (size_t i = KDT_N_BUFFER_O_COUNT; i-- != 0;) {
+        size_t index;
+        if (!PopLane(sender, &index)) {
+            break;
+        }
+        _pnet_Message *message = &sender->buffer[index];
+        if (message->retransmit != 0) {
+            if (atomic_load(&message->acknowledged)) {
+                FreeMessage(sender, message);
+                continue;
+            }
+        }
+        else {
+            WriteHeader(message);
+        }
+        pnet_Host host;
+        if (!_pnet_MapHost(&message->message.receiver, server->interface->internet, &host)) {
+            HandleError(&context, message, ERR_NOT_COMPATIBLE);
+            continue;
+        }
+        messages[count] = message;
+        datagrams[count] = (_pnet_Datagram) {
+            .host = host,
+            .data = message->data,
+            .size = _PNET_HEADER_SIZE + mem_Size(&message->message.data),
+            .tail = message->attachment,
+            .tail_size = message->attachment_size,
+        };
+        if (++count == KDT_N_BATCH) {
+            SendDatagramBatch(&context, &socket, messages, datagrams, count);
+            count = 0;
         }
     }
+    SendDatagramBatch(&context, &socket, messages, datagrams, count);
 
-    // Send more of or all of message body.
-    {
-        bytes_remaining = _PNET_HEADER_SIZE + mem_Size(&message->message.data) -
-                          message->bytes_sent;
+    return ERR_NONE;
+}
 
-        n = bytes_remaining;
-        _TRY(_pnet_Send(&message->socket, &n,
-                        &message->data[message->bytes_sent - _PNET_HEADER_SIZE]));
-        message->bytes_sent += n;
+/*
+ * Acknowledged datagrams are freed, while datagrams of which timers expired are
+ * either timed out or queued for being sent again.
+ */
+static
+void ExpireDatagrams(_Context *context) {
+    _pnet_Sender *sender = context->sender;
 
-        if (message->bytes_sent < bytes_remaining) {
-            goto requeue;
+    for (size_t i = KDT_N_BUFFER_O_COUNT; i-- != 0;) {
+        size_t index;
+        if (!mpmcz_Pop(&sender->acknowledged, &index)) {
+            break;
+        }
+        // The message may have been freed, and its buffer reused, since.
+        _pnet_Message *message = &sender->buffer[index];
+        if (wheel_IsArmed(&message->timer) &&
+            atomic_load(&message->acknowledged)) {
+            FreeMessage(sender, message);
         }
     }
 
-disconnect:
-    bitset_Set(&sender->allocations, message->index);
-    _pnet_CloseSocket(server, &message->socket);
-    return;
+    wheel_Timer *timer;
+    while ((timer = wheel_Pop(&sender->wheel, context->now)) != NULL) {
+        _pnet_Message *message = WHEEL_CONTAINER(timer, _pnet_Message, timer);
+        if (atomic_load(&message->acknowledged)) {
+            FreeMessage(sender, message);
+        }
+        else if (context->now >= message->timeout) {
+            HandleError(context, message, ERR_TIMEOUT);
+        }
+        else {
+            PushLane(sender, message);
+        }
+    }
+}
 
-requeue:
-    cbufz_Push(&sender->queue, message->index);
-    return;
+static
+void SendDatagramBatch(_Context *context, _pnet_Socket *socket,
+                       _pnet_Message **messages, _pnet_Datagram *datagrams,
+                       size_t count) {
+    size_t offset = 0;
+    while (offset < count) {
+        size_t sent;
+        err_t err = _pnet_SendDatagrams(socket, &datagrams[offset],
+                                        count - offset, &sent);
+        if (err == EAGAIN || err == EWOULDBLOCK) {
+            // Socket send buffer is full. Try again during a later poll.
+            for (; offset < count; ++offset) {
+                RequeueOrTimeout(context, messages[offset]);
+            }
+            return;
+        }
+        if (err != ERR_NONE) {
+            HandleError(context, messages[offset++], err);
+            continue;
+        }
+        for (const size_t end = offset + sent; offset < end; ++offset) {
+            OnDatagramSent(context, messages[offset]);
+        }
+    }
+}
+
+static
+void OnDatagramSent(_Context *context, _pnet_Message *message) {
+    if (message->is_response) {
+        FreeMessage(context->sender, message);
+        return;
+    }
+    if (message->retransmit == 0) {
+        atomic_store(&message->acknowledged, false);
+        AddProbe(context, message);
+        AddUnacknowledged(context->sender, message);
+    }
+    else {
+        mtx_Lock(&context->sender->rtt_lock);
+        _pnet_RemoveRttProbe(&context->sender->rtt, &message->message.nonce);
+        mtx_Unlock(&context->sender->rtt_lock);
+    }
+    message->retransmit = context->now + message->rto;
+    wheel_Arm(&context->sender->wheel, &message->timer,
+              message->retransmit < message->timeout
+              ? message->retransmit
+              : message->timeout);
+}
+
+static
+void AddUnacknowledged(_pnet_Sender *sender, _pnet_Message *message) {
+    mtx_Lock(&sender->unacknowledged_lock);
+    size_t *head = GetUnacknowledged(sender, &message->message.nonce);
+    message->unacknowledged_next = *head;
+    *head = message->index;
+    mtx_Unlock(&sender->unacknowledged_lock);
+}
+
+static
+void RemoveUnacknowledged(_pnet_Sender *sender, _pnet_Message *message) {
+    mtx_Lock(&sender->unacknowledged_lock);
+    size_t *link = GetUnacknowledged(sender, &message->message.nonce);
+    while (*link != SIZE_MAX) {
+        if (*link == message->index) {
+            *link = message->unacknowledged_next;
+            break;
+        }
+        link = &sender->buffer[*link].unacknowledged_next;
+    }
+    mtx_Unlock(&sender->unacknowledged_lock);
+}
+
+/*
+ * Nonces are expected to be random, which is why their leading bytes are used
+ * as index without further hashing.
+ */
+static
+size_t *GetUnacknowledged(_pnet_Sender *sender, const kint_t *nonce) {
+    const uint32_t index = (uint32_t) nonce->as_u8s[0] << 24 |
+                           (uint32_t) nonce->as_u8s[1] << 16 |
+                           (uint32_t) nonce->as_u8s[2] << 8 |
+                           (uint32_t) nonce->as_u8s[3];
+    return &sender->unacknowledged[index % KDT_N_BUFFER_O_COUNT];
+}
+
+/*
+ * Requests are only timed from when they were first sent in full, as replies
+ * cannot arrive any earlier.
+ */
+static
+void AddProbe(_Context *context, _pnet_Message *message) {
+    mtx_Lock(&context->sender->rtt_lock);
+    _pnet_AddRttProbe(&context->sender->rtt, &message->message.nonce,
+                      &message->message.receiver, context->now);
+    mtx_Unlock(&context->sender->rtt_lock);
+}
+
+/*
+ * Messages given sockets may have waited in queue for connections to become
+ * available, which is why their lifetimes are restarted from when they can
+ * first be sent, `delay` seconds from now. Timeouts are never brought forward.
+ */
+static
+void RestartTimeout(_Context *context, _pnet_Message *message, tims_t delay) {
+    const tims_t timeout = context->now + delay + GetLifetime(message);
+    if (message->timeout < timeout) {
+        message->timeout = timeout;
+    }
+}
+
+static
+bool IsConnectedTo(_pnet_Server *server, _pnet_Socket *socket, const pnet_Host *host) {
+    pnet_Host peer;
+    return _pnet_ResolveHost(server, socket, &peer) == ERR_NONE &&
+           pnet_IsHostEqual(&peer, host);
+}
+
+/*
+ * Every send is counted as a batch operation, whether or not it has been
+ * submitted to the batch yet.
+ */
+static
+bool IsBatchFull(const _Context *context) {
+    return context->server->batch.count + context->gather_count >= KDT_N_BATCH;
+}
+
+/*
+ * Each gather is submitted as a single vectored send before the batch is
+ * flushed.
+ */
+static
+err_t Flush(_Context *context) {
+    _pnet_Batch *batch = &context->server->batch;
+
+    for (size_t i = 0; i < context->gather_count; ++i) {
+        _Gather *gather = &context->gathers[i];
+        _pnet_Buffer buffers[_PNET_SEND_BUFFERS];
+        for (size_t j = 0; j < gather->count; ++j) {
+            GetBuffers(gather->messages[j], &buffers[2 * j]);
+            gather->sizes[j] = buffers[2 * j].size + buffers[2 * j + 1].size;
+        }
+        _pnet_BatchSend(batch, &gather->socket, buffers, 2 * gather->count, gather);
+    }
+    const err_t err = _pnet_FlushBatch(batch, context, OnBatchOp);
+    context->gather_count = 0;
+    return err;
+}
+
+static
+_Gather *FindGather(_Context *context, const _pnet_Socket *socket) {
+    for (size_t i = 0; i < context->gather_count; ++i) {
+        if (_pnet_IsSocketEqual(&context->gathers[i].socket, socket)) {
+            return &context->gathers[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Requests without sockets are sent via the socket of any other request being
+ * sent to the same receiver during the same round, if possible, as they would
+ * otherwise have to take sockets of their own.
+ */
+static
+bool JoinGather(_Context *context, _pnet_Message *message) {
+    if (message->is_response) {
+        return false;
+    }
+    for (size_t i = 0; i < context->gather_count; ++i) {
+        _Gather *gather = &context->gathers[i];
+        const _pnet_Message *first = gather->messages[0];
+        if (gather->is_open && !first->is_response &&
+            pnet_IsHostEqual(&first->message.receiver, &message->message.receiver)) {
+            message->socket = gather->socket;
+            AddToGather(gather, message);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * A message with more frames to send than its current one must be the last of
+ * its gather, as no other message may be sent via its socket until all of its
+ * frames have been.
+ */
+static
+void AddToGather(_Gather *gather, _pnet_Message *message) {
+    gather->messages[gather->count++] = message;
+    if (gather->count == KDT_N_GATHER || !IsLastFrame(message)) {
+        gather->is_open = false;
+    }
+}
+
+/*
+ * The message is gathered with any other messages sent via the same socket
+ * during the same round, which are then sent by a single write when the batch
+ * is next flushed. A message already partially sent is the writer of its
+ * socket, and must be the first of its gather, as the rest of its bytes must
+ * be sent before those of any other message. Other messages therefore wait
+ * for as long as their sockets have writers. This may only happen to
+ * responses, as the sockets of requests are not shared by other requests
+ * between rounds.
+ */
+static
+void SendOne(_Context *context, _pnet_Message *message) {
+    const size_t writer = _pnet_GetSocketWriter(context->server, &message->socket);
+    if (writer != SIZE_MAX && writer != message->index) {
+        Wait(context, message);
+        return;
+    }
+    _Gather *gather = FindGather(context, &message->socket);
+    if (gather == NULL) {
+        gather = &context->gathers[context->gather_count++];
+        gather->socket = message->socket;
+        gather->is_open = true;
+        gather->count = 0;
+    }
+    else if (!gather->is_open || message->bytes_sent != 0) {
+        RequeueOrTimeout(context, message);
+        return;
+    }
+    AddToGather(gather, message);
+}
+
+/*
+ * Any attached payload is sent directly from the memory it was attached from,
+ * together with whatever remains of the message buffer. Payloads larger than
+ * _PNET_FRAME_SIZE are split into frames, only one of which is sent at a time,
+ * the first frame consisting of the message buffer and the beginning of the
+ * attachment, and every later frame of a header written to `frame_header` and
+ * a part of the attachment. As all frames but the last carry _PNET_FRAME_SIZE
+ * payload bytes, frame `i` begins at byte `i * (_PNET_HEADER_SIZE +
+ * _PNET_FRAME_SIZE)` of the sent byte stream. Exactly two buffers are written
+ * to `out`, either or both of which may be empty.
+ */
+static
+void GetBuffers(_pnet_Message *message, _pnet_Buffer *out) {
+    const size_t buffer_size = mem_Size(&message->message.data);
+    const size_t payload_size = GetPayloadSize(message);
+    const size_t stride = _PNET_HEADER_SIZE + _PNET_FRAME_SIZE;
+    const size_t frame = message->bytes_sent / stride;
+    const size_t frame_sent = message->bytes_sent % stride;
+
+    // Offset within payload of first byte of frame, and of first byte after it.
+    const size_t begin = frame * _PNET_FRAME_SIZE;
+    const size_t end = payload_size - begin > _PNET_FRAME_SIZE
+        ? begin + _PNET_FRAME_SIZE
+        : payload_size;
+
+    if (frame == 0) {
+        const size_t size = _PNET_HEADER_SIZE + buffer_size;
+
+        // Write message header, if haven't already.
+        if (message->bytes_sent == 0) {
+            WriteHeader(message);
+        }
+
+        // Send more of or all of message header and body.
+        if (message->bytes_sent < size) {
+            out[0] = (_pnet_Buffer) {
+                .data = &message->data[message->bytes_sent],
+                .size = size - message->bytes_sent,
+            };
+            out[1] = (_pnet_Buffer) {
+                .data = message->attachment,
+                .size = end - buffer_size,
+            };
+        }
+        else {
+            out[0] = (_pnet_Buffer) {.data = NULL, .size = 0};
+            out[1] = (_pnet_Buffer) {
+                .data = &message->attachment[message->bytes_sent - size],
+                .size = size + (end - buffer_size) - message->bytes_sent,
+            };
+        }
+        return;
+    }
+
+    const uint8_t *attachment = &message->attachment[begin - buffer_size];
+    if (frame_sent == 0) {
+        WriteFrameHeader(message, frame);
+    }
+    if (frame_sent < _PNET_HEADER_SIZE) {
+        out[0] = (_pnet_Buffer) {
+            .data = &message->frame_header[frame_sent],
+            .size = _PNET_HEADER_SIZE - frame_sent,
+        };
+        out[1] = (_pnet_Buffer) {.data = attachment, .size = end - begin};
+    }
+    else {
+        out[0] = (_pnet_Buffer) {.data = NULL, .size = 0};
+        out[1] = (_pnet_Buffer) {
+            .data = &attachment[frame_sent - _PNET_HEADER_SIZE],
+            .size = _PNET_HEADER_SIZE + (end - begin) - frame_sent,
+        };
+    }
+}
+
+static
+bool IsLastFrame(_pnet_Message *message) {
+    const size_t stride = _PNET_HEADER_SIZE + _PNET_FRAME_SIZE;
+    return (message->bytes_sent / stride + 1) * stride >= GetWireSize(message);
+}
+
+/*
+ * Sockets being connected are reported writable when their connection attempts
+ * complete, successfully or not. Attempts not completing within KDT_T_CONNECT
+ * seconds are abandoned, as unreachable hosts may otherwise hold up messages
+ * until they time out.
+ */
+static
+void SendIfConnected(_Context *context, _pnet_Message *message) {
+    if (!_pnet_IsSocketReady(context->socket_set, &message->socket)) {
+        if (context->now >= message->connect_timeout) {
+            HandleError(context, message, ETIMEDOUT);
+            return;
+        }
+        Wait(context, message);
+        return;
+    }
+    err_t err = _pnet_GetSocketError(&message->socket);
+    if (err != ERR_NONE) {
+        HandleError(context, message, err);
+        return;
+    }
+    message->is_connecting = false;
+    SendOne(context, message);
+}
+
+static
+void OnBatchOp(void *context, _pnet_BatchOp *op) {
+    _Context *_context = context;
+    _pnet_Message *message = op->context;
+
+    switch (op->type) {
+    case _PNET_BATCH_CONNECT:
+        if (op->err == EINPROGRESS) {
+            message->is_connecting = true;
+            message->connect_timeout = _context->now + KDT_T_CONNECT;
+        }
+        else if (op->err != ERR_NONE) {
+            HandleError(_context, message, op->err);
+            return;
+        }
+        _context->connected[_context->connected_count++] = message->index;
+        return;
+
+    case _PNET_BATCH_SEND:
+        OnGatherSent(_context, op->context, op);
+        return;
+
+    default:
+        assert(false);
+        return;
+    }
+}
+
+/*
+ * The bytes sent are attributed to the gathered messages in order, which means
+ * that at most one message is partially sent, every message before it is sent
+ * in full, and no message after it is sent at all. Requests in the same gather
+ * share the socket of the first, which is released only when no message of
+ * the gather is left holding it. As each send carries at most one frame of
+ * each message, only a short send means that the socket send buffer is full.
+ */
+static
+void OnGatherSent(_Context *context, _Gather *gather, _pnet_BatchOp *op) {
+    _pnet_Message *first = gather->messages[0];
+    const bool is_response = first->is_response;
+
+    if (op->err == EAGAIN || op->err == EWOULDBLOCK || op->err == EINPROGRESS) {
+        if (op->err == EINPROGRESS) {
+            // No TCP Fast Open cookie was available, which means that nothing
+            // was sent and that a regular handshake is now in progress.
+            first->is_connecting = true;
+            first->connect_timeout = context->now + KDT_T_CONNECT;
+        }
+        // Wait for socket to become writable.
+        _pnet_ClearSocket(context->socket_set, &gather->socket);
+        for (size_t i = 1; i < gather->count; ++i) {
+            RequeueGathered(context, gather->messages[i]);
+        }
+        Wait(context, first);
+        return;
+    }
+    if (op->err != ERR_NONE) {
+        for (size_t i = 1; i < gather->count; ++i) {
+            if (is_response) {
+                HandleError(context, gather->messages[i], op->err);
+            }
+            else {
+                RequeueGathered(context, gather->messages[i]);
+            }
+        }
+        HandleError(context, first, op->err);
+        return;
+    }
+
+    size_t remaining = op->size;
+    bool is_held = false;
+    for (size_t i = 0; i < gather->count; ++i) {
+        _pnet_Message *message = gather->messages[i];
+        const size_t size = gather->sizes[i] < remaining
+            ? gather->sizes[i]
+            : remaining;
+        remaining -= size;
+
+        if (size == 0 && i > 0) {
+            RequeueGathered(context, message);
+            continue;
+        }
+        message->bytes_sent += size;
+        if (is_response) {
+            _pnet_TouchSocket(context->server, &message->socket, 0, size);
+        }
+        if (message->bytes_sent < GetWireSize(message)) {
+            if (message->bytes_sent != 0) {
+                _pnet_SetSocketWriter(context->server, &message->socket, message->index);
+            }
+            is_held = true;
+            if (size < gather->sizes[i]) {
+                _pnet_ClearSocket(context->socket_set, &message->socket);
+                Wait(context, message);
+            }
+            else {
+                RequeueOrTimeout(context, message);
+            }
+            continue;
+        }
+        ClearWriter(context, message);
+        if (is_response) {
+            _pnet_UnpinSocket(context->server, &message->socket);
+        }
+        else {
+            AddProbe(context, message);
+        }
+        FreeMessage(context->sender, message);
+    }
+
+    // Only request sockets are taken from the connection pool.
+    if (!is_response && !is_held) {
+        _pnet_ReleaseSocket(context->server, &gather->socket);
+    }
+}
 
-error:
-    if (err == EAGAIN && tims_Now() < message->timeout) {
-        goto requeue;
+static
+void RequeueOrTimeout(_Context *context, _pnet_Message *message) {
+    if (context->now >= message->timeout) {
+        HandleError(context, message, ERR_TIMEOUT);
+        return;
+    }
+    PushLane(context->sender, message);
+    context->sender->requeued_count += 1;
+}
+
+/*
+ * Requests let go of sockets they borrowed from other requests, as those
+ * sockets remain held by the requests they were borrowed from.
+ */
+static
+void RequeueGathered(_Context *context, _pnet_Message *message) {
+    if (!message->is_response) {
+        message->socket = SOCKET_EMPTY;
+    }
+    RequeueOrTimeout(context, message);
+}
+
+/*
+ * Messages that cannot be sent until their sockets become writable, or until
+ * the writers of their sockets are done, are kept out of the sender queue.
+ * They are instead appended to the lists of messages waiting for their
+ * sockets, and are queued again only when their sockets are reported as
+ * writable, when their writers are done, or when their timers expire. Timers
+ * are armed to the connect timeouts of messages being connected, or to their
+ * send timeouts, whichever comes first.
+ */
+static
+void Wait(_Context *context, _pnet_Message *message) {
+    if (context->now >= message->timeout) {
+        HandleError(context, message, ERR_TIMEOUT);
+        return;
     }
-    _pnet_HandleError(server, &(_pnet_Error) {
+    _pnet_Server *server = context->server;
+    message->waiting_next = SIZE_MAX;
+    size_t index = _pnet_GetSocketWaiting(server, &message->socket);
+    if (index == SIZE_MAX) {
+        _pnet_SetSocketWaiting(server, &message->socket, message->index);
+    }
+    else {
+        while (context->sender->buffer[index].waiting_next != SIZE_MAX) {
+            index = context->sender->buffer[index].waiting_next;
+        }
+        context->sender->buffer[index].waiting_next = message->index;
+    }
+    wheel_Arm(&context->sender->wheel, &message->timer,
+              message->is_connecting && message->connect_timeout < message->timeout
+              ? message->connect_timeout
+              : message->timeout);
+}
+
+static
+void Unwait(_Context *context, _pnet_Message *message) {
+    _pnet_Server *server = context->server;
+    size_t index = _pnet_GetSocketWaiting(server, &message->socket);
+    if (index == message->index) {
+        _pnet_SetSocketWaiting(server, &message->socket, message->waiting_next);
+    }
+    else {
+        while (index != SIZE_MAX) {
+            _pnet_Message *previous = &context->sender->buffer[index];
+            if (previous->waiting_next == message->index) {
+                previous->waiting_next = message->waiting_next;
+                break;
+            }
+            index = previous->waiting_next;
+        }
+    }
+    wheel_Cancel(&context->sender->wheel, &message->timer);
+}
+
+/*
+ * Waiting messages are queued again in the order they started waiting.
+ */
+static
+void OnSocketWritable(void *context, _pnet_Socket *socket) {
+    _Context *_context = context;
+    _pnet_Server *server = _context->server;
+
+    size_t index = _pnet_GetSocketWaiting(server, socket);
+    _pnet_SetSocketWaiting(server, socket, SIZE_MAX);
+    while (index != SIZE_MAX) {
+        _pnet_Message *message = &_context->sender->buffer[index];
+        index = message->waiting_next;
+        wheel_Cancel(&_context->sender->wheel, &message->timer);
+        PushLane(_context->sender, message);
+    }
+}
+
+/*
+ * Timers of waiting messages only expire when their connect or send timeouts
+ * do, unless fired early by the coarseness of the wheel, in which case the
+ * messages are queued again.
+ */
+static
+void ExpireWaiting(_Context *context) {
+    wheel_Timer *timer;
+    while ((timer = wheel_Pop(&context->sender->wheel, context->now)) != NULL) {
+        _pnet_Message *message = WHEEL_CONTAINER(timer, _pnet_Message, timer);
+        Unwait(context, message);
+        if (message->is_connecting && context->now >= message->connect_timeout) {
+            HandleError(context, message, ETIMEDOUT);
+        }
+        else if (context->now >= message->timeout) {
+            HandleError(context, message, ERR_TIMEOUT);
+        }
+        else {
+            PushLane(context->sender, message);
+        }
+    }
+}
+
+/*
+ * Messages waiting for the writer of their socket to be done are queued again
+ * once it is, as their socket may already be writable.
+ */
+static
+void ClearWriter(_Context *context, _pnet_Message *message) {
+    if (_pnet_GetSocketWriter(context->server, &message->socket) == message->index) {
+        _pnet_SetSocketWriter(context->server, &message->socket, SIZE_MAX);
+        OnSocketWritable(context, &message->socket);
+    }
+}
+
+static
+void HandleError(_Context *context, _pnet_Message *message, err_t err) {
+    _pnet_HandleError(context->server, &(_pnet_Error) {
         .nonce = &message->message.nonce,
         .host = &message->message.receiver,
         .tag = message->message.tag,
         .err = err,
     });
-    goto disconnect;
+    if (_pnet_IsSocketEmpty(&message->socket)) {
+        FreeMessage(context->sender, message);
+        return;
+    }
+    ClearWriter(context, message);
+
+    // Responses failing after being partially sent leave their connections
+    // unusable, as no other message can follow them.
+    if (!message->is_response || message->bytes_sent != 0) {
+        _pnet_CloseSocket(context->server, &message->socket);
+    }
+    if (!message->is_response || message->pins_socket) {
+        _pnet_UnpinSocket(context->server, &message->socket);
+    }
+    FreeMessage(context->sender, message);
+}
+
+static
+void WriteHeader(_pnet_Message *message) {
+    const size_t payload_size = GetPayloadSize(message);
+
+    mem_t mem = mem_FromBuffer(message->data, _PNET_HEADER_SIZE);
+    mem_Write(&mem, message->message.nonce.as_u8s, sizeof(kint_t));
+    if (payload_size > _PNET_FRAME_SIZE) {
+        mem_WriteU16BE(&mem, (uint16_t) (message->message.tag | _PNET_TAG_MORE));
+        mem_WriteU16BE(&mem, _PNET_FRAME_SIZE);
+    }
+    else {
+        mem_WriteU16BE(&mem, message->message.tag);
+        mem_WriteU16BE(&mem, (uint16_t) payload_size);
+    }
+}
+
+static inline
+size_t GetPayloadSize(_pnet_Message *message) {
+    return mem_Size(&message->message.data) + message->attachment_size;
+}
+
+/*
+ * Every frame is preceded by its own header, and there is always at least one
+ * frame, even if the payload is empty.
+ */
+static
+size_t GetWireSize(_pnet_Message *message) {
+    const size_t payload_size = GetPayloadSize(message);
+    const size_t frame_count = payload_size == 0
+        ? 1
+        : (payload_size + _PNET_FRAME_SIZE - 1) / _PNET_FRAME_SIZE;
+    return frame_count * _PNET_HEADER_SIZE + payload_size;
+}
+
+/*
+ * Time messages are given to be sent once they can be, as described in
+ * `_pnet_PushMessage()`.
+ */
+static
+tims_t GetLifetime(_pnet_Message *message) {
+    return KDT_N_RETRANSMIT * message->rto +
+           (tims_t) GetWireSize(message) / (tims_t) KDT_N_RECEIVE_RATE;
+}
+
+static
+void WriteFrameHeader(_pnet_Message *message, size_t frame) {
+    const size_t rest = GetPayloadSize(message) - frame * _PNET_FRAME_SIZE;
+
+    mem_t mem = mem_FromBuffer(message->frame_header, _PNET_HEADER_SIZE);
+    mem_Write(&mem, message->message.nonce.as_u8s, sizeof(kint_t));
+    if (rest > _PNET_FRAME_SIZE) {
+        mem_WriteU16BE(&mem, (uint16_t) (message->message.tag | _PNET_TAG_MORE));
+        mem_WriteU16BE(&mem, _PNET_FRAME_SIZE);
+    }
+    else {
+        mem_WriteU16BE(&mem, message->message.tag);
+        mem_WriteU16BE(&mem, (uint16_t) rest);
+    }
 }
 
-#undef _TRY
\ No newline at end of file
+static
+bool AcquireCredit(_pnet_Sender *sender, _pnet_Message *message) {
+    const size_t credit = pnet_HashHost(&message->message.receiver) %
+                          KDT_N_PEER_CREDIT_BUCKETS;
+    if (atomic_fetch_add(&sender->credits[credit], 1) >= KDT_N_PEER_CREDITS) {
+        atomic_fetch_sub(&sender->credits[credit], 1);
+        return false;
+    }
+    message->credit = credit;
+    return true;
+}
+
+static
+void ReleaseCredit(_pnet_Sender *sender, _pnet_Message *message) {
+    if (message->credit != SIZE_MAX) {
+        atomic_fetch_sub(&sender->credits[message->credit], 1);
+        message->credit = SIZE_MAX;
+    }
+}
+
+static
+bool PushLane(_pnet_Sender *sender, _pnet_Message *message) {
+    const uint8_t priority = message->message.priority < _PNET_LANE_COUNT
+        ? message->message.priority
+        : PNET_PRIORITY_NORMAL;
+    return mpmcz_Push(&sender->lanes[priority], message->index);
+}
+
+/*
+ * Lanes are drained by weighted round-robin, up to the weight of each lane of
+ * messages being popped from it before the next lane is turned to. Empty lanes
+ * are skipped, which lets any lane use all capacity left over by the others.
+ * The position in the rotation is kept between send rounds, as each round may
+ * pop only a few messages.
+ */
+static
+bool PopLane(_pnet_Sender *sender, size_t *index) {
+    for (size_t i = 0; i <= _PNET_LANE_COUNT; ++i) {
+        if (sender->lane_budget > 0 &&
+            mpmcz_Pop(&sender->lanes[sender->lane], index)) {
+            sender->lane_budget -= 1;
+            return true;
+        }
+        sender->lane = (sender->lane + 1) % _PNET_LANE_COUNT;
+        sender->lane_budget = _LANE_WEIGHTS[sender->lane];
+    }
+    return false;
+}
+
+/*
+ * Any threads waiting for buffers or credits are woken, as either may have
+ * been made available.
+ */
+static
+void FreeMessage(_pnet_Sender *sender, _pnet_Message *message) {
+    if (message->attachment_release != NULL) {
+        message->attachment_release(message->attachment_context);
+        message->attachment_release = NULL;
+    }
+    if (message->retransmit != 0) {
+        RemoveUnacknowledged(sender, message);
+        message->retransmit = 0;
+    }
+    wheel_Cancel(&sender->wheel, &message->timer);
+    ReleaseCredit(sender, message);
+    _pnet_FreeSlab(&sender->slab, message->data);
+    abitset_Set(&sender->allocations, message->index);
+    park_WakeAll(&sender->park);
+}
\ No newline at end of file
@@ -2,12 +2,16 @@
 #define KDT_PNET_INTERNAL_SENDER_H
 
 #include "message.h"
-#include <kdt/bitset.h>
-#include <kdt/cbuf.h>
+#include "rtt.h"
+#include "slab.h"
+#include <kdt/abitset.h>
+#include <kdt/mpmc.h>
+#include <kdt/mtx.h>
+#include <kdt/park.h>
+#include <kdt/wheel.h>
 
-#define _BUFFER_O_COUNT_SIZE_T \
-    ((KDT_N_BUFFER_O_COUNT / (sizeof(size_t) * 8)) + \
-     ((KDT_N_BUFFER_O_COUNT % (sizeof(size_t) * 8)) == 0 ? 0 : 1))
+/// Number of outbound message queues, one per message priority.
+#define _PNET_LANE_COUNT 3
 
 typedef struct _pnet_Sender _pnet_Sender;
 typedef struct _pnet_Server _pnet_Server;
@@ -16,22 +20,72 @@ struct _pnet_Sender {
     /// Message buffer.
     _pnet_Message buffer[KDT_N_BUFFER_O_COUNT];
 
+    /// Message data buffers.
+    _pnet_Slab slab;
+
     /// Bit set for keeping track of message buffer allocations.
-    bitset_t allocations;
+    abitset_t allocations;
+
+    /// Queues with buffer indexes of outgoing messages, indexed by priority.
+    mpmcz_t lanes[_PNET_LANE_COUNT];
+
+    /// Queue from which outgoing messages are being popped.
+    size_t lane;
+
+    /// Number of messages that may yet be popped from `lane` before the next.
+    size_t lane_budget;
+
+    /// Number of messages put back in queue during the last send round.
+    size_t requeued_count;
+
+    /// Timers of sent datagrams not yet acknowledged.
+    wheel_t wheel;
+
+    /// Queue with buffer indexes of acknowledged datagrams.
+    mpmcz_t acknowledged;
 
-    /// Queue with buffer indexes of outgoing messages.
-    cbufz_t queue;
+    /// Lists of sent datagrams not yet acknowledged, in buckets indexed by
+    /// nonce, each being the buffer index of its first datagram or SIZE_MAX.
+    size_t unacknowledged[KDT_N_BUFFER_O_COUNT];
+
+    /// Lock of `unacknowledged`, which is searched by whichever shard receives
+    /// replies.
+    mtx_t unacknowledged_lock;
+
+    /// Number of requests in flight, per bucket of receivers.
+    atomic_uint credits[KDT_N_PEER_CREDIT_BUCKETS];
+
+    /// Threads waiting for message buffers or credits to be freed.
+    park_t park;
+
+    /// Round-trip time estimates of receivers of sent requests.
+    _pnet_Rtt rtt;
+
+    /// Lock of `rtt`, which is updated by whichever shard receives replies.
+    mtx_t rtt_lock;
 
     /// Backing memory for bit set.
-    size_t _allocations[_BUFFER_O_COUNT_SIZE_T];
+    atomic_size_t _allocations[ABITSET_WORDS(KDT_N_BUFFER_O_COUNT)];
+
+    /// Backing memory for queues, each of which must be able to fit all messages.
+    mpmcz_Cell _lanes[_PNET_LANE_COUNT][KDT_N_BUFFER_O_COUNT];
 
-    /// Backing memory for queue.
-    size_t _queue[KDT_N_BUFFER_O_COUNT];
+    /// Backing memory for acknowledgement queue.
+    mpmcz_Cell _acknowledged[KDT_N_BUFFER_O_COUNT];
 };
 
 void _pnet_InitSender(_pnet_Sender *sender);
-_pnet_Message *_pnet_AllocateMessage(_pnet_Sender *sender);
-bool _pnet_PushMessage(_pnet_Sender *sender, _pnet_Message *message);
+_pnet_Message *_pnet_AllocateMessage(_pnet_Sender *sender, size_t size);
+err_t _pnet_PushMessage(_pnet_Sender *sender, _pnet_Message *message);
+err_t _pnet_HandOffMessage(_pnet_Sender *sender, _pnet_Sender *target,
+                           _pnet_Message *message);
+void _pnet_AcknowledgeMessage(_pnet_Sender *sender, const kint_t *nonce,
+                              const pnet_Host *host);
+void _pnet_MeasureRoundTrip(_pnet_Sender *sender, const kint_t *nonce,
+                            const pnet_Host *host);
+bool _pnet_GetRoundTrip(_pnet_Sender *sender, const pnet_Host *host, tims_t *srtt,
+                        tims_t *rttvar);
+tims_t _pnet_EstimateTimeout(_pnet_Sender *sender, const pnet_Host *host);
 err_t _pnet_SendOutgoing(_pnet_Sender *sender, _pnet_Server *server);
 
 #endif
@@ -6,20 +6,78 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 
+#ifdef KDT_USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+#ifdef KDT_USE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
+#define _ACCEPT_BATCH_SIZE 8
+
 union _sockaddr_any {
     struct sockaddr_in ipv4;
     struct sockaddr_in6 ipv6;
 };
 
-inline
-err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_error) {
+static
+err_t ApplyProfile(const pnet_Profile *profile, int fd, int type, bool is_listener);
+
+static
+err_t AddSocket(_pnet_Server *server, int fd);
+
+static
+void RemoveSocket(_pnet_Server *server, int fd);
+
+static
+void EvictSocket(_pnet_Socket *socket);
+
+static
+err_t OpenWake(_pnet_Server *server);
+
+static
+void CloseWake(_pnet_Server *server);
+
+static
+void DrainWake(_pnet_Server *server);
+
+static
+err_t WaitSockets(_pnet_Server *server, int timeout);
+
+/*
+ * If `reuse_port` is true, the interface socket is bound with SO_REUSEPORT,
+ * allowing other servers to bind to the same interface and port, which makes
+ * the kernel distribute incoming connections and datagrams among them.
+ *
+ * The `profile` options are applied to the interface socket before it starts
+ * listening, as that allows buffer sizes to affect the TCP window scaling of
+ * accepted connections, which inherit the options of the listener.
+ */
+err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface,
+                 const pnet_Profile *profile, bool reuse_port,
+                 _pnet_OnError on_error, _pnet_OnReply on_reply) {
     assert(server != NULL);
     assert(interface != NULL);
+    assert(profile != NULL);
+
+#ifndef KDT_USE_TCP_QUICKACK
+    if (profile->quick_ack) {
+        return ERR_NOT_COMPATIBLE;
+    }
+#endif
+#ifndef KDT_USE_TCP_FASTOPEN
+    if (profile->fast_open) {
+        return ERR_NOT_COMPATIBLE;
+    }
+#endif
 
     // Set `interface` defaults, unless already set.
     if (interface->internet == PNET_INTERNET_NONE) {
@@ -78,6 +136,10 @@ err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_er
             type = SOCK_STREAM;
             break;
 
+        case PNET_TRANSPORT_UDP:
+            type = SOCK_DGRAM;
+            break;
+
         default:
             return EINVAL;
         }
@@ -89,6 +151,7 @@ err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_er
     int fd;
     {
         const int on = 1;
+        const int off = 0;
         int flags;
 
         if ((fd = socket(domain, type, 0)) < 0) {
@@ -99,6 +162,25 @@ err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_er
             err = errno;
             goto leave_close;
         }
+        if (domain == AF_INET6 &&
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (char *) &off, sizeof(int)) != 0) {
+            err = errno;
+            goto leave_close;
+        }
+        if (reuse_port) {
+#ifdef KDT_USE_REUSEPORT
+            if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (char *) &on, sizeof(int)) != 0) {
+                err = errno;
+                goto leave_close;
+            }
+#else
+            err = ERR_NOT_COMPATIBLE;
+            goto leave_close;
+#endif
+        }
+        if ((err = ApplyProfile(profile, fd, type, true)) != ERR_NONE) {
+            goto leave_close;
+        }
         if ((flags = fcntl(fd, F_GETFL, 0)) < 0) {
             err = errno;
             goto leave_close;
@@ -115,7 +197,7 @@ err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_er
             err = errno;
             goto leave_close;
         }
-        if (listen(fd, KDT_N_BACKLOG) != 0) {
+        if (type == SOCK_STREAM && listen(fd, KDT_N_BACKLOG) != 0) {
             err = errno;
             goto leave_close;
         }
@@ -124,11 +206,33 @@ err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_er
     // Initialize server fields.
     {
         server->fd = fd;
-        server->fd_max = fd;
+#ifdef KDT_USE_EPOLL
+        if ((server->fd_epoll = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+            err = errno;
+            goto leave_close;
+        }
+        server->fd_ready_count = 0;
+        server->fd_writable_count = 0;
+        memset(server->fd_flags, 0, sizeof(server->fd_flags));
+#else
+        server->fd_max = -1;
         FD_ZERO(&server->fd_set);
-        FD_SET(fd, &server->fd_set);
+#endif
+        if ((err = OpenWake(server)) != ERR_NONE) {
+            goto leave_close_poll;
+        }
+        if ((err = AddSocket(server, fd)) != ERR_NONE) {
+            goto leave_close_wake;
+        }
+        if ((err = _pnet_InitBatch(&server->batch)) != ERR_NONE) {
+            goto leave_close_wake;
+        }
+        _pnet_InitPool(&server->pool);
+        _pnet_InitConnections(&server->connections);
+        server->accepts_pending = false;
 
         server->interface = interface;
+        server->profile = *profile;
     }
 
     // Update `interface` data, again.
@@ -137,15 +241,27 @@ err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_er
             memcpy(interface->address, addr, addrlen);
         }
         if (port != NULL) {
-            interface->port = *port;
+            interface->port = ntohs(*port);
         }
     }
 
-    // Set error handler.
+    // Set event handlers.
     server->on_error = on_error;
+    server->on_reply = on_reply;
+
+    atomic_init(&server->wake_sequence, 0);
+    atomic_init(&server->waiting, false);
 
     goto leave;
 
+leave_close_wake:
+    CloseWake(server);
+
+leave_close_poll:
+#ifdef KDT_USE_EPOLL
+    close(server->fd_epoll);
+#endif
+
 leave_close:
     close(fd);
 
@@ -155,45 +271,125 @@ leave:
 
 inline
 void _pnet_Close(_pnet_Server *server) {
+    _pnet_TermBatch(&server->batch);
+    CloseWake(server);
+
+#ifdef KDT_USE_EPOLL
+    for (int i = 0; i < KDT_N_SOCKETS; ++i) {
+        if ((server->fd_flags[i] & _PNET_SOCKET_OPEN) != 0) {
+            close(i);
+        }
+    }
+    close(server->fd_epoll);
+#else
     for (int i = 0; i <= server->fd_max; ++i) {
         if (FD_ISSET(i, &server->fd_set)) {
             close(i);
         }
     }
+#endif
 }
 
-inline
+typedef struct _AcceptContext _AcceptContext;
+
+struct _AcceptContext {
+    _pnet_Server *server;
+    err_t err;
+};
+
+/*
+ * Accepted connections are tracked by the server connection table, which may
+ * evict the least recently active connection to make room for each new one.
+ */
+static
+void OnAccept(void *context, _pnet_BatchOp *op) {
+    _AcceptContext *_context = context;
+    _pnet_Server *server = _context->server;
+    if (op->err != ERR_NONE) {
+        _context->err = op->err;
+        return;
+    }
+    if (AddSocket(server, op->socket.fd) != ERR_NONE) {
+        close(op->socket.fd);
+        return;
+    }
+    _pnet_Socket evicted;
+    if (!_pnet_AddConnection(&server->connections, &op->socket, tims_Now(), &evicted)) {
+        RemoveSocket(server, op->socket.fd);
+        close(op->socket.fd);
+        return;
+    }
+    if (!_pnet_IsSocketEmpty(&evicted)) {
+        EvictSocket(&evicted);
+    }
+}
+
+/*
+ * Accepts until the listener backlog is empty, as an edge-triggered listener
+ * is not reported as readable again until another connection arrives. Accepts
+ * are attempted `_ACCEPT_BATCH_SIZE` at a time, and at most KDT_N_ACCEPT
+ * connections are accepted per call. If that many are, `accepts_pending` is
+ * set, and the rest of the backlog is accepted during subsequent calls.
+ */
 err_t _pnet_Accept(_pnet_Server *server) {
-    int fd;
+    _pnet_Socket listener = {.fd = server->fd};
+    _AcceptContext context = {.server = server, .err = ERR_NONE};
+    err_t err;
+    size_t accepted = 0;
     do {
-        if ((fd = accept(server->fd, NULL, NULL)) < 0) {
-            return errno;
+        if (accepted >= KDT_N_ACCEPT) {
+            server->accepts_pending = true;
+            return ERR_NONE;
         }
-        FD_SET(fd, &server->fd_set);
-        if (server->fd_max < fd) {
-            server->fd_max = fd;
+        for (size_t i = _ACCEPT_BATCH_SIZE; i-- != 0;) {
+            _pnet_BatchAccept(&server->batch, &listener, NULL);
         }
-    } while (fd >= 0);
-    return ERR_NONE;
+        if ((err = _pnet_FlushBatch(&server->batch, &context, OnAccept)) != ERR_NONE) {
+            return err;
+        }
+        accepted += _ACCEPT_BATCH_SIZE;
+    } while (context.err == ERR_NONE);
+
+    server->accepts_pending = false;
+    return context.err == EAGAIN || context.err == EWOULDBLOCK
+        ? ERR_NONE
+        : context.err;
 }
 
-inline
+/*
+ * Sockets still pinned or parked with are shut down rather than closed, which
+ * makes any further sends or receives via them fail, and are closed only when
+ * their last pin is removed or their parked event is taken and finds them
+ * closed. See `_pnet_Connections` for details.
+ */
 void _pnet_CloseSocket(_pnet_Server *server, _pnet_Socket *socket) {
-    FD_CLR(socket->fd, &server->fd_set);
-    if (server->fd_max == socket->fd) {
-        server->fd_max -= 1;
+    _pnet_RemovePooledSocket(&server->pool, socket);
+    if (!_pnet_CloseConnection(&server->connections, socket)) {
+        shutdown(socket->fd, SHUT_RDWR);
+        return;
     }
+    RemoveSocket(server, socket->fd);
     close(socket->fd);
 }
 
-err_t _pnet_Connect(_pnet_Server *server, const pnet_Host *host, _pnet_Socket *out) {
+/*
+ * The socket is created immediately, while the connection attempt is queued in
+ * the server batch. Its outcome is reported, with `context`, to the callback
+ * passed to the `_pnet_FlushBatch()` call completing it. If that outcome is
+ * EINPROGRESS, the socket becomes writable when the attempt completes, after
+ * which its final outcome is read via `_pnet_GetSocketError()`. The socket is
+ * added to the server connection pool, making it possible to reuse it after
+ * being released via `_pnet_ReleaseSocket()`, and is pinned until then. It is
+ * polled for readability like any other socket, as responses to the requests
+ * sent via it arrive via it. The socket is of the same family as `host`,
+ * regardless of the internet protocol of the server interface.
+ */
+err_t _pnet_Connect(_pnet_Server *server, const pnet_Host *host, void *context,
+                    _pnet_Socket *out) {
     assert(server != NULL);
     assert(host != NULL);
     assert(out != NULL);
 
-    if (host->internet != server->interface->internet) {
-        return ERR_NOT_COMPATIBLE; // Should we handle multiple internet protocols at once?
-    }
     if (host->transport != server->interface->transport) {
         return ERR_NOT_COMPATIBLE; // Should we handle multiple transport protocols at once?
     }
@@ -255,6 +451,9 @@ err_t _pnet_Connect(_pnet_Server *server, const pnet_Host *host, _pnet_Socket *o
             err = errno;
             goto leave_close;
         }
+        if ((err = ApplyProfile(&server->profile, fd, type, false)) != ERR_NONE) {
+            goto leave_close;
+        }
         if ((flags = fcntl(fd, F_GETFL, 0)) < 0) {
             err = errno;
             goto leave_close;
@@ -263,15 +462,22 @@ err_t _pnet_Connect(_pnet_Server *server, const pnet_Host *host, _pnet_Socket *o
             err = errno;
             goto leave_close;
         }
-        if (connect(fd, (struct sockaddr *) &sockaddr, socklen) != 0) {
-            if (errno != EINPROGRESS) {
-                err = errno;
-                goto leave_close;
-            }
+        if ((err = AddSocket(server, fd)) != ERR_NONE) {
+            goto leave_close;
         }
     }
 
     out->fd = fd;
+    _pnet_PinSocket(server, out);
+
+    _pnet_Socket evicted;
+    if (_pnet_AddPooledSocket(&server->pool, host, out, &evicted) &&
+        !_pnet_IsSocketEmpty(&evicted)) {
+        _pnet_CloseSocket(server, &evicted);
+    }
+
+    _pnet_BatchConnect(&server->batch, out, (struct sockaddr *) &sockaddr, socklen,
+                       context);
 
     goto leave;
 
@@ -282,6 +488,27 @@ leave:
     return err;
 }
 
+/*
+ * Idle outbound connections are closed, while inbound connections without
+ * traffic for KDT_T_CONNECTION_IDLE seconds are evicted.
+ */
+void _pnet_ExpireSockets(_pnet_Server *server) {
+    const tims_t now = tims_Now();
+    _pnet_Socket socket;
+    while (_pnet_PopExpiredSocket(&server->pool, now, &socket)) {
+        _pnet_CloseSocket(server, &socket);
+    }
+    while (_pnet_PopIdleConnection(&server->connections,
+                                   now - KDT_T_CONNECTION_IDLE, &socket)) {
+        EvictSocket(&socket);
+    }
+}
+
+inline
+void _pnet_GetInterfaceSocket(const _pnet_Server *server, _pnet_Socket *out) {
+    out->fd = server->fd;
+}
+
 inline
 void _pnet_HandleError(_pnet_Server *server, _pnet_Error *error) {
     assert(server != NULL);
@@ -290,7 +517,387 @@ void _pnet_HandleError(_pnet_Server *server, _pnet_Error *error) {
     server->on_error.callback(error, server->on_error.data);
 }
 
-err_t _pnet_PollReadableSockets(const _pnet_Server *server, _pnet_SocketSet *out) {
+inline
+void _pnet_HandleReply(_pnet_Server *server, const kint_t *nonce, const pnet_Host *host) {
+    assert(server != NULL);
+    assert(nonce != NULL);
+    assert(host != NULL);
+
+    server->on_reply.callback(nonce, host, server->on_reply.data);
+}
+
+/*
+ * Sockets closed while taken are no longer pooled, and are closed when
+ * unpinned.
+ */
+void _pnet_ReleaseSocket(_pnet_Server *server, _pnet_Socket *socket) {
+    const tims_t expires = tims_Now() + KDT_T_POOL_IDLE;
+    if (!_pnet_ReleasePooledSocket(&server->pool, socket, expires)) {
+        _pnet_CloseSocket(server, socket);
+    }
+    _pnet_UnpinSocket(server, socket);
+}
+
+/*
+ * Linux leaves quick acknowledgement mode on its own whenever a connection
+ * appears to be interactive, which is why the option is renewed after reads.
+ */
+inline
+void _pnet_RenewQuickAck(const _pnet_Server *server, const _pnet_Socket *socket) {
+#ifdef KDT_USE_TCP_QUICKACK
+    if (server->profile.quick_ack) {
+        const int on = 1;
+        setsockopt(socket->fd, IPPROTO_TCP, TCP_QUICKACK, (char *) &on, sizeof(int));
+    }
+#else
+    (void) server;
+    (void) socket;
+#endif
+}
+
+inline
+size_t _pnet_ContinueSocket(_pnet_Server *server, const _pnet_Socket *socket,
+                            size_t size, bool is_continued) {
+    return _pnet_ContinueConnection(&server->connections, socket, size, is_continued);
+}
+
+inline
+bool _pnet_ParkSocket(_pnet_Server *server, const _pnet_Socket *socket, size_t event) {
+    return _pnet_ParkConnectionEvent(&server->connections, socket, event);
+}
+
+inline
+bool _pnet_UnparkSocket(_pnet_Server *server, const _pnet_Socket *socket, size_t *out) {
+    return _pnet_UnparkConnectionEvent(&server->connections, socket, out);
+}
+
+inline
+bool _pnet_PinSocket(_pnet_Server *server, const _pnet_Socket *socket) {
+    return _pnet_PinConnection(&server->connections, socket);
+}
+
+inline
+void _pnet_UnpinSocket(_pnet_Server *server, const _pnet_Socket *socket) {
+    if (_pnet_UnpinConnection(&server->connections, socket)) {
+        RemoveSocket(server, socket->fd);
+        close(socket->fd);
+    }
+}
+
+inline
+size_t _pnet_GetSocketWriter(const _pnet_Server *server, const _pnet_Socket *socket) {
+    return _pnet_GetConnectionWriter(&server->connections, socket);
+}
+
+inline
+void _pnet_SetSocketWriter(_pnet_Server *server, const _pnet_Socket *socket,
+                           size_t writer) {
+    _pnet_SetConnectionWriter(&server->connections, socket, writer);
+}
+
+inline
+size_t _pnet_GetSocketWaiting(const _pnet_Server *server, const _pnet_Socket *socket) {
+    return _pnet_GetConnectionWaiting(&server->connections, socket);
+}
+
+inline
+void _pnet_SetSocketWaiting(_pnet_Server *server, const _pnet_Socket *socket,
+                            size_t waiting) {
+    _pnet_SetConnectionWaiting(&server->connections, socket, waiting);
+}
+
+inline
+bool _pnet_IsSocketClosing(const _pnet_Server *server, const _pnet_Socket *socket) {
+    return _pnet_IsConnectionClosing(&server->connections, socket);
+}
+
+inline
+void _pnet_TouchSocket(_pnet_Server *server, const _pnet_Socket *socket,
+                       size_t received, size_t sent) {
+    _pnet_TouchConnection(&server->connections, socket, tims_Now(), received, sent);
+}
+
+/*
+ * Connections found to have been closed by their remote peers while idle, or
+ * to be broken, are closed and skipped. Connections with received bytes not
+ * yet read are kept, as those bytes belong to responses to earlier requests,
+ * which the receiver reads as the socket is readable. The taken socket is
+ * pinned until released via `_pnet_ReleaseSocket()`. See
+ * `_pnet_TakePooledSocket()` for what errors may be returned.
+ */
+err_t _pnet_TakeSocket(_pnet_Server *server, const pnet_Host *host, _pnet_Socket *out) {
+    err_t err;
+    while ((err = _pnet_TakePooledSocket(&server->pool, host, out)) == ERR_NONE) {
+        uint8_t byte;
+        const ssize_t status = recv(out->fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (status > 0 || (status < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+            break;
+        }
+        // Connection closed or broken.
+        _pnet_CloseSocket(server, out);
+        *out = SOCKET_EMPTY;
+    }
+    if (err == ERR_NONE) {
+        _pnet_PinSocket(server, out);
+    }
+    return err;
+}
+
+inline
+unsigned _pnet_PrepareWait(_pnet_Server *server) {
+    return atomic_load(&server->wake_sequence);
+}
+
+/*
+ * Blocks until any socket becomes ready, `_pnet_Wake()` is called after
+ * `ticket` was acquired via `_pnet_PrepareWait()`, or `timeout` seconds have
+ * passed. Sockets becoming ready are reported by the next socket poll.
+ */
+err_t _pnet_Wait(_pnet_Server *server, unsigned ticket, tims_t timeout) {
+    assert(server != NULL);
+
+    err_t err = ERR_NONE;
+    atomic_store(&server->waiting, true);
+    if (atomic_load(&server->wake_sequence) == ticket && timeout > 0.0) {
+        err = WaitSockets(server, timeout < INT_MAX / 1000
+            ? (int) (timeout * 1000.0 + 0.999)
+            : INT_MAX / 1000 * 1000);
+    }
+    atomic_store(&server->waiting, false);
+    return err;
+}
+
+/*
+ * The wake descriptor is only written to if some thread is waiting, as threads
+ * about to wait always check whether `wake_sequence` changed first.
+ */
+void _pnet_Wake(_pnet_Server *server) {
+    assert(server != NULL);
+
+    atomic_fetch_add(&server->wake_sequence, 1);
+    if (atomic_load(&server->waiting)) {
+        const uint64_t value = 1;
+        if (write(server->fd_wake_w, &value, sizeof(value)) < 0) {
+            // Descriptor buffer full, which means it is readable already.
+        }
+    }
+}
+
+static
+err_t OpenWake(_pnet_Server *server) {
+#ifdef KDT_USE_EVENTFD
+    const int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0) {
+        return errno;
+    }
+    server->fd_wake_r = fd;
+    server->fd_wake_w = fd;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return errno;
+    }
+    server->fd_wake_r = fds[0];
+    server->fd_wake_w = fds[1];
+    for (size_t i = 0; i < 2; ++i) {
+        int flags;
+        if ((flags = fcntl(fds[i], F_GETFL, 0)) < 0 ||
+            fcntl(fds[i], F_SETFL, flags | O_NONBLOCK) != 0) {
+            const err_t err = errno;
+            CloseWake(server);
+            return err;
+        }
+    }
+#endif
+
+#ifdef KDT_USE_EPOLL
+    struct epoll_event event = {
+        .events = EPOLLIN,
+        .data.fd = server->fd_wake_r,
+    };
+    if (epoll_ctl(server->fd_epoll, EPOLL_CTL_ADD, server->fd_wake_r, &event) != 0) {
+        const err_t err = errno;
+        CloseWake(server);
+        return err;
+    }
+#else
+    if (server->fd_wake_r >= FD_SETSIZE) {
+        CloseWake(server);
+        return EMFILE;
+    }
+#endif
+    return ERR_NONE;
+}
+
+static
+void CloseWake(_pnet_Server *server) {
+    close(server->fd_wake_r);
+    if (server->fd_wake_w != server->fd_wake_r) {
+        close(server->fd_wake_w);
+    }
+}
+
+static
+void DrainWake(_pnet_Server *server) {
+    uint64_t buffer[8];
+    while (read(server->fd_wake_r, buffer, sizeof(buffer)) > 0) {}
+}
+
+/*
+ * Evicted sockets are shut down rather than closed, as they may still be read
+ * from by parked events or written to by responses. Shut down sockets are
+ * reported readable, after which the receiver finds them closed and closes
+ * them via `_pnet_CloseSocket()`, while any sends via them fail. The sockets
+ * of responses are pinned from when first sent via, which is why their
+ * descriptors are not reused until those responses are done with them.
+ */
+static
+void EvictSocket(_pnet_Socket *socket) {
+    shutdown(socket->fd, SHUT_RDWR);
+}
+
+/*
+ * Outbound sockets using TCP Fast Open do not connect until first sent to,
+ * allowing for the sent bytes to be carried by the SYN segment. Listeners
+ * using it must be given the length of their queue of connections accepted
+ * via Fast Open, but not yet completing the three-way handshake.
+ */
+static
+err_t ApplyProfile(const pnet_Profile *profile, int fd, int type, bool is_listener) {
+    const int on = 1;
+
+    if (profile->send_buffer_size > 0) {
+        const int size = profile->send_buffer_size < INT_MAX
+            ? (int) profile->send_buffer_size
+            : INT_MAX;
+        if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (char *) &size, sizeof(int)) != 0) {
+            return errno;
+        }
+    }
+    if (profile->receive_buffer_size > 0) {
+        const int size = profile->receive_buffer_size < INT_MAX
+            ? (int) profile->receive_buffer_size
+            : INT_MAX;
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char *) &size, sizeof(int)) != 0) {
+            return errno;
+        }
+    }
+    if (type != SOCK_STREAM) {
+        return ERR_NONE;
+    }
+    if (profile->no_delay &&
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char *) &on, sizeof(int)) != 0) {
+        return errno;
+    }
+#ifdef KDT_USE_TCP_QUICKACK
+    if (profile->quick_ack &&
+        setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, (char *) &on, sizeof(int)) != 0) {
+        return errno;
+    }
+#endif
+#ifdef KDT_USE_TCP_FASTOPEN
+    if (profile->fast_open) {
+        const int backlog = KDT_N_BACKLOG;
+        const int status = is_listener
+            ? setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, (char *) &backlog, sizeof(int))
+            : setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, (char *) &on, sizeof(int));
+        if (status != 0) {
+            return errno;
+        }
+    }
+#else
+    (void) is_listener;
+#endif
+    return ERR_NONE;
+}
+
+#ifdef KDT_USE_EPOLL
+
+/*
+ * Only the first epoll_wait() call may block for `timeout` milliseconds, while
+ * any further calls, made only if the first filled `events`, return at once.
+ */
+static
+err_t PollSockets(_pnet_Server *server, int timeout) {
+    struct epoll_event events[KDT_N_POLL_EVENTS];
+    int count;
+    do {
+        count = epoll_wait(server->fd_epoll, events, KDT_N_POLL_EVENTS, timeout);
+        if (count < 0) {
+            return errno == EINTR ? ERR_NONE : errno;
+        }
+        timeout = 0;
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            const uint32_t mask = events[i].events;
+            uint8_t *flags = &server->fd_flags[fd];
+
+            if (fd == server->fd_wake_r) {
+                DrainWake(server);
+                continue;
+            }
+            if ((*flags & _PNET_SOCKET_OPEN) == 0) {
+                continue;
+            }
+            if ((mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0 &&
+                (*flags & _PNET_SOCKET_READABLE) == 0 &&
+                server->fd_ready_count < KDT_N_SOCKETS) {
+                *flags |= _PNET_SOCKET_READABLE;
+                server->fd_ready[server->fd_ready_count++] = fd;
+            }
+            if ((mask & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0 &&
+                (*flags & _PNET_SOCKET_WRITABLE) == 0 &&
+                server->fd_writable_count < KDT_N_SOCKETS) {
+                *flags |= _PNET_SOCKET_WRITABLE;
+                server->fd_writable[server->fd_writable_count++] = fd;
+            }
+        }
+    } while (count == KDT_N_POLL_EVENTS);
+    return ERR_NONE;
+}
+
+err_t _pnet_PollReadableSockets(_pnet_Server *server, _pnet_SocketSet *out) {
+    out->server = server;
+    out->flag = _PNET_SOCKET_READABLE;
+    return PollSockets(server, 0);
+}
+
+err_t _pnet_PollWritableSockets(_pnet_Server *server, _pnet_SocketSet *out) {
+    out->server = server;
+    out->flag = _PNET_SOCKET_WRITABLE;
+    return PollSockets(server, 0);
+}
+
+static
+err_t WaitSockets(_pnet_Server *server, int timeout) {
+    return PollSockets(server, timeout);
+}
+
+static
+err_t AddSocket(_pnet_Server *server, int fd) {
+    if (fd >= KDT_N_SOCKETS) {
+        return EMFILE;
+    }
+    struct epoll_event event = {
+        .events = EPOLLIN | EPOLLRDHUP | EPOLLOUT | EPOLLET,
+        .data.fd = fd,
+    };
+    if (epoll_ctl(server->fd_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return errno;
+    }
+    server->fd_flags[fd] = _PNET_SOCKET_OPEN;
+    return ERR_NONE;
+}
+
+static
+void RemoveSocket(_pnet_Server *server, int fd) {
+    // Closing a descriptor removes it from the epoll instance.
+    server->fd_flags[fd] = 0;
+}
+
+#else
+
+err_t _pnet_PollReadableSockets(_pnet_Server *server, _pnet_SocketSet *out) {
     out->fd_server = server->fd;
     out->fd_max = server->fd_max;
     memcpy(&out->fd_set, &server->fd_set, sizeof(fd_set));
@@ -303,7 +910,7 @@ err_t _pnet_PollReadableSockets(const _pnet_Server *server, _pnet_SocketSet *out
     return ERR_NONE;
 }
 
-err_t _pnet_PollWritableSockets(const _pnet_Server *server, _pnet_SocketSet *out) {
+err_t _pnet_PollWritableSockets(_pnet_Server *server, _pnet_SocketSet *out) {
     out->fd_server = server->fd;
     out->fd_max = server->fd_max;
     memcpy(&out->fd_set, &server->fd_set, sizeof(fd_set));
@@ -316,30 +923,76 @@ err_t _pnet_PollWritableSockets(const _pnet_Server *server, _pnet_SocketSet *out
     return ERR_NONE;
 }
 
-err_t _pnet_ResolveHost(const _pnet_Server *server, const _pnet_Socket *socket,
-                        pnet_Host *out) {
-    err_t err;
+/*
+ * All sockets are waited for to become readable, while only sockets with
+ * messages waiting for them are waited for to become writable, as polling
+ * every socket for writability would make select() return at once for as long
+ * as any socket remains writable. The sockets are polled again by the next
+ * socket poll.
+ */
+static
+err_t WaitSockets(_pnet_Server *server, int timeout) {
+    fd_set set;
+    memcpy(&set, &server->fd_set, sizeof(fd_set));
+    FD_SET(server->fd_wake_r, &set);
+
+    fd_set set_w;
+    FD_ZERO(&set_w);
+    for (int fd = 0; fd <= server->fd_max; ++fd) {
+        if (server->connections.entries[fd].waiting != SIZE_MAX) {
+            FD_SET(fd, &set_w);
+        }
+    }
 
-    union _sockaddr_any sender;
-    socklen_t size = sizeof(sender);
-    err = getpeername(socket->fd, (struct sockaddr *) &sender, &size);
-    if (err != ERR_NONE) {
-        return err;
+    const int fd_max = server->fd_max > server->fd_wake_r
+        ? server->fd_max
+        : server->fd_wake_r;
+
+    struct timeval tv = {
+        .tv_sec = timeout / 1000,
+        .tv_usec = (timeout % 1000) * 1000,
+    };
+    const int count = select(fd_max + 1, &set, &set_w, NULL, &tv);
+    if (count < 0) {
+        return errno == EINTR ? ERR_NONE : errno;
+    }
+    if (count > 0 && FD_ISSET(server->fd_wake_r, &set)) {
+        DrainWake(server);
+    }
+    return ERR_NONE;
+}
+
+static
+err_t AddSocket(_pnet_Server *server, int fd) {
+    if (fd >= FD_SETSIZE || fd >= KDT_N_SOCKETS) {
+        return EMFILE;
+    }
+    FD_SET(fd, &server->fd_set);
+    if (server->fd_max < fd) {
+        server->fd_max = fd;
     }
-    out->internet = server->interface->internet;
-    out->transport = server->interface->transport;
-    switch (out->internet) {
-    case PNET_INTERNET_IPV4:
-        out->port = ntohs(sender.ipv4.sin_port);
-        memcpy(out->address, &sender.ipv4.sin_addr, sizeof(sender.ipv4.sin_addr));
-        break;
+    return ERR_NONE;
+}
 
-    case PNET_INTERNET_IPV6:
-        out->port = ntohs(sender.ipv6.sin6_port);
-        memcpy(out->address, &sender.ipv6.sin6_addr, sizeof(sender.ipv6.sin6_addr));
-        break;
+static
+void RemoveSocket(_pnet_Server *server, int fd) {
+    FD_CLR(fd, &server->fd_set);
+    if (server->fd_max == fd) {
+        server->fd_max -= 1;
+    }
+}
+
+#endif
 
-    default:
+err_t _pnet_ResolveHost(const _pnet_Server *server, const _pnet_Socket *socket,
+                        pnet_Host *out) {
+    struct sockaddr_storage sender;
+    socklen_t size = sizeof(sender);
+    if (getpeername(socket->fd, (struct sockaddr *) &sender, &size) != 0) {
+        return errno;
+    }
+    _pnet_ReadSockaddr(&sender, server->interface->transport, out);
+    if (out->internet == PNET_INTERNET_NONE) {
         return EINVAL;
     }
     return ERR_NONE;
@@ -1,17 +1,27 @@
 #ifndef KDT_PNET_INTERNAL_SERVER_H
 #define KDT_PNET_INTERNAL_SERVER_H
 
+#include "../profile.h"
+#include "batch.h"
+#include "connections.h"
+#include "pool.h"
 #include "sender.h"
 #include "receiver.h"
+#include <kdt/def.h>
+#include <kdt/tims.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 #ifdef KDT_USE_POSIX
+#ifndef KDT_USE_EPOLL
 #include <sys/select.h>
 #endif
+#endif
 
 typedef struct _pnet_Error _pnet_Error;
 typedef struct _pnet_OnError _pnet_OnError;
+typedef struct _pnet_OnReply _pnet_OnReply;
 typedef struct _pnet_Server _pnet_Server;
 typedef struct _pnet_Socket _pnet_Socket;
 typedef struct _pnet_SocketSet _pnet_SocketSet;
@@ -21,23 +31,79 @@ struct _pnet_OnError {
     void *data;
 };
 
+struct _pnet_OnReply {
+    void (*callback)(const kint_t *, const pnet_Host *, void *);
+    void *data;
+};
+
 struct _pnet_Server {
 #ifdef KDT_USE_POSIX
     /// Listener socket file descriptor.
     int fd;
 
+    /// Descriptor made readable by `_pnet_Wake()`, to interrupt `_pnet_Wait()`.
+    int fd_wake_r;
+
+    /// Descriptor written to by `_pnet_Wake()`. Same as `fd_wake_r` if eventfd.
+    int fd_wake_w;
+
+#ifdef KDT_USE_EPOLL
+    /// epoll instance file descriptor.
+    int fd_epoll;
+
+    /// Number of descriptors in `fd_ready`.
+    size_t fd_ready_count;
+
+    /// Readable sockets not yet claimed by any receiver event.
+    int fd_ready[KDT_N_SOCKETS];
+
+    /// Number of descriptors in `fd_writable`.
+    size_t fd_writable_count;
+
+    /// Sockets that became writable since last visited by the sender.
+    int fd_writable[KDT_N_SOCKETS];
+
+    /// Registration and readiness flags of all sockets, indexed by descriptor.
+    uint8_t fd_flags[KDT_N_SOCKETS];
+#else
     /// Number of highest active socket.
     int fd_max;
 
-    /// Set of all client sockets.
+    /// Set of all sockets, polled for both readability and writability.
     fd_set fd_set;
 #endif
+#endif
+
+    /// Socket operation batch.
+    _pnet_Batch batch;
+
+    /// Reusable outbound connections.
+    _pnet_Pool pool;
+
+    /// Accepted inbound connections.
+    _pnet_Connections connections;
+
+    /// Whether the last accept round stopped before the listener backlog was
+    /// known to be empty.
+    bool accepts_pending;
 
     /// Socket interface.
     const pnet_Host *interface;
 
+    /// Options applied to all sockets.
+    pnet_Profile profile;
+
     /// Function used for reporting errors.
     _pnet_OnError on_error;
+
+    /// Function used for reporting datagrams that may acknowledge others.
+    _pnet_OnReply on_reply;
+
+    /// Number of times `_pnet_Wake()` has been called.
+    atomic_uint wake_sequence;
+
+    /// Whether a thread is, or is about to start, waiting in `_pnet_Wait()`.
+    atomic_bool waiting;
 };
 
 struct _pnet_Error {
@@ -47,14 +113,41 @@ struct _pnet_Error {
     err_t err;
 };
 
-err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface, _pnet_OnError on_error);
+err_t _pnet_Open(_pnet_Server *server, pnet_Host *interface,
+                 const pnet_Profile *profile, bool reuse_port,
+                 _pnet_OnError on_error, _pnet_OnReply on_reply);
 void _pnet_Close(_pnet_Server *server);
 err_t _pnet_Accept(_pnet_Server *server);
 void _pnet_CloseSocket(_pnet_Server *server, _pnet_Socket *socket);
-err_t _pnet_Connect(_pnet_Server *server, const pnet_Host *host, _pnet_Socket *out);
+size_t _pnet_ContinueSocket(_pnet_Server *server, const _pnet_Socket *socket,
+                            size_t size, bool is_continued);
+err_t _pnet_Connect(_pnet_Server *server, const pnet_Host *host, void *context,
+                    _pnet_Socket *out);
+void _pnet_ExpireSockets(_pnet_Server *server);
+void _pnet_GetInterfaceSocket(const _pnet_Server *server, _pnet_Socket *out);
+size_t _pnet_GetSocketWaiting(const _pnet_Server *server, const _pnet_Socket *socket);
+size_t _pnet_GetSocketWriter(const _pnet_Server *server, const _pnet_Socket *socket);
 void _pnet_HandleError(_pnet_Server *server, _pnet_Error *error);
-err_t _pnet_PollReadableSockets(const _pnet_Server *server, _pnet_SocketSet *out);
-err_t _pnet_PollWritableSockets(const _pnet_Server *server, _pnet_SocketSet *out);
+void _pnet_HandleReply(_pnet_Server *server, const kint_t *nonce, const pnet_Host *host);
+bool _pnet_IsSocketClosing(const _pnet_Server *server, const _pnet_Socket *socket);
+bool _pnet_ParkSocket(_pnet_Server *server, const _pnet_Socket *socket, size_t event);
+bool _pnet_PinSocket(_pnet_Server *server, const _pnet_Socket *socket);
+void _pnet_ReleaseSocket(_pnet_Server *server, _pnet_Socket *socket);
+void _pnet_RenewQuickAck(const _pnet_Server *server, const _pnet_Socket *socket);
+void _pnet_SetSocketWaiting(_pnet_Server *server, const _pnet_Socket *socket,
+                            size_t waiting);
+void _pnet_SetSocketWriter(_pnet_Server *server, const _pnet_Socket *socket,
+                           size_t writer);
+void _pnet_TouchSocket(_pnet_Server *server, const _pnet_Socket *socket,
+                       size_t received, size_t sent);
+err_t _pnet_TakeSocket(_pnet_Server *server, const pnet_Host *host, _pnet_Socket *out);
+bool _pnet_UnparkSocket(_pnet_Server *server, const _pnet_Socket *socket, size_t *out);
+void _pnet_UnpinSocket(_pnet_Server *server, const _pnet_Socket *socket);
+unsigned _pnet_PrepareWait(_pnet_Server *server);
+err_t _pnet_Wait(_pnet_Server *server, unsigned ticket, tims_t timeout);
+void _pnet_Wake(_pnet_Server *server);
+err_t _pnet_PollReadableSockets(_pnet_Server *server, _pnet_SocketSet *out);
+err_t _pnet_PollWritableSockets(_pnet_Server *server, _pnet_SocketSet *out);
 err_t _pnet_ResolveHost(const _pnet_Server *server, const _pnet_Socket *socket,
                         pnet_Host *out);
 
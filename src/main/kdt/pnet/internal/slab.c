@@ -0,0 +1,65 @@
+#include "slab.h"
+#include <assert.h>
+
+static
+void InitClass(_pnet_SlabClass *class, uint8_t *blocks, size_t size, size_t count,
+               atomic_size_t *allocations);
+
+inline
+void _pnet_InitSlab(_pnet_Slab *slab) {
+    assert(slab != NULL);
+
+    InitClass(&slab->classes[0], &slab->_blocks_s[0][0], _PNET_SLAB_S_SIZE,
+              KDT_N_SLAB_S_COUNT, slab->_allocations_s);
+    InitClass(&slab->classes[1], &slab->_blocks_m[0][0], _PNET_SLAB_M_SIZE,
+              KDT_N_SLAB_M_COUNT, slab->_allocations_m);
+    InitClass(&slab->classes[2], &slab->_blocks_l[0][0], _PNET_SLAB_L_SIZE,
+              KDT_N_SLAB_L_COUNT, slab->_allocations_l);
+}
+
+/*
+ * The classes are visited in order of increasing block size, which means that
+ * the smallest available block able to fit `size` bytes is selected. NULL is
+ * returned if no such block is available. The actual size of the allocated
+ * block is written to `capacity`.
+ */
+uint8_t *_pnet_AllocateSlab(_pnet_Slab *slab, size_t size, size_t *capacity) {
+    assert(slab != NULL);
+    assert(capacity != NULL);
+
+    for (size_t i = 0; i < _PNET_SLAB_CLASS_COUNT; ++i) {
+        _pnet_SlabClass *class = &slab->classes[i];
+        if (class->size < size) {
+            continue;
+        }
+        size_t index;
+        if (abitset_Allocate(&class->allocations, &index)) {
+            *capacity = class->size;
+            return &class->blocks[index * class->size];
+        }
+    }
+    return NULL;
+}
+
+void _pnet_FreeSlab(_pnet_Slab *slab, uint8_t *block) {
+    assert(slab != NULL);
+    assert(block != NULL);
+
+    for (size_t i = 0; i < _PNET_SLAB_CLASS_COUNT; ++i) {
+        _pnet_SlabClass *class = &slab->classes[i];
+        if (block >= class->blocks && block < &class->blocks[class->count * class->size]) {
+            abitset_Set(&class->allocations, (size_t) (block - class->blocks) / class->size);
+            return;
+        }
+    }
+    assert(false);
+}
+
+static
+void InitClass(_pnet_SlabClass *class, uint8_t *blocks, size_t size, size_t count,
+               atomic_size_t *allocations) {
+    class->blocks = blocks;
+    class->size = size;
+    class->count = count;
+    abitset_Init(&class->allocations, allocations, count);
+}
@@ -0,0 +1,60 @@
+#ifndef KDT_PNET_INTERNAL_SLAB_H
+#define KDT_PNET_INTERNAL_SLAB_H
+
+#include "header.h"
+#include <kdt/abitset.h>
+#include <kdt/def.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define _PNET_SLAB_CLASS_COUNT 3
+
+#define _PNET_SLAB_S_SIZE (_PNET_HEADER_SIZE + KDT_N_SLAB_S_SIZE)
+#define _PNET_SLAB_M_SIZE (_PNET_HEADER_SIZE + KDT_N_SLAB_M_SIZE)
+#define _PNET_SLAB_L_SIZE (_PNET_HEADER_SIZE + KDT_N_BUFFER_SIZE)
+
+typedef struct _pnet_Slab _pnet_Slab;
+typedef struct _pnet_SlabClass _pnet_SlabClass;
+
+struct _pnet_SlabClass {
+    /// Pointer to first block of class.
+    uint8_t *blocks;
+
+    /// Size of each block, in bytes.
+    size_t size;
+
+    /// Number of blocks.
+    size_t count;
+
+    /// Bit set for keeping track of block allocations.
+    abitset_t allocations;
+};
+
+/**
+ * A set of message buffers of a few distinct sizes.
+ *
+ * Each requested buffer is taken from the class of the smallest blocks able to
+ * fit it, or from a class of larger blocks if the fitting class is exhausted.
+ * Each block is _PNET_HEADER_SIZE bytes larger than the payload size of its
+ * class.
+ */
+struct _pnet_Slab {
+    /// Block classes, ordered by block size.
+    _pnet_SlabClass classes[_PNET_SLAB_CLASS_COUNT];
+
+    /// Backing memory for class bit sets.
+    atomic_size_t _allocations_s[ABITSET_WORDS(KDT_N_SLAB_S_COUNT)];
+    atomic_size_t _allocations_m[ABITSET_WORDS(KDT_N_SLAB_M_COUNT)];
+    atomic_size_t _allocations_l[ABITSET_WORDS(KDT_N_SLAB_L_COUNT)];
+
+    /// Backing memory for class blocks.
+    uint8_t _blocks_s[KDT_N_SLAB_S_COUNT][_PNET_SLAB_S_SIZE];
+    uint8_t _blocks_m[KDT_N_SLAB_M_COUNT][_PNET_SLAB_M_SIZE];
+    uint8_t _blocks_l[KDT_N_SLAB_L_COUNT][_PNET_SLAB_L_SIZE];
+};
+
+void _pnet_InitSlab(_pnet_Slab *slab);
+uint8_t *_pnet_AllocateSlab(_pnet_Slab *slab, size_t size, size_t *capacity);
+void _pnet_FreeSlab(_pnet_Slab *slab, uint8_t *block);
+
+#endif
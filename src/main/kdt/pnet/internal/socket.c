@@ -1,9 +1,17 @@
+#ifdef KDT_USE_MMSG
+#define _GNU_SOURCE
+#endif
+
 #include "socket.h"
 
 #ifdef KDT_USE_POSIX
 #include <assert.h>
 #include <errno.h>
+#include <kdt/def.h>
+#include <netinet/in.h>
+#include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 inline
 bool _pnet_IsSocketEmpty(const _pnet_Socket *socket) {
@@ -11,23 +19,65 @@ bool _pnet_IsSocketEmpty(const _pnet_Socket *socket) {
 }
 
 inline
-err_t _pnet_Send(_pnet_Socket *socket, size_t *size, uint8_t *data) {
+bool _pnet_IsSocketEqual(const _pnet_Socket *a, const _pnet_Socket *b) {
+    return a->fd == b->fd;
+}
+
+/*
+ * Reading the pending error of a socket also clears it. The error of a failed
+ * asynchronous connection attempt is reported this way.
+ */
+inline
+err_t _pnet_GetSocketError(const _pnet_Socket *socket) {
     assert(socket != NULL);
-    assert(size != NULL);
-    assert(data != NULL || *size == 0);
 
-    ssize_t status = send(socket->fd, data, *size, 0);
+    int err = 0;
+    socklen_t err_size = sizeof(int);
+    if (getsockopt(socket->fd, SOL_SOCKET, SO_ERROR, &err, &err_size) != 0) {
+        return errno;
+    }
+    return err;
+}
+
+/*
+ * All `buffers` are sent via a single sendmsg() call, as if they were one
+ * contiguous buffer, which means that bytes referred to rather than owned by a
+ * message can be sent without first being copied, and that several messages
+ * can be sent via the same connection at the cost of one system call. Empty
+ * buffers are skipped. Sending via a connection shut down by either peer fails
+ * with EPIPE rather than raising SIGPIPE.
+ */
+err_t _pnet_Send(_pnet_Socket *socket, const _pnet_Buffer *buffers, size_t count,
+                 size_t *sent) {
+    assert(socket != NULL);
+    assert(buffers != NULL || count == 0);
+    assert(count <= _PNET_SEND_BUFFERS);
+    assert(sent != NULL);
+
+    struct iovec iovecs[_PNET_SEND_BUFFERS];
+    size_t iovecs_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (buffers[i].size == 0) {
+            continue;
+        }
+        iovecs[iovecs_count++] = (struct iovec) {
+            .iov_base = (void *) buffers[i].data,
+            .iov_len = buffers[i].size,
+        };
+    }
+    struct msghdr header = {
+        .msg_iov = iovecs,
+        .msg_iovlen = iovecs_count,
+    };
+    ssize_t status = sendmsg(socket->fd, &header, MSG_NOSIGNAL);
     if (status < 0) {
         status = errno;
 
         // Ensure there is no problem with the connection itself.
-        int err = 0;
-        socklen_t err_size = sizeof(int);
-        getsockopt(socket->fd, SOL_SOCKET, SO_ERROR, &err, &err_size);
-
-        return err != 0 ? err : (err_t) status;
+        err_t err = _pnet_GetSocketError(socket);
+        return err != ERR_NONE ? err : (err_t) status;
     }
-    *size = (size_t) status;
+    *sent = (size_t) status;
     return ERR_NONE;
 }
 
@@ -37,7 +87,7 @@ err_t _pnet_Receive(_pnet_Socket *socket, size_t *size, uint8_t *out) {
     assert(size != NULL);
     assert(out != NULL || *size == 0);
 
-    ssize_t status = recv(socket->fd, out, *size, 0);
+    ssize_t status = recv(socket->fd, out, *size, MSG_DONTWAIT);
     if (status < 0) {
         return errno;
     }
@@ -45,6 +95,259 @@ err_t _pnet_Receive(_pnet_Socket *socket, size_t *size, uint8_t *out) {
     return ERR_NONE;
 }
 
+#ifdef KDT_USE_MMSG
+
+/*
+ * Sends as many of the given datagrams as possible via a single sendmmsg()
+ * call. If at least one datagram is sent, ERR_NONE is returned even if not all
+ * could be sent. Otherwise the error preventing the first datagram from being
+ * sent is returned.
+ */
+err_t _pnet_SendDatagrams(_pnet_Socket *socket, _pnet_Datagram *datagrams,
+                          size_t count, size_t *sent) {
+    assert(socket != NULL);
+    assert(datagrams != NULL);
+    assert(sent != NULL);
+
+    struct mmsghdr headers[KDT_N_BATCH];
+    struct iovec iovecs[2 * KDT_N_BATCH];
+    struct sockaddr_storage sockaddrs[KDT_N_BATCH];
+
+    if (count > KDT_N_BATCH) {
+        count = KDT_N_BATCH;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        iovecs[2 * i] = (struct iovec) {
+            .iov_base = datagrams[i].data,
+            .iov_len = datagrams[i].size,
+        };
+        iovecs[2 * i + 1] = (struct iovec) {
+            .iov_base = (void *) datagrams[i].tail,
+            .iov_len = datagrams[i].tail_size,
+        };
+        headers[i] = (struct mmsghdr) {
+            .msg_hdr = {
+                .msg_name = &sockaddrs[i],
+                .msg_namelen = _pnet_WriteSockaddr(&datagrams[i].host, &sockaddrs[i]),
+                .msg_iov = &iovecs[2 * i],
+                .msg_iovlen = datagrams[i].tail_size > 0 ? 2 : 1,
+            },
+        };
+    }
+    int status = sendmmsg(socket->fd, headers, (unsigned int) count, MSG_DONTWAIT);
+    if (status < 0) {
+        *sent = 0;
+        return errno;
+    }
+    *sent = (size_t) status;
+    return ERR_NONE;
+}
+
+/*
+ * Receives up to `count` datagrams via a single recvmmsg() call. The size of
+ * each received datagram not fitting inside its buffer is set to 0. If no
+ * datagram could be received, the error preventing it is returned.
+ */
+err_t _pnet_ReceiveDatagrams(_pnet_Socket *socket, _pnet_Datagram *datagrams,
+                             size_t count, size_t *received) {
+    assert(socket != NULL);
+    assert(datagrams != NULL);
+    assert(received != NULL);
+
+    struct mmsghdr headers[KDT_N_BATCH];
+    struct iovec iovecs[KDT_N_BATCH];
+    struct sockaddr_storage sockaddrs[KDT_N_BATCH];
+
+    if (count > KDT_N_BATCH) {
+        count = KDT_N_BATCH;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        iovecs[i] = (struct iovec) {
+            .iov_base = datagrams[i].data,
+            .iov_len = datagrams[i].size,
+        };
+        headers[i] = (struct mmsghdr) {
+            .msg_hdr = {
+                .msg_name = &sockaddrs[i],
+                .msg_namelen = sizeof(struct sockaddr_storage),
+                .msg_iov = &iovecs[i],
+                .msg_iovlen = 1,
+            },
+        };
+    }
+    int status = recvmmsg(socket->fd, headers, (unsigned int) count, MSG_DONTWAIT, NULL);
+    if (status < 0) {
+        *received = 0;
+        return errno;
+    }
+    for (int i = 0; i < status; ++i) {
+        _pnet_ReadSockaddr(&sockaddrs[i], PNET_TRANSPORT_UDP, &datagrams[i].host);
+        datagrams[i].size = (headers[i].msg_hdr.msg_flags & MSG_TRUNC) == 0
+            ? headers[i].msg_len
+            : 0;
+    }
+    *received = (size_t) status;
+    return ERR_NONE;
+}
+
+#else
+
+/*
+ * Sends datagrams one at a time until all are sent or one cannot be. If at
+ * least one datagram is sent, ERR_NONE is returned even if not all could be
+ * sent. Otherwise the error preventing the first datagram from being sent is
+ * returned.
+ */
+err_t _pnet_SendDatagrams(_pnet_Socket *socket, _pnet_Datagram *datagrams,
+                          size_t count, size_t *sent) {
+    assert(socket != NULL);
+    assert(datagrams != NULL);
+    assert(sent != NULL);
+
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        struct sockaddr_storage sockaddr;
+        struct iovec iovecs[2] = {
+            {.iov_base = datagrams[i].data, .iov_len = datagrams[i].size},
+            {.iov_base = (void *) datagrams[i].tail, .iov_len = datagrams[i].tail_size},
+        };
+        struct msghdr header = {
+            .msg_name = &sockaddr,
+            .msg_namelen = _pnet_WriteSockaddr(&datagrams[i].host, &sockaddr),
+            .msg_iov = iovecs,
+            .msg_iovlen = datagrams[i].tail_size > 0 ? 2 : 1,
+        };
+        ssize_t status = sendmsg(socket->fd, &header, MSG_DONTWAIT);
+        if (status < 0) {
+            if (i == 0) {
+                *sent = 0;
+                return errno;
+            }
+            break;
+        }
+    }
+    *sent = i;
+    return ERR_NONE;
+}
+
+/*
+ * Receives datagrams one at a time until `count` are received or no more are
+ * available. The size of each received datagram not fitting inside its buffer
+ * is set to 0. If no datagram could be received, the error preventing it is
+ * returned.
+ */
+err_t _pnet_ReceiveDatagrams(_pnet_Socket *socket, _pnet_Datagram *datagrams,
+                             size_t count, size_t *received) {
+    assert(socket != NULL);
+    assert(datagrams != NULL);
+    assert(received != NULL);
+
+    size_t i;
+    for (i = 0; i < count; ++i) {
+        struct sockaddr_storage sockaddr;
+        socklen_t socklen = sizeof(struct sockaddr_storage);
+        ssize_t status = recvfrom(socket->fd, datagrams[i].data, datagrams[i].size,
+                                  MSG_DONTWAIT | MSG_TRUNC,
+                                  (struct sockaddr *) &sockaddr, &socklen);
+        if (status < 0) {
+            if (i == 0) {
+                *received = 0;
+                return errno;
+            }
+            break;
+        }
+        _pnet_ReadSockaddr(&sockaddr, PNET_TRANSPORT_UDP, &datagrams[i].host);
+        datagrams[i].size = (size_t) status <= datagrams[i].size
+            ? (size_t) status
+            : 0;
+    }
+    *received = i;
+    return ERR_NONE;
+}
+
+#endif
+
+/*
+ * IPv4 hosts are mapped to IPv4-mapped IPv6 addresses if `internet` is IPv6,
+ * as dual-stack IPv6 sockets can reach IPv4 hosts only via such addresses.
+ * IPv6 hosts cannot be reached via IPv4 sockets.
+ */
+bool _pnet_MapHost(const pnet_Host *host, uint8_t internet, pnet_Host *out) {
+    assert(host != NULL);
+    assert(out != NULL);
+
+    if (host->internet == internet) {
+        *out = *host;
+        return true;
+    }
+    if (host->internet != PNET_INTERNET_IPV4 || internet != PNET_INTERNET_IPV6) {
+        return false;
+    }
+    *out = (pnet_Host) {
+        .internet = PNET_INTERNET_IPV6,
+        .transport = host->transport,
+        .address = {[10] = 0xFF, [11] = 0xFF},
+        .port = host->port,
+    };
+    memcpy(&out->address[12], host->address, 4);
+    return true;
+}
+
+socklen_t _pnet_WriteSockaddr(const pnet_Host *host, struct sockaddr_storage *out) {
+    memset(out, 0, sizeof(struct sockaddr_storage));
+    switch (host->internet) {
+    case PNET_INTERNET_IPV4: {
+        struct sockaddr_in *ipv4 = (struct sockaddr_in *) out;
+        ipv4->sin_family = AF_INET;
+        memcpy(&ipv4->sin_addr, host->address, 4);
+        ipv4->sin_port = htons(host->port);
+        return sizeof(struct sockaddr_in);
+    }
+    case PNET_INTERNET_IPV6: {
+        struct sockaddr_in6 *ipv6 = (struct sockaddr_in6 *) out;
+        ipv6->sin6_family = AF_INET6;
+        memcpy(&ipv6->sin6_addr, host->address, 16);
+        ipv6->sin6_port = htons(host->port);
+        return sizeof(struct sockaddr_in6);
+    }
+    default:
+        return 0;
+    }
+}
+
+/*
+ * IPv4-mapped IPv6 addresses, as reported for IPv4 peers of dual-stack IPv6
+ * sockets, are read as plain IPv4 addresses.
+ */
+void _pnet_ReadSockaddr(const struct sockaddr_storage *sockaddr, uint8_t transport,
+                        pnet_Host *out) {
+    *out = (pnet_Host) {.transport = transport};
+    switch (sockaddr->ss_family) {
+    case AF_INET: {
+        const struct sockaddr_in *ipv4 = (const struct sockaddr_in *) sockaddr;
+        out->internet = PNET_INTERNET_IPV4;
+        memcpy(out->address, &ipv4->sin_addr, 4);
+        out->port = ntohs(ipv4->sin_port);
+        break;
+    }
+    case AF_INET6: {
+        const struct sockaddr_in6 *ipv6 = (const struct sockaddr_in6 *) sockaddr;
+        if (IN6_IS_ADDR_V4MAPPED(&ipv6->sin6_addr)) {
+            out->internet = PNET_INTERNET_IPV4;
+            memcpy(out->address, &ipv6->sin6_addr.s6_addr[12], 4);
+        }
+        else {
+            out->internet = PNET_INTERNET_IPV6;
+            memcpy(out->address, &ipv6->sin6_addr, 16);
+        }
+        out->port = ntohs(ipv6->sin6_port);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 #else
 #error No supported internal PNET socket implementation.
 #endif
\ No newline at end of file
@@ -2,10 +2,25 @@
 #define KDT_PNET_INTERNAL_SOCKET_H
 
 #include "../host.h"
+#include <kdt/def.h>
 #include <kdt/err.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#ifdef KDT_USE_POSIX
+#include <sys/socket.h>
+#endif
+
+/**
+ * The largest number of buffers sent together by a single `_pnet_Send()`.
+ *
+ * Each of up to KDT_N_GATHER messages is sent from at most two buffers, one
+ * holding a header and the other message payload.
+ */
+#define _PNET_SEND_BUFFERS (2 * KDT_N_GATHER)
+
+typedef struct _pnet_Buffer _pnet_Buffer;
+typedef struct _pnet_Datagram _pnet_Datagram;
 typedef struct _pnet_Socket _pnet_Socket;
 
 struct _pnet_Socket {
@@ -15,6 +30,37 @@ struct _pnet_Socket {
 #endif
 };
 
+/**
+ * A range of bytes to be sent.
+ */
+struct _pnet_Buffer {
+    /// First byte of range.
+    const uint8_t *data;
+
+    /// Size of range, in bytes.
+    size_t size;
+};
+
+/**
+ * A datagram to be sent or received via a datagram socket.
+ */
+struct _pnet_Datagram {
+    /// Host datagram is sent to, or was received from.
+    pnet_Host host;
+
+    /// Datagram bytes, or buffer to receive datagram into.
+    uint8_t *data;
+
+    /// Size of datagram, or of buffer until a datagram has been received.
+    size_t size;
+
+    /// Bytes sent immediately after those of `data`, if any. Not received into.
+    const uint8_t *tail;
+
+    /// Size of `tail`, in bytes.
+    size_t tail_size;
+};
+
 static const _pnet_Socket SOCKET_EMPTY =
 #ifdef KDT_USE_POSIX
     {.fd = -1};
@@ -23,7 +69,21 @@ static const _pnet_Socket SOCKET_EMPTY =
 #endif
 
 bool _pnet_IsSocketEmpty(const _pnet_Socket *socket);
-err_t _pnet_Send(_pnet_Socket *socket, size_t *size, uint8_t *data);
+bool _pnet_IsSocketEqual(const _pnet_Socket *a, const _pnet_Socket *b);
+err_t _pnet_GetSocketError(const _pnet_Socket *socket);
+err_t _pnet_Send(_pnet_Socket *socket, const _pnet_Buffer *buffers, size_t count,
+                 size_t *sent);
 err_t _pnet_Receive(_pnet_Socket *socket, size_t *size, uint8_t *out);
+err_t _pnet_SendDatagrams(_pnet_Socket *socket, _pnet_Datagram *datagrams,
+                          size_t count, size_t *sent);
+err_t _pnet_ReceiveDatagrams(_pnet_Socket *socket, _pnet_Datagram *datagrams,
+                             size_t count, size_t *received);
+bool _pnet_MapHost(const pnet_Host *host, uint8_t internet, pnet_Host *out);
+
+#ifdef KDT_USE_POSIX
+socklen_t _pnet_WriteSockaddr(const pnet_Host *host, struct sockaddr_storage *out);
+void _pnet_ReadSockaddr(const struct sockaddr_storage *sockaddr, uint8_t transport,
+                        pnet_Host *out);
+#endif
 
 #endif
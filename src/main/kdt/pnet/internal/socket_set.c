@@ -1,7 +1,74 @@
 #include "socket_set.h"
+#include "server.h"
 #include "socket.h"
 
-#ifdef KDT_USE_POSIX
+#if defined(KDT_USE_EPOLL)
+
+inline
+void _pnet_ClearSocket(_pnet_SocketSet *set, _pnet_Socket *socket) {
+    set->server->fd_flags[socket->fd] &= ~set->flag;
+}
+
+inline
+bool _pnet_IsSocketReady(_pnet_SocketSet *set, _pnet_Socket *socket) {
+    return (set->server->fd_flags[socket->fd] & set->flag) != 0;
+}
+
+/*
+ * Only sockets reported as readable by epoll_wait(), and not yet cleared, are
+ * visited. As readiness is edge-triggered, sockets not consumed by `callback`
+ * are kept in the server ready list until some later call.
+ */
+void _pnet_ForEachReadySocket(_pnet_SocketSet *set, bool *accept, void *data,
+                              bool (*callback)(void *, _pnet_Socket *)) {
+    _pnet_Server *server = set->server;
+    bool consume = true;
+    size_t kept = 0;
+
+    *accept = false;
+    for (size_t i = 0; i < server->fd_ready_count; ++i) {
+        const int fd = server->fd_ready[i];
+        uint8_t *flags = &server->fd_flags[fd];
+        if ((*flags & _PNET_SOCKET_READABLE) == 0) {
+            continue;
+        }
+        if (fd == server->fd) {
+            *flags &= ~_PNET_SOCKET_READABLE;
+            *accept = true;
+            continue;
+        }
+        if (consume) {
+            *flags &= ~_PNET_SOCKET_READABLE;
+            if (callback(data, &(_pnet_Socket) {.fd = fd})) {
+                continue;
+            }
+            *flags |= _PNET_SOCKET_READABLE;
+            consume = false;
+        }
+        server->fd_ready[kept++] = fd;
+    }
+    server->fd_ready_count = kept;
+}
+
+/*
+ * Only sockets that became writable since the last call, and are still
+ * writable, are visited. Sockets becoming writable again after having been
+ * cleared are visited again.
+ */
+void _pnet_ForEachWritableSocket(_pnet_SocketSet *set, void *data,
+                                 void (*callback)(void *, _pnet_Socket *)) {
+    _pnet_Server *server = set->server;
+
+    for (size_t i = 0; i < server->fd_writable_count; ++i) {
+        const int fd = server->fd_writable[i];
+        if ((server->fd_flags[fd] & _PNET_SOCKET_WRITABLE) != 0) {
+            callback(data, &(_pnet_Socket) {.fd = fd});
+        }
+    }
+    server->fd_writable_count = 0;
+}
+
+#elif defined(KDT_USE_POSIX)
 
 inline
 void _pnet_ClearSocket(_pnet_SocketSet *set, _pnet_Socket *socket) {
@@ -19,7 +86,7 @@ void _pnet_ForEachReadySocket(_pnet_SocketSet *set, bool *accept, void *data,
                               bool (*callback)(void *, _pnet_Socket *)) {
     *accept = false;
     for (int fd = 0; fd <= set->fd_max && set->fd_count > 0; ++fd) {
-        if (FD_ISSET(fd, &set->fd_set)) {
+        if (!FD_ISSET(fd, &set->fd_set)) {
             continue;
         }
         set->fd_count -= 1;
@@ -33,7 +100,21 @@ void _pnet_ForEachReadySocket(_pnet_SocketSet *set, bool *accept, void *data,
     }
 }
 
+inline
+void _pnet_ForEachWritableSocket(_pnet_SocketSet *set, void *data,
+                                 void (*callback)(void *, _pnet_Socket *)) {
+    int count = set->fd_count;
+    for (int fd = 0; fd <= set->fd_max && count > 0; ++fd) {
+        if (!FD_ISSET(fd, &set->fd_set)) {
+            continue;
+        }
+        count -= 1;
+        if (fd != set->fd_server) {
+            callback(data, &(_pnet_Socket) {.fd = fd});
+        }
+    }
+}
+
 #else
 #error No supported internal PNET socket set implementation.
 #endif
-
@@ -2,16 +2,41 @@
 #define KDT_PNET_INTERNAL_SOCKET_SET_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef KDT_USE_POSIX
+#ifndef KDT_USE_EPOLL
 #include <sys/select.h>
 #endif
+#endif
 
+typedef struct _pnet_Server _pnet_Server;
 typedef struct _pnet_Socket _pnet_Socket;
 typedef struct _pnet_SocketSet _pnet_SocketSet;
 
+#ifdef KDT_USE_EPOLL
+/**
+ * Socket registration and readiness flags, as stored in `_pnet_Server`.
+ *
+ * As sockets are registered in edge-triggered mode, a socket is considered
+ * ready from the moment it is reported as such until it is cleared via
+ * `_pnet_ClearSocket()`.
+ */
+enum {
+    _PNET_SOCKET_OPEN = 0x01,
+    _PNET_SOCKET_READABLE = 0x02,
+    _PNET_SOCKET_WRITABLE = 0x04,
+};
+#endif
+
 struct _pnet_SocketSet {
-#ifdef KDT_USE_POSIX
+#ifdef KDT_USE_EPOLL
+    /// Server owning the readiness state of all sockets.
+    _pnet_Server *server;
+
+    /// Readiness flag, `_PNET_SOCKET_READABLE` or `_PNET_SOCKET_WRITABLE`.
+    uint8_t flag;
+#elif defined(KDT_USE_POSIX)
     int fd_server;
     int fd_count;
     fd_set fd_set;
@@ -23,5 +48,7 @@ void _pnet_ClearSocket(_pnet_SocketSet *set, _pnet_Socket *socket);
 bool _pnet_IsSocketReady(_pnet_SocketSet *set, _pnet_Socket *socket);
 void _pnet_ForEachReadySocket(_pnet_SocketSet *set, bool *accept, void *data,
                               bool (*callback)(void *, _pnet_Socket *));
+void _pnet_ForEachWritableSocket(_pnet_SocketSet *set, void *data,
+                                 void (*callback)(void *, _pnet_Socket *));
 
 #endif
@@ -0,0 +1,142 @@
+#include "uring.h"
+
+#ifdef KDT_USE_IO_URING
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+err_t _pnet_InitRing(_pnet_Ring *ring, unsigned entries) {
+    assert(ring != NULL);
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return errno;
+    }
+
+    err_t err = ERR_NONE;
+
+    ring->fd = fd;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes +
+                         params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        err = errno;
+        goto leave_close;
+    }
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        ring->cq_ring = ring->sq_ring;
+    }
+    else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            err = errno;
+            goto leave_unmap_sq;
+        }
+    }
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        err = errno;
+        goto leave_unmap_cq;
+    }
+
+    uint8_t *sq = ring->sq_ring;
+    ring->sq_head = (unsigned *) &sq[params.sq_off.head];
+    ring->sq_tail = (unsigned *) &sq[params.sq_off.tail];
+    ring->sq_mask = (unsigned *) &sq[params.sq_off.ring_mask];
+    ring->sq_array = (unsigned *) &sq[params.sq_off.array];
+
+    uint8_t *cq = ring->cq_ring;
+    ring->cq_head = (unsigned *) &cq[params.cq_off.head];
+    ring->cq_tail = (unsigned *) &cq[params.cq_off.tail];
+    ring->cq_mask = (unsigned *) &cq[params.cq_off.ring_mask];
+    ring->cqes = (struct io_uring_cqe *) &cq[params.cq_off.cqes];
+
+    return ERR_NONE;
+
+leave_unmap_cq:
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+
+leave_unmap_sq:
+    munmap(ring->sq_ring, ring->sq_ring_size);
+
+leave_close:
+    close(fd);
+    return err;
+}
+
+void _pnet_TermRing(_pnet_Ring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+struct io_uring_sqe *_pnet_GetRingSQE(_pnet_Ring *ring) {
+    const unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    const unsigned tail = *ring->sq_tail;
+    if (tail - head > *ring->sq_mask) {
+        return NULL;
+    }
+    const unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+err_t _pnet_SubmitRing(_pnet_Ring *ring, unsigned submit, unsigned wait) {
+    const unsigned flags = wait > 0 ? IORING_ENTER_GETEVENTS : 0;
+    do {
+        int status = (int) syscall(__NR_io_uring_enter, ring->fd, submit, wait,
+                                   flags, NULL, 0);
+        if (status < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (status == 0 && submit > 0) {
+            return EAGAIN;
+        }
+        submit -= (unsigned) status;
+    } while (submit > 0);
+    return ERR_NONE;
+}
+
+bool _pnet_PopRingCQE(_pnet_Ring *ring, uint64_t *user_data, int32_t *res) {
+    const unsigned head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef KDT_PNET_INTERNAL_URING_H
+#define KDT_PNET_INTERNAL_URING_H
+
+#include <kdt/err.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef KDT_USE_IO_URING
+#include <linux/io_uring.h>
+
+typedef struct _pnet_Ring _pnet_Ring;
+
+/**
+ * A minimal io_uring submission/completion queue pair.
+ *
+ * Only the subset of io_uring functionality required by `_pnet_Batch` is
+ * provided, which is why the raw system calls are used rather than liburing.
+ */
+struct _pnet_Ring {
+    /// io_uring file descriptor.
+    int fd;
+
+    /// Submission queue ring pointers.
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+
+    /// Submission queue entries.
+    struct io_uring_sqe *sqes;
+
+    /// Completion queue ring pointers.
+    unsigned *cq_head, *cq_tail, *cq_mask;
+
+    /// Completion queue entries.
+    struct io_uring_cqe *cqes;
+
+    /// Mapped memory regions, and their sizes.
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+};
+
+err_t _pnet_InitRing(_pnet_Ring *ring, unsigned entries);
+void _pnet_TermRing(_pnet_Ring *ring);
+struct io_uring_sqe *_pnet_GetRingSQE(_pnet_Ring *ring);
+err_t _pnet_SubmitRing(_pnet_Ring *ring, unsigned submit, unsigned wait);
+bool _pnet_PopRingCQE(_pnet_Ring *ring, uint64_t *user_data, int32_t *res);
+
+#endif
+
+#endif
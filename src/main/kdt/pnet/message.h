@@ -7,8 +7,28 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * The largest valid message tag.
+ */
+#define PNET_TAG_MAX 0x7FFF
+
+/**
+ * Outbound message priorities.
+ */
+enum {
+    PNET_PRIORITY_NORMAL = (uint8_t) 0,
+    PNET_PRIORITY_HIGH,
+    PNET_PRIORITY_LOW,
+};
+
 typedef struct pnet_Message pnet_Message;
 
+/**
+ * Function invoked with arbitrary `context` when memory lent to an outbound
+ * message is no longer used by it.
+ */
+typedef void (*pnet_OnRelease)(void *context);
+
 /**
  * An outbound peer-to-peer network message.
  */
@@ -36,6 +56,17 @@ struct pnet_Message {
      */
     uint16_t tag;
 
+    /**
+     * Message priority, relative to other queued outbound messages.
+     *
+     * Messages of each priority are queued separately, and the queues are
+     * drained by weighted round-robin, as given by KDT_N_WEIGHT_HIGH,
+     * KDT_N_WEIGHT_NORMAL and KDT_N_WEIGHT_LOW. Messages are sent in the order
+     * they were queued only if they are of the same priority. Defaults to
+     * PNET_PRIORITY_NORMAL.
+     */
+    uint8_t priority;
+
     /**
      * Message payload data.
      */
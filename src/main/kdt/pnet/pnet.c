@@ -2,24 +2,83 @@
 #include <assert.h>
 #include <errno.h>
 #include <kdt/bitset.h>
-#include <kdt/cbuf.h>
 #include <kdt/def.h>
 #include <kdt/log.h>
 
 static
 void OnServerError(_pnet_Error *error, void *data);
 
+static
+void OnServerReply(const kint_t *nonce, const pnet_Host *host, void *data);
+
+static
+pnet_t *GetOwnerShard(pnet_t *pnet, const pnet_Host *host);
+
+static
+err_t SendAndReceive(pnet_t *pnet);
+
+static
+err_t WaitSendAndReceive(pnet_t *pnet, park_t *park, unsigned ticket,
+                         tims_t timeout);
+
+static
+void LeaveCriticalRegion(pnet_t *pnet);
+
+static
+err_t WaitForSender(pnet_t *pnet, tims_t timeout, err_t (*attempt)(void *),
+                    void *context);
+
+static
+err_t TrySend(void *context);
+
+static
+err_t TryNewMessage(void *context);
+
+inline
 err_t pnet_Open(pnet_t *pnet, pnet_Host *interface) {
-    _pnet_OnError on_error = {
-        .callback = OnServerError,
-        .data = pnet,
-    };
-    err_t err;
-    if ((err = _pnet_Open(&pnet->server, interface, on_error)) != ERR_NONE) {
-        return err;
+    return pnet_OpenShards(pnet, 1, interface);
+}
+
+inline
+err_t pnet_OpenShards(pnet_t *shards, size_t count, pnet_Host *interface) {
+    return pnet_OpenShardsWithProfile(shards, count, interface, NULL);
+}
+
+/*
+ * Shards are opened in order, which means that the first shard determines
+ * what port is used by all shards, if not specified by `interface`.
+ */
+err_t pnet_OpenShardsWithProfile(pnet_t *shards, size_t count, pnet_Host *interface,
+                                 const pnet_Profile *profile) {
+    assert(shards != NULL);
+    assert(count > 0);
+
+    const pnet_Profile defaults = {0};
+    if (profile == NULL) {
+        profile = &defaults;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        pnet_t *pnet = &shards[i];
+        _pnet_OnError on_error = {
+            .callback = OnServerError,
+            .data = pnet,
+        };
+        _pnet_OnReply on_reply = {
+            .callback = OnServerReply,
+            .data = pnet,
+        };
+        err_t err = _pnet_Open(&pnet->server, interface, profile, count > 1, on_error,
+                               on_reply);
+        if (err != ERR_NONE) {
+            pnet_CloseShards(shards, i);
+            return err;
+        }
+        _pnet_InitSender(&pnet->sender);
+        _pnet_InitReceiver(&pnet->receiver);
+        pnet->shards = shards;
+        pnet->shard_count = count;
     }
-    _pnet_InitSender(&pnet->sender);
-    _pnet_InitReceiver(&pnet->receiver);
     return ERR_NONE;
 }
 
@@ -28,11 +87,61 @@ void pnet_Close(pnet_t *pnet) {
     _pnet_Close(&pnet->server);
 }
 
+inline
+void pnet_CloseShards(pnet_t *shards, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        pnet_Close(&shards[i]);
+    }
+}
+
 inline
 const pnet_Host *pnet_GetInterface(pnet_t *pnet) {
     return pnet->server.interface;
 }
 
+inline
+tims_t pnet_EstimateTimeout(pnet_t *pnet, const pnet_Host *host) {
+    assert(host != NULL);
+
+    return _pnet_EstimateTimeout(&GetOwnerShard(pnet, host)->sender, host);
+}
+
+err_t pnet_GetRoundTripTime(pnet_t *pnet, const pnet_Host *host, tims_t *srtt,
+                            tims_t *rttvar) {
+    assert(host != NULL);
+    assert(srtt != NULL);
+    assert(rttvar != NULL);
+
+    if (!_pnet_GetRoundTrip(&GetOwnerShard(pnet, host)->sender, host, srtt, rttvar)) {
+        return ERR_NOT_FOUND;
+    }
+    return ERR_NONE;
+}
+
+inline
+err_t pnet_Poll(pnet_t *pnet, pnet_Event **out) {
+    assert(out != NULL);
+
+    size_t count;
+    err_t err = pnet_PollBatch(pnet, out, 1, &count);
+    if (err == ERR_NONE && count == 0) {
+        *out = NULL;
+    }
+    return err;
+}
+
+inline
+err_t pnet_PollWait(pnet_t *pnet, pnet_Event **out, tims_t timeout) {
+    assert(out != NULL);
+
+    size_t count;
+    err_t err = pnet_PollBatchWait(pnet, out, 1, &count, timeout);
+    if (err == ERR_NONE && count == 0) {
+        *out = NULL;
+    }
+    return err;
+}
+
 /*
  * The thread-safety of this function comes from its use of thread-safe queues
  * and never allowing more than one thread to poll the network interface for
@@ -43,100 +152,352 @@ const pnet_Host *pnet_GetInterface(pnet_t *pnet) {
  * sent and received. Any received messages, or errors, are put in the event
  * queue, while sent messages are taken from the outbound message queue and
  * transmitted. When exiting the critical region, a final attempt is made to
- * take an event from the event queue.
+ * take events from the event queue.
  *
  * If another thread calls the function while the first is still inside the
- * critical region, it will return either with an event taken from the queue,
+ * critical region, it will return either with events taken from the queue,
  * or with the admonition the try the function again later, if the queue was
  * empty.
  */
-err_t pnet_Poll(pnet_t *pnet, pnet_Event **out) {
-    err_t err;
-    _pnet_Event *event;
+err_t pnet_PollBatch(pnet_t *pnet, pnet_Event **events, size_t max, size_t *count) {
+    assert(events != NULL);
+    assert(max > 0);
+    assert(count != NULL);
 
-    // If there is a received but unhandled event, return one immediately.
-    if ((event = _pnet_PopReceivedEvent(&pnet->receiver)) != NULL) {
-        *out = &event->event;
+    // If there are received but unhandled events, return them immediately.
+    if ((*count = _pnet_PopReceivedEvents(&pnet->receiver, events, max)) != 0) {
         return ERR_NONE;
     }
 
     if (!mtx_TryLock(&pnet->lock)) {
         return ERR_TRY_AGAIN;
     }
-    {
-        // Send any pending outbound messages.
-        if ((err = _pnet_SendOutgoing(&pnet->sender, &pnet->server)) != ERR_NONE) {
-            goto leave_critical;
-        }
-
-        // Receive any pending inbound messages and accept incoming connections.
-        if ((err = _pnet_ReceiveIncoming(&pnet->receiver, &pnet->server)) != ERR_NONE) {
-            goto leave_critical;
-        }
-    }
-leave_critical:
-    mtx_Unlock(&pnet->lock);
+    err_t err = SendAndReceive(pnet);
+    LeaveCriticalRegion(pnet);
     if (err != ERR_NONE) {
         return err;
     }
 
-    // Try to claim an unhandled event, again.
-    if ((event = _pnet_PopReceivedEvent(&pnet->receiver)) != NULL) {
-        *out = &event->event;
-    }
-    else {
-        *out = NULL;
-    }
-
+    // Try to claim unhandled events, again.
+    *count = _pnet_PopReceivedEvents(&pnet->receiver, events, max);
     return ERR_NONE;
 }
 
-inline
+/*
+ * Works as `pnet_PollBatch()`, except for that threads finding the critical
+ * region occupied are parked until an event is pushed to the event queue, or
+ * the thread in the critical region leaves it. Every thread leaving the
+ * critical region wakes one parked thread, which then may enter it, making
+ * sure that the network is polled for as long as any thread is waiting. The
+ * thread in the critical region waits for socket activity, new outbound
+ * messages or event buffers being freed, unless any event is known to already
+ * be available.
+ */
+err_t pnet_PollBatchWait(pnet_t *pnet, pnet_Event **events, size_t max,
+                         size_t *count, tims_t timeout) {
+    assert(events != NULL);
+    assert(max > 0);
+    assert(count != NULL);
+
+    park_t *park = &pnet->receiver.park;
+    const tims_t deadline = tims_Now() + timeout;
+
+    for (tims_t remaining = timeout;; remaining = deadline - tims_Now()) {
+        const unsigned ticket = park_Prepare(park);
+
+        if ((*count = _pnet_PopReceivedEvents(&pnet->receiver, events, max)) != 0) {
+            return ERR_NONE;
+        }
+        if (remaining < 0.0) {
+            return ERR_NONE;
+        }
+        if (!mtx_TryLock(&pnet->lock)) {
+            park_Wait(park, ticket, remaining);
+            continue;
+        }
+        err_t err = WaitSendAndReceive(pnet, park, ticket, remaining);
+        LeaveCriticalRegion(pnet);
+        if (err != ERR_NONE) {
+            return err;
+        }
+    }
+}
+
 err_t pnet_Send(pnet_t *pnet, pnet_Message *message) {
     assert(message != NULL);
+    assert(message->tag <= PNET_TAG_MAX);
+    assert(message->priority <= PNET_PRIORITY_LOW);
 
     _pnet_Message *_message = _pnet_AsPrivateMessage(message);
-    if (!_pnet_PushMessage(&pnet->sender, _message)) {
-        return ENOMEM;
+    err_t err;
+
+    // Datagrams cannot be split into frames.
+    if (pnet->server.interface->transport == PNET_TRANSPORT_UDP &&
+        mem_Size(&message->data) + _message->attachment_size > _PNET_FRAME_SIZE) {
+        return ERR_TOO_LARGE;
     }
+
+    // Responses must be sent by the shard that received their requests.
+    if (!_message->is_response) {
+        pnet_t *owner = GetOwnerShard(pnet, &message->receiver);
+        if (owner != pnet) {
+            err = _pnet_HandOffMessage(&pnet->sender, &owner->sender, _message);
+            if (err != ERR_NONE) {
+                return err;
+            }
+            _pnet_Wake(&owner->server);
+            return ERR_NONE;
+        }
+    }
+
+    if ((err = _pnet_PushMessage(&pnet->sender, _message)) != ERR_NONE) {
+        return err;
+    }
+    _pnet_Wake(&pnet->server);
     return ERR_NONE;
 }
 
+typedef struct _SendContext _SendContext;
+
+struct _SendContext {
+    pnet_t *pnet;
+    pnet_Message *message;
+};
+
+/*
+ * Requests are waited for by the shard owning their receivers, as it is the
+ * one freeing the buffers and credits they may be waiting for.
+ */
+err_t pnet_SendWait(pnet_t *pnet, pnet_Message *message, tims_t timeout) {
+    assert(message != NULL);
+
+    pnet_t *owner = _pnet_AsPrivateMessage(message)->is_response
+        ? pnet
+        : GetOwnerShard(pnet, &message->receiver);
+
+    _SendContext context = {
+        .pnet = pnet,
+        .message = message,
+    };
+    return WaitForSender(owner, timeout, TrySend, &context);
+}
+
 inline
-pnet_Message *pnet_NewMessage(pnet_t *pnet) {
-    _pnet_Message *_message = _pnet_AllocateMessage(&pnet->sender);
+pnet_Message *pnet_NewMessage(pnet_t *pnet, size_t size) {
+    _pnet_Message *_message = _pnet_AllocateMessage(&pnet->sender, size);
     return _message != NULL ? &_message->message : NULL;
 }
 
+typedef struct _NewMessageContext _NewMessageContext;
+
+struct _NewMessageContext {
+    pnet_t *pnet;
+    size_t size;
+    pnet_Message *message;
+};
+
+pnet_Message *pnet_NewMessageWait(pnet_t *pnet, size_t size, tims_t timeout) {
+    if (size > _PNET_FRAME_SIZE) {
+        return NULL;
+    }
+    _NewMessageContext context = {
+        .pnet = pnet,
+        .size = size,
+        .message = NULL,
+    };
+    WaitForSender(pnet, timeout, TryNewMessage, &context);
+    return context.message;
+}
+
 inline
-pnet_Message *pnet_NewResponse(pnet_t *pnet, pnet_EventMessage *request) {
+pnet_Message *pnet_NewResponse(pnet_t *pnet, pnet_EventMessage *request, size_t size) {
     assert(request != NULL);
 
     _pnet_Event *_event = _pnet_AsPrivateEvent(_pnet_AsPublicEvent(request));
-    _pnet_Message *_message = _pnet_AllocateMessage(&pnet->sender);
+    _pnet_Message *_message = _pnet_AllocateMessage(&pnet->sender, size);
     if (_message == NULL) {
         return NULL;
     }
+    _message->message.receiver = request->sender;
     _message->socket = _event->socket;
-    _event->socket = SOCKET_EMPTY; // Prevent socket from being closed when event is freed.
+    _message->is_response = true;
     return &_message->message;
 }
 
+err_t pnet_AttachPayload(pnet_t *pnet, pnet_Message *message, const uint8_t *data,
+                         size_t size, pnet_OnRelease release, void *context) {
+    assert(message != NULL);
+    assert(data != NULL || size == 0);
+    (void) pnet;
+
+    _pnet_Message *_message = _pnet_AsPrivateMessage(message);
+    assert(_message->attachment == NULL);
+
+    _message->attachment = data;
+    _message->attachment_size = size;
+    _message->attachment_release = release;
+    _message->attachment_context = context;
+    return ERR_NONE;
+}
+
 inline
 void pnet_FreeEvent(pnet_t *pnet, pnet_Event *event) {
+    pnet_ReleaseEvent(pnet, event);
+}
+
+inline
+void pnet_RetainEvent(pnet_t *pnet, pnet_Event *event) {
+    assert(event != NULL);
+    (void) pnet;
+
+    _pnet_RetainEvent(_pnet_AsPrivateEvent(event));
+}
+
+void pnet_ReleaseEvent(pnet_t *pnet, pnet_Event *event) {
     assert(event != NULL);
 
-    _pnet_FreeEvent(&pnet->receiver, _pnet_AsPrivateEvent(event));
-    _pnet_Event *_event = _pnet_AsPrivateEvent(event);
-    if (!_pnet_IsSocketEmpty(&_event->socket)) {
-        _pnet_CloseSocket(&pnet->server, &_event->socket);
+    if (!_pnet_ReleaseEvent(&pnet->receiver, _pnet_AsPrivateEvent(event))) {
+        return;
+    }
+
+    // Receiving may have been held back until some event buffer was freed.
+    if (atomic_load(&pnet->receiver.stalled)) {
+        _pnet_Wake(&pnet->server);
+    }
+}
+
+void pnet_FreeEvents(pnet_t *pnet, pnet_Event **events, size_t count) {
+    assert(events != NULL || count == 0);
+
+    if (!_pnet_ReleaseEvents(&pnet->receiver, events, count)) {
+        return;
+    }
+
+    // Receiving may have been held back until some event buffer was freed.
+    if (atomic_load(&pnet->receiver.stalled)) {
+        _pnet_Wake(&pnet->server);
+    }
+}
+
+/*
+ * Must only be called from within the critical region.
+ */
+static
+err_t SendAndReceive(pnet_t *pnet) {
+    err_t err;
+
+    // Send any pending outbound messages.
+    if ((err = _pnet_SendOutgoing(&pnet->sender, &pnet->server)) != ERR_NONE) {
+        return err;
     }
+
+    // Receive any pending inbound messages and accept incoming connections.
+    return _pnet_ReceiveIncoming(&pnet->receiver, &pnet->server);
+}
+
+/*
+ * Must only be called from within the critical region. Waits for at most
+ * `timeout` seconds, and not at all if the sequence of `park` no longer
+ * matches `ticket`, which means that it was woken after it was acquired. If
+ * messages were requeued or receiving was held back, the wait is limited to
+ * KDT_T_WAIT_PENDING seconds, as neither condition is signalled by sockets.
+ * The wait never lasts beyond the expiry of the first sender or receiver timer.
+ */
+static
+err_t WaitSendAndReceive(pnet_t *pnet, park_t *park, unsigned ticket,
+                         tims_t timeout) {
+    err_t err;
+
+    const unsigned wake_ticket = _pnet_PrepareWait(&pnet->server);
+    if ((err = SendAndReceive(pnet)) != ERR_NONE) {
+        return err;
+    }
+    if (timeout <= 0.0 || park_Prepare(park) != ticket) {
+        return ERR_NONE;
+    }
+    if ((pnet->sender.requeued_count > 0 || atomic_load(&pnet->receiver.stalled) ||
+         pnet->server.accepts_pending) && timeout > KDT_T_WAIT_PENDING) {
+        timeout = KDT_T_WAIT_PENDING;
+    }
+    tims_t next;
+    if (wheel_Next(&pnet->sender.wheel, &next) &&
+        (next -= tims_Now()) < timeout) {
+        timeout = next;
+    }
+    if (wheel_Next(&pnet->receiver.wheel, &next) &&
+        (next -= tims_Now()) < timeout) {
+        timeout = next;
+    }
+    if ((err = _pnet_Wait(&pnet->server, wake_ticket, timeout)) != ERR_NONE) {
+        return err;
+    }
+    return SendAndReceive(pnet);
+}
+
+/*
+ * One thread parked waiting for events, and one waiting for outbound buffers or
+ * credits, is woken, as the network may need to be polled for either to make
+ * progress.
+ */
+static
+void LeaveCriticalRegion(pnet_t *pnet) {
+    mtx_Unlock(&pnet->lock);
+    park_WakeOne(&pnet->receiver.park);
+    park_WakeOne(&pnet->sender.park);
+}
+
+/*
+ * Calls `attempt` until it returns anything but ERR_TRY_AGAIN, or `timeout`
+ * seconds have passed. As outbound buffers and credits are only freed while
+ * messages are sent, the calling thread sends and receives itself whenever it
+ * is able to enter the critical region, and is otherwise parked until any
+ * buffer or credit is freed, or the critical region is left.
+ */
+static
+err_t WaitForSender(pnet_t *pnet, tims_t timeout, err_t (*attempt)(void *),
+                    void *context) {
+    park_t *park = &pnet->sender.park;
+    const tims_t deadline = tims_Now() + timeout;
+
+    for (tims_t remaining = timeout;; remaining = deadline - tims_Now()) {
+        const unsigned ticket = park_Prepare(park);
+
+        err_t err = attempt(context);
+        if (err != ERR_TRY_AGAIN) {
+            return err;
+        }
+        if (remaining < 0.0) {
+            return ERR_TIMEOUT;
+        }
+        if (!mtx_TryLock(&pnet->lock)) {
+            park_Wait(park, ticket, remaining);
+            continue;
+        }
+        err = WaitSendAndReceive(pnet, park, ticket, remaining);
+        LeaveCriticalRegion(pnet);
+        if (err != ERR_NONE) {
+            return err;
+        }
+    }
+}
+
+static
+err_t TrySend(void *context) {
+    _SendContext *_context = context;
+    return pnet_Send(_context->pnet, _context->message);
+}
+
+static
+err_t TryNewMessage(void *context) {
+    _NewMessageContext *_context = context;
+    _context->message = pnet_NewMessage(_context->pnet, _context->size);
+    return _context->message != NULL ? ERR_NONE : ERR_TRY_AGAIN;
 }
 
 static
 void OnServerError(_pnet_Error *error, void *data) {
     pnet_t *pnet = data;
-    _pnet_Event *event = _pnet_AllocateEvent(&pnet->receiver);
+    _pnet_Event *event = _pnet_AllocateEvent(&pnet->receiver, 0);
     if (event == NULL) {
         log_Warn("No receiver buffer is available for storing error event.");
         return;
@@ -149,4 +510,26 @@ void OnServerError(_pnet_Error *error, void *data) {
         .code = error->err,
     };
     _pnet_PushEvent(&pnet->receiver, event);
+}
+
+/*
+ * Messages from any given host may be received by any shard, while requests
+ * to it are only ever sent by the shard owning it. Only datagrams acknowledge
+ * sent messages.
+ */
+static
+void OnServerReply(const kint_t *nonce, const pnet_Host *host, void *data) {
+    pnet_t *pnet = GetOwnerShard(data, host);
+    _pnet_MeasureRoundTrip(&pnet->sender, nonce, host);
+    if (host->transport == PNET_TRANSPORT_UDP) {
+        _pnet_AcknowledgeMessage(&pnet->sender, nonce, host);
+    }
+}
+
+static
+pnet_t *GetOwnerShard(pnet_t *pnet, const pnet_Host *host) {
+    if (pnet->shard_count == 1) {
+        return pnet;
+    }
+    return &pnet->shards[pnet_HashHost(host) % pnet->shard_count];
 }
\ No newline at end of file
@@ -14,8 +14,10 @@
 #include "internal/sender.h"
 #include "internal/server.h"
 #include "message.h"
+#include "profile.h"
 #include <kdt/err.h>
 #include <kdt/mtx.h>
+#include <kdt/tims.h>
 #include <stdint.h>
 
 typedef struct pnet_t pnet_t;
@@ -35,6 +37,12 @@ struct pnet_t {
 
     /// Buffers for incoming messages.
     _pnet_Receiver receiver;
+
+    /// All shards of the same node, this one included.
+    pnet_t *shards;
+
+    /// Number of shards in `shards`.
+    size_t shard_count;
 };
 
 /**
@@ -55,10 +63,23 @@ struct pnet_t {
  * @note `net_Close()` must be called when no more messages will be sent or
  * received.
  *
- * @note On POSIX systems, the implementation relies on the `select()` call,
- * which means that there is a limit to how many sockets it can keep open at a
- * given time. If multiple `pnet_t` instances are opened at the same time,
- * there is an increased risk of running out of sockets.
+ * @note On POSIX systems, the implementation relies on either the `epoll()`
+ * or the `select()` call, depending on whether or not KDT_USE_EPOLL is
+ * defined. In the latter case, there is a limit to how many sockets can be
+ * kept open at a given time. If multiple `pnet_t` instances are opened at the
+ * same time, there is an increased risk of running out of sockets.
+ *
+ * @note If `{interface}->internet` is PNET_INTERNET_IPV6, IPv4 peers are
+ * accepted as well, provided that `{interface}->address` is either zeroed or
+ * an IPv4-mapped IPv6 address. Messages can be sent to peers of either
+ * internet protocol, except for if PNET_TRANSPORT_UDP is used, in which case
+ * peers can only be reached if they could also connect to the interface.
+ * Hosts reported in events are IPv4 hosts whenever the peers in question use
+ * IPv4.
+ *
+ * @note If `{interface}->transport` is PNET_TRANSPORT_UDP, messages are sent
+ * and received as datagrams, each of which must fit one complete message. If
+ * KDT_USE_MMSG is defined, datagrams are sent and received in batches.
  *
  * @note Not thread-safe.
  *
@@ -68,6 +89,56 @@ struct pnet_t {
  */
 err_t pnet_Open(pnet_t *pnet, pnet_Host *interface);
 
+/**
+ * Opens `count` PNET structures, or shards, all listening on the same network
+ * `interface` and port.
+ *
+ * Works as `pnet_Open()`, except for that every shard gets its own interface
+ * socket, sender and receiver, making it possible for each shard to be polled
+ * by its own threads without any lock being shared among them. The interface
+ * sockets are bound with SO_REUSEPORT, which makes the kernel distribute
+ * inbound connections and datagrams among the shards. Messages sent via any
+ * shard, except for responses, are handed off to the shard owning their
+ * receivers, as determined by `pnet_HashHost()`, which means that all requests
+ * sent to any one host share the same connection pool.
+ *
+ * @note `pnet_CloseShards()` must be called when no more messages will be sent
+ * or received.
+ *
+ * @note Only supported if KDT_USE_REUSEPORT is defined or `count` is 1. If not
+ * supported, ERR_NOT_COMPATIBLE is returned.
+ *
+ * @note Not thread-safe.
+ *
+ * @param shards Pointer to array of `count` uninitialized PNET structures.
+ * @param count Number of shards.
+ * @param interface Pointer to interface.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_OpenShards(pnet_t *shards, size_t count, pnet_Host *interface);
+
+/**
+ * Opens `count` PNET structures, or shards, as `pnet_OpenShards()`, applying
+ * the socket options of `profile` to every socket of every shard.
+ *
+ * @note `pnet_CloseShards()` must be called when no more messages will be sent
+ * or received.
+ *
+ * @note If `profile` requires an option not supported by the platform, such as
+ * TCP Fast Open without KDT_USE_TCP_FASTOPEN being defined, ERR_NOT_COMPATIBLE
+ * is returned.
+ *
+ * @note Not thread-safe.
+ *
+ * @param shards Pointer to array of `count` uninitialized PNET structures.
+ * @param count Number of shards.
+ * @param interface Pointer to interface.
+ * @param profile Pointer to socket profile, or NULL to use system defaults.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_OpenShardsWithProfile(pnet_t *shards, size_t count, pnet_Host *interface,
+                                 const pnet_Profile *profile);
+
 /**
  * Disables message sending and stops listening for incoming peer-to-peer
  * messages.
@@ -80,6 +151,16 @@ err_t pnet_Open(pnet_t *pnet, pnet_Host *interface);
  */
 void pnet_Close(pnet_t *pnet);
 
+/**
+ * Closes all shards opened via `pnet_OpenShards()`.
+ *
+ * @note Not thread-safe.
+ *
+ * @param shards Pointer to array of `count` initialized PNET structures.
+ * @param count Number of shards.
+ */
+void pnet_CloseShards(pnet_t *shards, size_t count);
+
 /**
  * Gets pointer to interface used to open peer-to-peer network.
  *
@@ -88,6 +169,44 @@ void pnet_Close(pnet_t *pnet);
  */
 const pnet_Host *pnet_GetInterface(pnet_t *pnet);
 
+/**
+ * Estimates the time after which a request sent to `host` can be considered
+ * lost, if no reply has yet been received.
+ *
+ * The estimate is the retransmission timeout of `host`, which is calculated
+ * from the round-trip times of requests sent to it, measured from when each
+ * request was sent to when the first message with the same nonce arrived from
+ * `host`. The timeout is KDT_T_RETRANSMIT until any round trip to `host` has
+ * been measured, and is otherwise kept between KDT_T_RTO_MIN and
+ * KDT_T_RTO_MAX. See also `pnet_GetRoundTripTime()`.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param host Pointer to host requests are sent to.
+ * @return Retransmission timeout, in seconds.
+ */
+tims_t pnet_EstimateTimeout(pnet_t *pnet, const pnet_Host *host);
+
+/**
+ * Gets smoothed round-trip time and round-trip time variation of `host`.
+ *
+ * Round-trip times are measured as described in `pnet_EstimateTimeout()`, and
+ * are smoothed as described in RFC 6298. Only a limited number of hosts are
+ * kept track of, which is why the estimates of hosts rarely sent requests to
+ * may be forgotten.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param host Pointer to host requests are sent to.
+ * @param srtt Receiver of smoothed round-trip time, in seconds.
+ * @param rttvar Receiver of round-trip time variation, in seconds.
+ * @return ERR_NONE, or ERR_NOT_FOUND if no round trip to `host` was measured.
+ */
+err_t pnet_GetRoundTripTime(pnet_t *pnet, const pnet_Host *host, tims_t *srtt,
+                            tims_t *rttvar);
+
 /**
  * Polls for one new inbound message, if any.
  *
@@ -112,14 +231,110 @@ const pnet_Host *pnet_GetInterface(pnet_t *pnet);
  */
 err_t pnet_Poll(pnet_t *pnet, pnet_Event **out);
 
+/**
+ * Waits at most `timeout` seconds for one new inbound message.
+ *
+ * Works as `pnet_Poll()`, except for that `out` is only set to NULL if no new
+ * inbound message became available before `timeout` passed, and that
+ * ERR_TRY_AGAIN is never returned. At most one of the threads calling this
+ * function waits for network activity at any given time, while the others
+ * are parked until being woken as soon as new events become available or the
+ * network must be polled by another thread.
+ *
+ * @note Every non-NULL pointer received from this function must be passed to
+ * `pnet_FreeEvent()` once no longer in use.
+ *
+ * @note Calling this function before invoking `pnet_Open()` or after invoking
+ * `pnet_Close()` causes undefined behavior.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param out Pointer to event.
+ * @param timeout Maximum time to wait, in seconds.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_PollWait(pnet_t *pnet, pnet_Event **out, tims_t timeout);
+
+/**
+ * Polls for up to `max` new inbound messages, if any.
+ *
+ * Works as `pnet_Poll()`, except for that all events available when called,
+ * up to `max`, are taken at once, and `count` is set to 0 rather than any
+ * event being set to NULL if no new inbound message is available. Taking many
+ * events at once is considerably cheaper than taking them one at a time,
+ * especially when many threads poll the same network.
+ *
+ * @note Every event received via this function must be passed to either
+ * `pnet_FreeEvent()` or `pnet_FreeEvents()` once no longer in use.
+ *
+ * @note Calling this function before invoking `pnet_Open()` or after invoking
+ * `pnet_Close()` causes undefined behavior.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param events Pointer to array able to hold at least `max` event pointers.
+ * @param max Maximum number of events to receive. Must be larger than 0.
+ * @param count Receiver of number of events written to `events`.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_PollBatch(pnet_t *pnet, pnet_Event **events, size_t max, size_t *count);
+
+/**
+ * Waits at most `timeout` seconds for up to `max` new inbound messages.
+ *
+ * Works as `pnet_PollWait()`, except for that all events available when any
+ * become available, up to `max`, are taken at once, as by `pnet_PollBatch()`.
+ *
+ * @note Every event received via this function must be passed to either
+ * `pnet_FreeEvent()` or `pnet_FreeEvents()` once no longer in use.
+ *
+ * @note Calling this function before invoking `pnet_Open()` or after invoking
+ * `pnet_Close()` causes undefined behavior.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param events Pointer to array able to hold at least `max` event pointers.
+ * @param max Maximum number of events to receive. Must be larger than 0.
+ * @param count Receiver of number of events written to `events`.
+ * @param timeout Maximum time to wait, in seconds.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_PollBatchWait(pnet_t *pnet, pnet_Event **events, size_t max,
+                         size_t *count, tims_t timeout);
+
 /**
  * Enqueues message for being sent to network peer.
  *
  * The `nonce` provided in `message` will be visible either to the message
  * receiver, or in any error generated if the message could not be delivered.
- * If the send buffer is full, the function returns ERR_TRY_AGAIN, which means
- * that the send operation may be successful if tried again after a call to
- * `pnet_Poll()`.
+ * Connections are kept open for a while after being used, which allows them to
+ * be reused if more messages are sent to the same receiver. At most
+ * KDT_N_POOL_HOST connections are kept open to any one receiver, any further
+ * messages being kept queued until connections become available.
+ * Queued messages of higher priority are sent before those of lower priority,
+ * without lower priority messages being starved, as described for the
+ * `priority` field of `pnet_Message`.
+ * If UDP is used, messages not created via `pnet_NewResponse()` are sent
+ * repeatedly, once every retransmission timeout of the receiver, until a
+ * message with the same `nonce` is received from the receiver, or the message
+ * times out. Receivers may therefore be given the same message more than once.
+ * Messages time out after KDT_N_RETRANSMIT retransmission timeouts, as given
+ * by `pnet_EstimateTimeout()`, plus the time it would take to send them at
+ * KDT_N_RECEIVE_RATE bytes per second. If TCP is used, messages are given
+ * another KDT_T_CONNECT seconds, and their clocks are restarted when they are
+ * given connections, as they may have had to wait for connections to be
+ * established or become available.
+ * If `pnet` is one of several shards, the message may be handed off to
+ * another shard, as described in `pnet_OpenShards()`.
+ * At most KDT_N_PEER_CREDITS messages not created via `pnet_NewResponse()`
+ * may be in flight to any one receiver, messages being in flight until sent,
+ * or, if using UDP, until acknowledged. If that many already are, or no buffer
+ * is available for handing the message off to another shard, the function
+ * returns ERR_TRY_AGAIN, which means that the send operation may be successful
+ * if tried again after a call to `pnet_Poll()`. See also `pnet_SendWait()`.
  *
  * @note The `message` pointer must have been acquired via a call to
  * `pnet_NewMessage()`, or this function may cause undefined behavior.
@@ -139,25 +354,75 @@ err_t pnet_Poll(pnet_t *pnet, pnet_Event **out);
  */
 err_t pnet_Send(pnet_t *pnet, pnet_Message *message);
 
+/**
+ * Enqueues message for being sent to network peer, waiting at most `timeout`
+ * seconds for the receiver to have credits available.
+ *
+ * Works as `pnet_Send()`, except for that ERR_TRY_AGAIN is never returned.
+ * Instead, the calling thread either polls the network itself, if no other
+ * thread is doing so, or is parked until in-flight messages are freed. If
+ * `timeout` passes before the message could be enqueued, ERR_TIMEOUT is
+ * returned and `message` is left in the possession of the caller.
+ *
+ * @note Events received while the calling thread polls the network are queued,
+ * and are taken by subsequent calls to `pnet_Poll()` or `pnet_PollWait()`.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param message Pointer to message structure.
+ * @param timeout Maximum time to wait, in seconds.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_SendWait(pnet_t *pnet, pnet_Message *message, tims_t timeout);
+
 /**
  * Allocates a free outbound message buffer.
  *
+ * The payload capacity of the returned message is at least `size` bytes, but
+ * may be larger. Messages are taken from a few pools of buffers of distinct
+ * sizes, which means that a small message may be allocated even if no buffer
+ * large enough for a maximum-size message is available.
+ *
  * @note Calling this function before invoking `pnet_Open()` or after invoking
  * `pnet_Close()` causes undefined behavior.
  *
  * @note Thread-safe.
  *
  * @param pnet Pointer to PNET structure.
+ * @param size Required message payload capacity, at most KDT_N_BUFFER_SIZE
+ * and less than 65536.
  * @return Pointer to allocated message buffer, or NULL if no is available.
  */
-pnet_Message *pnet_NewMessage(pnet_t *pnet);
+pnet_Message *pnet_NewMessage(pnet_t *pnet, size_t size);
+
+/**
+ * Allocates a free outbound message buffer, waiting at most `timeout` seconds
+ * for one to become available.
+ *
+ * Works as `pnet_NewMessage()`, except for that the calling thread waits as
+ * described in `pnet_SendWait()` while no buffer is available.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure.
+ * @param size Required message payload capacity, at most KDT_N_BUFFER_SIZE
+ * and less than 65536.
+ * @param timeout Maximum time to wait, in seconds.
+ * @return Pointer to allocated message buffer, or NULL if none became
+ * available.
+ */
+pnet_Message *pnet_NewMessageWait(pnet_t *pnet, size_t size, tims_t timeout);
 
 /**
  * Allocates a free outbound message buffer, intended to contain a reply to
  * given `request`.
  *
- * The difference between this function and `pnet_NewMessage()` is that it
- * may try to optimize by keeping sockets open, or similar.
+ * The difference between this function and `pnet_NewMessage()` is that the
+ * response is sent via the connection the request was received through, if it
+ * is still open. The message receiver is set to the request sender. If UDP is
+ * used, the response is sent only once, and should be given the `nonce` of the
+ * request, which makes it acknowledge the request.
  *
  * @note Calling this function before invoking `pnet_Open()` or after invoking
  * `pnet_Close()` causes undefined behavior.
@@ -166,13 +431,53 @@ pnet_Message *pnet_NewMessage(pnet_t *pnet);
  *
  * @param pnet Pointer to PNET structure.
  * @param request Pointer to inbound message.
+ * @param size Required message payload capacity, at most KDT_N_BUFFER_SIZE
+ * and less than 65536.
  * @return Pointer to allocated message buffer, of NULL if no is available.
  */
-pnet_Message *pnet_NewResponse(pnet_t *pnet, pnet_EventMessage *request);
+pnet_Message *pnet_NewResponse(pnet_t *pnet, pnet_EventMessage *request, size_t size);
+
+/**
+ * Attaches `size` bytes at `data` to the payload of `message`, without copying
+ * them.
+ *
+ * The attached bytes are sent after all bytes written to `{message}->data`,
+ * directly from `data`, via vectored writes. This makes it possible to send
+ * large payloads kept elsewhere, such as values viewed via `kvs_GetView()`,
+ * without first copying them into message buffers. The memory at `data` must
+ * remain valid and unchanged until `release`, if not NULL, is invoked with
+ * `context`, which happens when `message` is freed after having been sent,
+ * or after it failed to be sent. If `message` is sent as a datagram, it may be
+ * sent again until acknowledged, and the memory is held on to until then.
+ *
+ * Payloads not fitting in a single message buffer are sent as sequences of
+ * messages, all via the same connection, and are received as described in
+ * `pnet_EventMessage`. Datagrams cannot be sent this way, which is why sending
+ * `message` via UDP fails with ERR_TOO_LARGE if its payload would exceed
+ * KDT_N_BUFFER_SIZE or 65535 bytes, whichever is smaller.
+ *
+ * @note At most one payload may be attached to each message. `release` is not
+ * invoked if the message is never sent.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure `message` was allocated via.
+ * @param message Pointer to message structure.
+ * @param data Pointer to first byte of attached payload.
+ * @param size Size of attached payload, in bytes.
+ * @param release Function invoked when `data` is no longer used, or NULL.
+ * @param context Arbitrary data passed on to `release`.
+ * @return ERR_NONE only if operation was successful.
+ */
+err_t pnet_AttachPayload(pnet_t *pnet, pnet_Message *message, const uint8_t *data,
+                         size_t size, pnet_OnRelease release, void *context);
 
 /**
  * Frees inbound message no longer in use.
  *
+ * Equivalent to `pnet_ReleaseEvent()`. The event is only freed if no other
+ * references to it were acquired via `pnet_RetainEvent()`.
+ *
  * @note The `message` pointer must have been previously received via
  * `pnet_Poll()`.
  *
@@ -186,4 +491,50 @@ pnet_Message *pnet_NewResponse(pnet_t *pnet, pnet_EventMessage *request);
  */
 void pnet_FreeEvent(pnet_t *pnet, pnet_Event *event);
 
+/**
+ * Frees `count` inbound messages no longer in use.
+ *
+ * Works as calling `pnet_FreeEvent()` once per event, except for that the
+ * buffers of the freed events are returned together, which is cheaper.
+ *
+ * @note Calling this function before invoking `pnet_Open()` or after invoking
+ * `pnet_Close()` causes undefined behavior.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure `events` were received via.
+ * @param events Pointer to array of events, each with at least one reference.
+ * @param count Number of events in `events`.
+ */
+void pnet_FreeEvents(pnet_t *pnet, pnet_Event **events, size_t count);
+
+/**
+ * Acquires one more reference to `event`.
+ *
+ * Every event received via `pnet_Poll()` or `pnet_PollWait()` comes with one
+ * reference, and is freed when its last reference is released. Retaining an
+ * event keeps its payload buffer, and any `mem_t` views into it, valid after
+ * the code that received it has released its own reference, which allows for
+ * payloads to be parsed, forwarded or stored without being copied.
+ *
+ * @note Retained events hold on to inbound buffers, which are limited in
+ * number. Receiving stops while no buffers are available.
+ *
+ * @note Thread-safe and lock-free.
+ *
+ * @param pnet Pointer to PNET structure `event` was received via.
+ * @param event Pointer to event with at least one reference.
+ */
+void pnet_RetainEvent(pnet_t *pnet, pnet_Event *event);
+
+/**
+ * Releases one reference to `event`, freeing it if no references remain.
+ *
+ * @note Thread-safe.
+ *
+ * @param pnet Pointer to PNET structure `event` was received via.
+ * @param event Pointer to event with at least one reference.
+ */
+void pnet_ReleaseEvent(pnet_t *pnet, pnet_Event *event);
+
 #endif
@@ -0,0 +1,39 @@
+#ifndef KDT_PNET_PROFILE_H
+#define KDT_PNET_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct pnet_Profile pnet_Profile;
+
+/**
+ * Socket options applied to all sockets of a PNET structure.
+ *
+ * A zeroed profile leaves every option at its operating system default. Each
+ * TCP option is ignored if PNET_TRANSPORT_UDP is used.
+ */
+struct pnet_Profile {
+    /// Whether to set TCP_NODELAY, making small messages be sent immediately
+    /// rather than being held back until earlier segments are acknowledged.
+    bool no_delay;
+
+    /// Whether to set TCP_QUICKACK, making received segments be acknowledged
+    /// immediately rather than being delayed. As the kernel may turn the option
+    /// off again, it is renewed after every read. Requires KDT_USE_TCP_QUICKACK.
+    bool quick_ack;
+
+    /// Whether to use TCP Fast Open, making the first bytes of each outbound
+    /// connection be carried in its SYN segment, provided that the receiving
+    /// host has handed out a Fast Open cookie during an earlier connection.
+    /// Requires KDT_USE_TCP_FASTOPEN.
+    bool fast_open;
+
+    /// Size of socket send buffers, in bytes, or 0 to use the system default.
+    size_t send_buffer_size;
+
+    /// Size of socket receive buffers, in bytes, or 0 to use the system
+    /// default.
+    size_t receive_buffer_size;
+};
+
+#endif
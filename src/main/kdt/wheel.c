@@ -0,0 +1,301 @@
+#include "wheel.h"
+#include "def.h"
+#include <assert.h>
+
+#define _SLOT_MASK ((uint64_t) WHEEL_SLOTS - 1)
+#define _LAP_BITS (WHEEL_LEVELS * WHEEL_SLOT_BITS)
+#define _LEVEL_EXPIRED WHEEL_LEVELS
+#define _LEVEL_OVERFLOW (WHEEL_LEVELS + 1)
+
+static
+uint64_t IntoTicks(const wheel_t *wheel, tims_t time, bool round_up);
+
+static
+bool IsEmpty(const wheel_Timer *head);
+
+static
+void Link(wheel_t *wheel, wheel_Timer *timer, uint8_t level, uint8_t slot);
+
+static
+void Unlink(wheel_t *wheel, wheel_Timer *timer);
+
+static
+void Place(wheel_t *wheel, wheel_Timer *timer);
+
+static
+void Advance(wheel_t *wheel, uint64_t tick);
+
+static
+bool NextTick(const wheel_t *wheel, uint64_t *out);
+
+static
+unsigned CountTrailingZeroes(uint64_t word);
+
+void wheel_Init(wheel_t *wheel, tims_t now, tims_t resolution) {
+    assert(wheel != NULL);
+    assert(resolution > 0.0);
+
+    wheel->resolution = resolution;
+    wheel->current = IntoTicks(wheel, now, false);
+    wheel->count = 0;
+    for (size_t level = 0; level < WHEEL_LEVELS; ++level) {
+        wheel->occupied[level] = 0;
+        for (size_t slot = 0; slot < WHEEL_SLOTS; ++slot) {
+            wheel_Timer *head = &wheel->slots[level][slot];
+            head->next = head;
+            head->prev = head;
+        }
+    }
+    wheel->expired.next = &wheel->expired;
+    wheel->expired.prev = &wheel->expired;
+    wheel->overflow.next = &wheel->overflow;
+    wheel->overflow.prev = &wheel->overflow;
+}
+
+inline
+void wheel_InitTimer(wheel_Timer *timer) {
+    assert(timer != NULL);
+
+    timer->next = NULL;
+    timer->prev = NULL;
+}
+
+inline
+bool wheel_IsArmed(const wheel_Timer *timer) {
+    assert(timer != NULL);
+
+    return timer->next != NULL;
+}
+
+void wheel_Arm(wheel_t *wheel, wheel_Timer *timer, tims_t time) {
+    assert(wheel != NULL);
+    assert(timer != NULL);
+
+    wheel_Cancel(wheel, timer);
+    timer->expires = IntoTicks(wheel, time, true);
+    Place(wheel, timer);
+    wheel->count += 1;
+}
+
+void wheel_Cancel(wheel_t *wheel, wheel_Timer *timer) {
+    assert(wheel != NULL);
+    assert(timer != NULL);
+
+    if (!wheel_IsArmed(timer)) {
+        return;
+    }
+    Unlink(wheel, timer);
+    wheel->count -= 1;
+}
+
+/*
+ * The wheel is advanced directly to the next tick at which any timer either
+ * expires or is moved to a lower level, as no other ticks can change its state.
+ */
+wheel_Timer *wheel_Pop(wheel_t *wheel, tims_t now) {
+    assert(wheel != NULL);
+
+    const uint64_t target = IntoTicks(wheel, now, false);
+    while (IsEmpty(&wheel->expired) && wheel->current < target) {
+        uint64_t tick;
+        if (!NextTick(wheel, &tick) || tick > target) {
+            wheel->current = target;
+            break;
+        }
+        Advance(wheel, tick);
+    }
+    if (IsEmpty(&wheel->expired)) {
+        return NULL;
+    }
+    wheel_Timer *timer = wheel->expired.next;
+    Unlink(wheel, timer);
+    wheel->count -= 1;
+    return timer;
+}
+
+bool wheel_Next(const wheel_t *wheel, tims_t *out) {
+    assert(wheel != NULL);
+    assert(out != NULL);
+
+    uint64_t tick;
+    if (!NextTick(wheel, &tick)) {
+        return false;
+    }
+    *out = (tims_t) tick * wheel->resolution;
+    return true;
+}
+
+static
+uint64_t IntoTicks(const wheel_t *wheel, tims_t time, bool round_up) {
+    if (time <= 0.0) {
+        return 0;
+    }
+    const tims_t ticks = time / wheel->resolution;
+    uint64_t tick = (uint64_t) ticks;
+    if (round_up && (tims_t) tick < ticks) {
+        tick += 1;
+    }
+    return tick;
+}
+
+static inline
+bool IsEmpty(const wheel_Timer *head) {
+    return head->next == head;
+}
+
+static
+void Link(wheel_t *wheel, wheel_Timer *timer, uint8_t level, uint8_t slot) {
+    wheel_Timer *head;
+    if (level < WHEEL_LEVELS) {
+        head = &wheel->slots[level][slot];
+        wheel->occupied[level] |= (uint64_t) 1 << slot;
+    }
+    else if (level == _LEVEL_EXPIRED) {
+        head = &wheel->expired;
+    }
+    else {
+        head = &wheel->overflow;
+    }
+    timer->level = level;
+    timer->slot = slot;
+    timer->next = head;
+    timer->prev = head->prev;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static
+void Unlink(wheel_t *wheel, wheel_Timer *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = NULL;
+    timer->prev = NULL;
+
+    if (timer->level < WHEEL_LEVELS &&
+        IsEmpty(&wheel->slots[timer->level][timer->slot])) {
+        wheel->occupied[timer->level] &= ~((uint64_t) 1 << timer->slot);
+    }
+}
+
+/*
+ * A timer is put in the lowest level at which its expiry tick and the current
+ * tick only differ by the bits indexing the slots of that level. Every slot
+ * thereby covers a range of ticks not yet reached, and the timers of a slot
+ * are moved to lower levels when the current tick enters its range.
+ */
+static
+void Place(wheel_t *wheel, wheel_Timer *timer) {
+    if (timer->expires <= wheel->current) {
+        Link(wheel, timer, _LEVEL_EXPIRED, 0);
+        return;
+    }
+    const uint64_t diff = timer->expires ^ wheel->current;
+    for (uint8_t level = 0; level < WHEEL_LEVELS; ++level) {
+        const unsigned shift = level * WHEEL_SLOT_BITS;
+        if ((diff >> (shift + WHEEL_SLOT_BITS)) == 0) {
+            Link(wheel, timer, level, (uint8_t) ((timer->expires >> shift) & _SLOT_MASK));
+            return;
+        }
+    }
+
+    Link(wheel, timer, _LEVEL_OVERFLOW, 0);
+}
+
+static
+void Advance(wheel_t *wheel, uint64_t tick) {
+    wheel->current = tick;
+
+    // Place timers expiring during entered top level lap, if any.
+    if ((tick & (((uint64_t) 1 << _LAP_BITS) - 1)) == 0 &&
+        !IsEmpty(&wheel->overflow)) {
+        wheel_Timer overflow = {
+            .next = wheel->overflow.next,
+            .prev = wheel->overflow.prev,
+        };
+        overflow.next->prev = &overflow;
+        overflow.prev->next = &overflow;
+        wheel->overflow.next = &wheel->overflow;
+        wheel->overflow.prev = &wheel->overflow;
+        while (!IsEmpty(&overflow)) {
+            wheel_Timer *timer = overflow.next;
+            Unlink(wheel, timer);
+            Place(wheel, timer);
+        }
+    }
+
+    // Move timers of any slots entered by higher levels to lower levels.
+    for (uint8_t level = WHEEL_LEVELS - 1; level > 0; --level) {
+        const unsigned shift = level * WHEEL_SLOT_BITS;
+        if ((tick & (((uint64_t) 1 << shift) - 1)) != 0) {
+            continue;
+        }
+        wheel_Timer *head = &wheel->slots[level][(tick >> shift) & _SLOT_MASK];
+        while (!IsEmpty(head)) {
+            wheel_Timer *timer = head->next;
+            Unlink(wheel, timer);
+            Place(wheel, timer);
+        }
+    }
+
+    // Expire all timers of entered first level slot.
+    wheel_Timer *head = &wheel->slots[0][tick & _SLOT_MASK];
+    while (!IsEmpty(head)) {
+        wheel_Timer *timer = head->next;
+        Unlink(wheel, timer);
+        Link(wheel, timer, _LEVEL_EXPIRED, 0);
+    }
+}
+
+/*
+ * The first occupied slot ahead of the current tick in the lowest level having
+ * any such slot is the next to be entered, as every slot of a given level
+ * covers the entire range of the level before it.
+ */
+static
+bool NextTick(const wheel_t *wheel, uint64_t *out) {
+    if (wheel->count == 0) {
+        return false;
+    }
+    const uint64_t current = wheel->current;
+    if (!IsEmpty(&wheel->expired)) {
+        *out = current;
+        return true;
+    }
+    for (uint8_t level = 0; level < WHEEL_LEVELS; ++level) {
+        const unsigned shift = level * WHEEL_SLOT_BITS;
+        const uint64_t index = (current >> shift) & _SLOT_MASK;
+        if (index == _SLOT_MASK) {
+            continue;
+        }
+        const uint64_t ahead = wheel->occupied[level] & (~(uint64_t) 0 << (index + 1));
+        if (ahead != 0) {
+            const unsigned range = shift + WHEEL_SLOT_BITS;
+            *out = ((current >> range) << range) |
+                   ((uint64_t) CountTrailingZeroes(ahead) << shift);
+            return true;
+        }
+    }
+
+    // Only timers beyond the current top level lap remain.
+    *out = ((current >> _LAP_BITS) + 1) << _LAP_BITS;
+    return true;
+}
+
+static
+unsigned CountTrailingZeroes(uint64_t word) {
+#ifdef KDT_GCC5_BUILTINS
+    return (unsigned) __builtin_ctzll((unsigned long long) word);
+#else
+    unsigned bit = 0;
+    while ((word & 1u) == 0) {
+        word >>= 1u;
+        bit += 1;
+    }
+    return bit;
+#endif
+}
+
+#undef _SLOT_MASK
+#undef _LAP_BITS
+#undef _LEVEL_EXPIRED
+#undef _LEVEL_OVERFLOW
@@ -0,0 +1,155 @@
+/**
+ * Hierarchical timer wheel utilities.
+ *
+ * @file
+ */
+#ifndef KDT_WHEEL_H
+#define KDT_WHEEL_H
+
+#include "tims.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Number of wheel levels.
+#define WHEEL_LEVELS 4
+
+/// Number of bits used to index the slots of a wheel level.
+#define WHEEL_SLOT_BITS 6
+
+/// Number of slots per wheel level.
+#define WHEEL_SLOTS (1u << WHEEL_SLOT_BITS)
+
+/**
+ * Gets pointer to the `TYPE` structure of which `TIMER` is the `MEMBER` field.
+ */
+#define WHEEL_CONTAINER(TIMER, TYPE, MEMBER) \
+    ((TYPE *) ((uint8_t *) (TIMER) - offsetof(TYPE, MEMBER)))
+
+typedef struct wheel_Timer wheel_Timer;
+typedef struct wheel_t wheel_t;
+
+/**
+ * A timer, typically embedded in the structure it is used to keep track of.
+ */
+struct wheel_Timer {
+    /// Next timer in the same list, or NULL if timer is not armed.
+    wheel_Timer *next;
+
+    /// Previous timer in the same list, or NULL if timer is not armed.
+    wheel_Timer *prev;
+
+    /// Tick at which timer expires.
+    uint64_t expires;
+
+    /// Wheel level of timer list, or larger if timer is not in any level.
+    uint8_t level;
+
+    /// Wheel slot of timer list.
+    uint8_t slot;
+};
+
+/**
+ * A hierarchical timer wheel.
+ *
+ * Each slot of the first level covers a single tick, while each slot of every
+ * subsequent level covers all slots of the level before it. Timers are put in
+ * the lowest level able to tell them apart from the current tick, and are moved
+ * to lower levels as that tick advances. Arming and cancelling timers are
+ * constant-time operations, while advancing the wheel takes constant time per
+ * tick, skipping ticks with no timers in them.
+ *
+ * Timers expiring later than the highest level can keep track of are kept in
+ * a separate list, which is revisited every time that level completes a lap.
+ *
+ * @note Not thread-safe.
+ */
+struct wheel_t {
+    /// Duration of one tick, in seconds.
+    tims_t resolution;
+
+    /// Number of last tick advanced to.
+    uint64_t current;
+
+    /// Number of armed timers, including expired and not yet popped ones.
+    size_t count;
+
+    /// Bit sets of slots that contain timers, one per level.
+    uint64_t occupied[WHEEL_LEVELS];
+
+    /// Heads of timer lists, one per slot.
+    wheel_Timer slots[WHEEL_LEVELS][WHEEL_SLOTS];
+
+    /// Head of list of expired timers.
+    wheel_Timer expired;
+
+    /// Head of list of timers expiring beyond the range of the highest level.
+    wheel_Timer overflow;
+};
+
+/**
+ * Initializes `wheel`.
+ *
+ * @param wheel Pointer to uninitialized wheel.
+ * @param now Current time.
+ * @param resolution Duration of one wheel tick, in seconds.
+ */
+void wheel_Init(wheel_t *wheel, tims_t now, tims_t resolution);
+
+/**
+ * Initializes `timer` as not armed.
+ *
+ * @param timer Pointer to uninitialized timer.
+ */
+void wheel_InitTimer(wheel_Timer *timer);
+
+/**
+ * @param timer Pointer to initialized timer.
+ * @return Whether or not `timer` is armed and not yet popped.
+ */
+bool wheel_IsArmed(const wheel_Timer *timer);
+
+/**
+ * Arms `timer` to expire at `time`, rounded up to the closest tick.
+ *
+ * If `timer` is already armed, it is first cancelled. Timers armed to expire
+ * at or before the current tick are popped the next time the wheel is polled.
+ *
+ * @param wheel Pointer to wheel.
+ * @param timer Pointer to initialized timer.
+ * @param time Time at which timer expires.
+ */
+void wheel_Arm(wheel_t *wheel, wheel_Timer *timer, tims_t time);
+
+/**
+ * Cancels `timer`, if armed.
+ *
+ * @param wheel Pointer to wheel `timer` was armed with.
+ * @param timer Pointer to initialized timer.
+ */
+void wheel_Cancel(wheel_t *wheel, wheel_Timer *timer);
+
+/**
+ * Advances `wheel` to `now` and pops one timer having expired, if any.
+ *
+ * Popped timers are no longer armed, and may be armed again.
+ *
+ * @param wheel Pointer to wheel.
+ * @param now Current time.
+ * @return Pointer to expired timer, or NULL if no timer has expired.
+ */
+wheel_Timer *wheel_Pop(wheel_t *wheel, tims_t now);
+
+/**
+ * Determines a time at or before which the first armed timer expires.
+ *
+ * The time returned is exact if that timer expires within WHEEL_SLOTS ticks,
+ * and is otherwise the time at which the wheel next needs to be advanced.
+ *
+ * @param wheel Pointer to wheel.
+ * @param out Receiver of time.
+ * @return Whether or not any timer is armed.
+ */
+bool wheel_Next(const wheel_t *wheel, tims_t *out);
+
+#endif
@@ -1,3 +1,4 @@
+#include <kdt/def.h>
 #include <kdt/err.h>
 #include <kdt/kdm/kdm.h>
 #include <kdt/kvs.h>
@@ -18,7 +19,7 @@
 static void OnSignal(int signal);
 
 kvs_t store;
-pnet_t pnet;
+pnet_t pnet[KDT_SHARDS];
 
 int main() {
     err_t err;
@@ -39,10 +40,19 @@ int main() {
     }
 
     _TRY(kvs_Open("data", &store));
-    _TRY(pnet_Open(&pnet, &options.interface));
-    _TRY(kdm_Start(&store, &pnet, &options.peer));
+    const pnet_Profile profile = {
+        .no_delay = true,
+#ifdef KDT_USE_TCP_QUICKACK
+        .quick_ack = true,
+#endif
+#ifdef KDT_USE_TCP_FASTOPEN
+        .fast_open = true,
+#endif
+    };
+    _TRY(pnet_OpenShardsWithProfile(pnet, KDT_SHARDS, &options.interface, &profile));
+    _TRY(kdm_Start(&store, pnet, KDT_SHARDS, &options.peer));
 
-    pnet_Close(&pnet);
+    pnet_CloseShards(pnet, KDT_SHARDS);
     kvs_Close(&store);
 
     log_Note("Bye!");
@@ -0,0 +1,131 @@
+#include <kdt/abitset.h>
+#include <unit/unit.h>
+
+#define _ASSERT_BOOL(T, EXPECTED, ACTUAL) do {             \
+    bool _e = (EXPECTED);                                  \
+    bool _a = (ACTUAL);                                    \
+    if (_e != _a) {                                        \
+        unit_FailF((T), "Expected: %d; got: %d.", _e, _a); \
+        return;                                            \
+    }                                                      \
+} while (0)
+
+static void TestAllocate(unit_T *T, void *_arg);
+static void TestAllocateAll(unit_T *T, void *_arg);
+static void TestSetClear(unit_T *T, void *_arg);
+static void TestSetMany(unit_T *T, void *_arg);
+
+void test_abitset_unit_c(unit_T *T) {
+    unit_RunTest(T, TestAllocate, NULL);
+    unit_RunTest(T, TestAllocateAll, NULL);
+    unit_RunTest(T, TestSetClear, NULL);
+    unit_RunTest(T, TestSetMany, NULL);
+}
+
+static void TestAllocate(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    atomic_size_t words[ABITSET_WORDS(3)];
+    abitset_t abitset;
+    abitset_Init(&abitset, words, 3);
+
+    size_t out[3], out_fail = 200;
+
+    _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &out[0]));
+    _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &out[1]));
+    _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &out[2]));
+    _ASSERT_BOOL(T, false, abitset_Allocate(&abitset, &out_fail));
+
+    if (out[0] + out[1] + out[2] != 0 + 1 + 2 || out[0] == out[1] ||
+        out[1] == out[2] || out[0] == out[2]) {
+        unit_FailF(T, "{%zu, %zu, %zu} not {0, 1, 2}.", out[0], out[1], out[2]);
+    }
+    if (out_fail != 200) {
+        unit_FailF(T, "Expected: 200; got: %zu", out_fail);
+    }
+}
+
+static void TestAllocateAll(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    atomic_size_t words[ABITSET_WORDS(1000)];
+    abitset_t abitset;
+    abitset_Init(&abitset, words, 1000);
+
+    bool allocated[1000] = {false};
+    for (size_t i = 0; i < 1000; ++i) {
+        size_t index;
+        _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &index));
+        if (index >= 1000 || allocated[index]) {
+            unit_FailF(T, "Index %zu out of bounds or allocated twice.", index);
+            return;
+        }
+        allocated[index] = true;
+    }
+    size_t index;
+    _ASSERT_BOOL(T, false, abitset_Allocate(&abitset, &index));
+
+    abitset_Set(&abitset, 700);
+    _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &index));
+    if (index != 700) {
+        unit_FailF(T, "Expected: 700; got: %zu.", index);
+    }
+}
+
+static void TestSetClear(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    atomic_size_t words[ABITSET_WORDS(130)];
+    abitset_t abitset;
+    abitset_Init(&abitset, words, 130);
+
+    for (size_t i = 0; i < 130; ++i) {
+        abitset_Clear(&abitset, i);
+    }
+    size_t index;
+    _ASSERT_BOOL(T, false, abitset_Allocate(&abitset, &index));
+
+    abitset_Set(&abitset, 129);
+    abitset_Set(&abitset, 64);
+    abitset_Clear(&abitset, 129);
+
+    _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &index));
+    if (index != 64) {
+        unit_FailF(T, "Expected: 64; got: %zu.", index);
+        return;
+    }
+    _ASSERT_BOOL(T, false, abitset_Allocate(&abitset, &index));
+}
+
+static void TestSetMany(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    atomic_size_t words[ABITSET_WORDS(130)];
+    abitset_t abitset;
+    abitset_Init(&abitset, words, 130);
+
+    for (size_t i = 0; i < 130; ++i) {
+        abitset_Clear(&abitset, i);
+    }
+    const size_t indexes[] = {3, 7, 70, 5, 129};
+    abitset_SetMany(&abitset, indexes, sizeof(indexes) / sizeof(size_t));
+
+    bool found[130] = {false};
+    for (size_t i = 0; i < sizeof(indexes) / sizeof(size_t); ++i) {
+        size_t index;
+        _ASSERT_BOOL(T, true, abitset_Allocate(&abitset, &index));
+        if (index >= 130 || found[index]) {
+            unit_FailF(T, "Unexpected index: %zu.", index);
+            return;
+        }
+        found[index] = true;
+    }
+    for (size_t i = 0; i < sizeof(indexes) / sizeof(size_t); ++i) {
+        if (!found[indexes[i]]) {
+            unit_FailF(T, "Expected %zu to be allocated.", indexes[i]);
+            return;
+        }
+    }
+    size_t index;
+    _ASSERT_BOOL(T, false, abitset_Allocate(&abitset, &index));
+}
@@ -18,10 +18,12 @@
 } while (0)
 
 static void TestAllocate(unit_T *T, void *_arg);
+static void TestAllocateAll(unit_T *T, void *_arg);
 static void TestSetClear(unit_T *T, void *_arg);
 
 void test_bitset_unit_c(unit_T *T) {
     unit_RunTest(T, TestAllocate, NULL);
+    unit_RunTest(T, TestAllocateAll, NULL);
     unit_RunTest(T, TestSetClear, NULL);
 }
 
@@ -51,6 +53,34 @@ static void TestAllocate(unit_T *T, void *_arg) {
     }
 }
 
+static void TestAllocateAll(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    size_t buffer[1024 / (sizeof(size_t) * 8)];
+    memset(buffer, 0xff, sizeof(buffer));
+    bitset_t bitset;
+    bitset_Init(&bitset, (uint8_t *) buffer, sizeof(buffer));
+
+    bool allocated[1024] = {false};
+    for (size_t i = 0; i < 1024; ++i) {
+        size_t index;
+        _ASSERT_BOOL(T, true, bitset_Allocate(&bitset, &index));
+        if (index >= 1024 || allocated[index]) {
+            unit_FailF(T, "Index %zu out of bounds or allocated twice.", index);
+            return;
+        }
+        allocated[index] = true;
+    }
+    size_t index;
+    _ASSERT_BOOL(T, false, bitset_Allocate(&bitset, &index));
+
+    bitset_Set(&bitset, 700);
+    _ASSERT_BOOL(T, true, bitset_Allocate(&bitset, &index));
+    if (index != 700) {
+        unit_FailF(T, "Expected: 700; got: %zu.", index);
+    }
+}
+
 static void TestSetClear(unit_T *T, void *_arg) {
     (void) _arg;
 
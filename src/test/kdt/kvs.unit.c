@@ -29,9 +29,11 @@
 } while (0)
 
 static void TestCRUD(unit_T *T, void *_arg);
+static void TestChunks(unit_T *T, void *_arg);
 
 void test_kvs_unit_c(unit_T *T) {
     unit_RunTest(T, TestCRUD, NULL);
+    unit_RunTest(T, TestChunks, NULL);
 }
 
 static void TestCRUD(unit_T *T, void *_arg) {
@@ -73,5 +75,49 @@ static void TestCRUD(unit_T *T, void *_arg) {
     _TRY_ERR(T, ERR_NOT_FOUND, kvs_Get(&kvs, _KEY(4), &mem));
     _TRY_ERR(T, ERR_NOT_FOUND, kvs_Get(&kvs, _KEY(5), &mem));
 
+    _TRY(T, kvs_Drop(&kvs));
+}
+
+static void TestChunks(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    kvs_t kvs;
+    _TRY(T, kvs_Open("__test_kvs", &kvs));
+
+    _TRY(T, kvs_Set(&kvs, _KEY(1), sizeof("0") - 1, (uint8_t *) "0"));
+    _TRY(T, kvs_Set(&kvs, _KEY(3), sizeof("xyz") - 1, (uint8_t *) "xyz"));
+
+    // Chunks may be stored in any order.
+    _TRY(T, kvs_SetChunk(&kvs, _KEY(2), 4, sizeof("efgh") - 1, (const uint8_t *) "efgh"));
+    _TRY(T, kvs_SetChunk(&kvs, _KEY(2), 0, sizeof("abcd") - 1, (const uint8_t *) "abcd"));
+    _TRY(T, kvs_SetChunk(&kvs, _KEY(2), 8, sizeof("ij") - 1, (const uint8_t *) "ij"));
+    _TRY(T, kvs_SetChunk(&kvs, _KEY(4), 0, sizeof("uvw") - 1, (const uint8_t *) "uvw"));
+
+    uint8_t buffer[129] = {0};
+    mem_t mem = mem_FromBuffer(buffer, sizeof(buffer) - 1);
+
+    // Chunks are not values.
+    _TRY_ERR(T, ERR_NOT_FOUND, kvs_Get(&kvs, _KEY(2), &mem));
+
+    // Chunks must cover the entire value, and nothing more.
+    _TRY_ERR(T, ERR_NOT_VALID, kvs_CommitChunks(&kvs, _KEY(2), 9));
+    _TRY_ERR(T, ERR_NOT_VALID, kvs_CommitChunks(&kvs, _KEY(2), 11));
+    _TRY_ERR(T, ERR_NOT_VALID, kvs_CommitChunks(&kvs, _KEY(5), 1));
+    _TRY(T, kvs_CommitChunks(&kvs, _KEY(2), 10));
+    _TRY_ERR(T, ERR_NOT_VALID, kvs_CommitChunks(&kvs, _KEY(2), 10));
+
+    _TRY(T, kvs_DropChunks(&kvs, _KEY(4)));
+    _TRY_ERR(T, ERR_NOT_VALID, kvs_CommitChunks(&kvs, _KEY(4), 3));
+
+    _TRY(T, kvs_Get(&kvs, _KEY(1), &mem));
+    _TRY(T, kvs_Get(&kvs, _KEY(2), &mem));
+    _TRY(T, kvs_Get(&kvs, _KEY(3), &mem));
+    _TRY_ERR(T, ERR_NOT_FOUND, kvs_Get(&kvs, _KEY(4), &mem));
+
+    const char *expected = "0abcdefghijxyz";
+    if (strcmp(expected, (const char *) mem.begin) != 0) {
+        unit_FailF(T, "Expected: \"%s\"; actual: \"%s\".", expected, mem.begin);
+    }
+
     _TRY(T, kvs_Drop(&kvs));
 }
\ No newline at end of file
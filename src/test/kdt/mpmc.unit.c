@@ -0,0 +1,129 @@
+#include <kdt/mpmc.h>
+#include <unit/unit.h>
+
+#define _ASSERT_PUSH(T, MPMCZ, VALUE, SUCCESS) do {        \
+    bool _e = (SUCCESS);                                   \
+    bool _a = mpmcz_Push((MPMCZ), (VALUE));                \
+    if (_e != _a) {                                        \
+        unit_FailF((T), "Expected: %d; got: %d.", _e, _a); \
+        return;                                            \
+    }                                                      \
+} while (0)
+
+#define _ASSERT_POP(T, MPMCZ, VALUE, SUCCESS) do {           \
+    size_t _v = (VALUE);                                     \
+    size_t _o;                                               \
+    bool _e = (SUCCESS);                                     \
+    bool _a = mpmcz_Pop((MPMCZ), &_o);                       \
+    if (_e != _a) {                                          \
+        unit_FailF((T), "Expected: %d; got: %d.", _e, _a);   \
+        return;                                              \
+    }                                                        \
+    if (_a && _v != _o) {                                    \
+        unit_FailF((T), "Expected: %zu; got: %zu.", _v, _o); \
+        return;                                              \
+    }                                                        \
+} while (0)
+
+#define _ASSERT_POP_MANY(T, MPMCZ, MAX, COUNT, FIRST) do {                  \
+    size_t _o[(MAX) + 1];                                                    \
+    size_t _e = (COUNT);                                                     \
+    size_t _a = mpmcz_PopMany((MPMCZ), _o, (MAX));                           \
+    if (_e != _a) {                                                          \
+        unit_FailF((T), "Expected count: %zu; got: %zu.", _e, _a);           \
+        return;                                                              \
+    }                                                                        \
+    for (size_t _i = 0; _i < _a; ++_i) {                                     \
+        if (_o[_i] != (FIRST) + _i * 100) {                                  \
+            unit_FailF((T), "Expected: %zu; got: %zu.", (FIRST) + _i * 100,  \
+                       _o[_i]);                                              \
+            return;                                                          \
+        }                                                                    \
+    }                                                                        \
+} while (0)
+
+static void TestPushPop(unit_T *T, void *_arg);
+static void TestLaps(unit_T *T, void *_arg);
+static void TestPopMany(unit_T *T, void *_arg);
+
+void test_mpmc_unit_c(unit_T *T) {
+    unit_RunTest(T, TestPushPop, NULL);
+    unit_RunTest(T, TestLaps, NULL);
+    unit_RunTest(T, TestPopMany, NULL);
+}
+
+static void TestPushPop(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    mpmcz_Cell buffer[4];
+    mpmcz_t mpmcz;
+    mpmcz_Init(&mpmcz, buffer, sizeof(buffer) / sizeof(mpmcz_Cell));
+
+    _ASSERT_POP(T, &mpmcz, 0, false);
+
+    _ASSERT_PUSH(T, &mpmcz, 100, true);
+    _ASSERT_PUSH(T, &mpmcz, 200, true);
+    _ASSERT_PUSH(T, &mpmcz, 300, true);
+    _ASSERT_PUSH(T, &mpmcz, 400, true);
+    _ASSERT_PUSH(T, &mpmcz, 500, false);
+
+    _ASSERT_POP(T, &mpmcz, 100, true);
+    _ASSERT_POP(T, &mpmcz, 200, true);
+
+    _ASSERT_PUSH(T, &mpmcz, 500, true);
+    _ASSERT_PUSH(T, &mpmcz, 600, true);
+    _ASSERT_PUSH(T, &mpmcz, 700, false);
+
+    _ASSERT_POP(T, &mpmcz, 300, true);
+    _ASSERT_POP(T, &mpmcz, 400, true);
+    _ASSERT_POP(T, &mpmcz, 500, true);
+    _ASSERT_POP(T, &mpmcz, 600, true);
+    _ASSERT_POP(T, &mpmcz, 700, false);
+
+    _ASSERT_PUSH(T, &mpmcz, 700, true);
+}
+
+static void TestLaps(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    mpmcz_Cell buffer[2];
+    mpmcz_t mpmcz;
+    mpmcz_Init(&mpmcz, buffer, sizeof(buffer) / sizeof(mpmcz_Cell));
+
+    for (size_t i = 0; i < 100; ++i) {
+        _ASSERT_PUSH(T, &mpmcz, i, true);
+        _ASSERT_PUSH(T, &mpmcz, i + 1000, true);
+        _ASSERT_PUSH(T, &mpmcz, i + 2000, false);
+        _ASSERT_POP(T, &mpmcz, i, true);
+        _ASSERT_POP(T, &mpmcz, i + 1000, true);
+        _ASSERT_POP(T, &mpmcz, 0, false);
+    }
+}
+
+static void TestPopMany(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    mpmcz_Cell buffer[4];
+    mpmcz_t mpmcz;
+    mpmcz_Init(&mpmcz, buffer, sizeof(buffer) / sizeof(mpmcz_Cell));
+
+    _ASSERT_POP_MANY(T, &mpmcz, 4, 0, 0);
+
+    _ASSERT_PUSH(T, &mpmcz, 100, true);
+    _ASSERT_PUSH(T, &mpmcz, 200, true);
+    _ASSERT_PUSH(T, &mpmcz, 300, true);
+    _ASSERT_POP_MANY(T, &mpmcz, 0, 0, 0);
+    _ASSERT_POP_MANY(T, &mpmcz, 2, 2, 100);
+
+    // Elements wrapping around the end of the buffer.
+    _ASSERT_PUSH(T, &mpmcz, 400, true);
+    _ASSERT_PUSH(T, &mpmcz, 500, true);
+    _ASSERT_PUSH(T, &mpmcz, 600, true);
+    _ASSERT_PUSH(T, &mpmcz, 700, false);
+    _ASSERT_POP_MANY(T, &mpmcz, 8, 4, 300);
+    _ASSERT_POP_MANY(T, &mpmcz, 8, 0, 0);
+
+    _ASSERT_PUSH(T, &mpmcz, 700, true);
+    _ASSERT_POP(T, &mpmcz, 700, true);
+    _ASSERT_POP(T, &mpmcz, 0, false);
+}
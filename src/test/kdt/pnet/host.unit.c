@@ -3,6 +3,7 @@
 #include <unit/unit.h>
 
 typedef struct ArgInternetAsString ArgInternetAsString;
+typedef struct ArgIsHostEqual ArgIsHostEqual;
 typedef struct ArgTransportAsString ArgTransportAsString;
 typedef struct ArgWriteHostText ArgWriteHostText;
 
@@ -11,6 +12,12 @@ struct ArgInternetAsString {
     const char *s;
 };
 
+struct ArgIsHostEqual {
+    pnet_Host *a;
+    pnet_Host *b;
+    bool e;
+};
+
 struct ArgTransportAsString {
     uint8_t t;
     const char *s;
@@ -30,11 +37,46 @@ static const ArgInternetAsString *DATA_InternetAsString[] = {
     NULL
 };
 
+static const ArgIsHostEqual *DATA_IsHostEqual[] = {
+    &(ArgIsHostEqual) {
+        .a = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1}, 80},
+        .b = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1}, 80},
+        .e = true,
+    },
+    &(ArgIsHostEqual) {
+        .a = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1, 7}, 80},
+        .b = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1, 9}, 80},
+        .e = true,
+    },
+    &(ArgIsHostEqual) {
+        .a = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1}, 80},
+        .b = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 2}, 80},
+        .e = false,
+    },
+    &(ArgIsHostEqual) {
+        .a = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1}, 80},
+        .b = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {10, 0, 0, 1}, 81},
+        .e = false,
+    },
+    &(ArgIsHostEqual) {
+        .a = &(pnet_Host) {PNET_INTERNET_IPV6, PNET_TRANSPORT_TCP, {0xFD, [15] = 1}, 80},
+        .b = &(pnet_Host) {PNET_INTERNET_IPV6, PNET_TRANSPORT_TCP, {0xFD, [15] = 2}, 80},
+        .e = false,
+    },
+    &(ArgIsHostEqual) {
+        .a = &(pnet_Host) {PNET_INTERNET_IPV4, PNET_TRANSPORT_TCP, {0}, 80},
+        .b = &(pnet_Host) {PNET_INTERNET_IPV6, PNET_TRANSPORT_TCP, {0}, 80},
+        .e = false,
+    },
+    NULL
+};
+
 static ArgTransportAsString *DATA_TransportAsString[] = {
     &(ArgTransportAsString) {.t = 0xFF, .s = NULL},
     &(ArgTransportAsString) {.t = 0xc3, .s = NULL},
     &(ArgTransportAsString) {.t = 0x32, .s = NULL},
     &(ArgTransportAsString) {.t = PNET_TRANSPORT_TCP, .s = "TCP"},
+    &(ArgTransportAsString) {.t = PNET_TRANSPORT_UDP, .s = "UDP"},
     NULL
 };
 
@@ -57,6 +99,15 @@ static const ArgWriteHostText *DATA_WriteHostText[] = {
         },
         .s = "IPv4/TCP 192.168.2.3:60543",
     },
+    &(ArgWriteHostText) {
+        .h = &(pnet_Host) {
+            .internet = PNET_INTERNET_IPV4,
+            .transport = PNET_TRANSPORT_UDP,
+            .address = {10, 0, 0, 1},
+            .port = 4000,
+        },
+        .s = "IPv4/UDP 10.0.0.1:4000",
+    },
     &(ArgWriteHostText) {
         .h = &(pnet_Host) {
             .internet = PNET_INTERNET_IPV6,
@@ -81,11 +132,15 @@ static const ArgWriteHostText *DATA_WriteHostText[] = {
 };
 
 static void TestWriteHostText(unit_T *T, void *_arg);
+static void TestHashHost(unit_T *T, void *_arg);
 static void TestInternetAsString(unit_T *T, void *_arg);
+static void TestIsHostEqual(unit_T *T, void *_arg);
 static void TestTransportAsString(unit_T *T, void *_arg);
 
 void test_pnet_host_unit_c(unit_T *T) {
     unit_RunTest(T, TestInternetAsString, (void **) DATA_InternetAsString);
+    unit_RunTest(T, TestIsHostEqual, (void **) DATA_IsHostEqual);
+    unit_RunTest(T, TestHashHost, (void **) DATA_IsHostEqual);
     unit_RunTest(T, TestTransportAsString, (void **) DATA_TransportAsString);
     unit_RunTest(T, TestWriteHostText, (void **) DATA_WriteHostText);
 }
@@ -101,6 +156,26 @@ static void TestInternetAsString(unit_T *T, void *_arg) {
     }
 }
 
+static void TestIsHostEqual(unit_T *T, void *_arg) {
+    const ArgIsHostEqual *arg = _arg;
+    const bool actual = pnet_IsHostEqual(arg->a, arg->b);
+    if (actual != arg->e) {
+        unit_FailF(T, "Expected: %d; actual: %d.", arg->e, actual);
+    }
+}
+
+static void TestHashHost(unit_T *T, void *_arg) {
+    const ArgIsHostEqual *arg = _arg;
+    if (!arg->e) {
+        return;
+    }
+    const uint32_t a = pnet_HashHost(arg->a);
+    const uint32_t b = pnet_HashHost(arg->b);
+    if (a != b) {
+        unit_FailF(T, "Expected equal hashes; actual: %08x and %08x.", a, b);
+    }
+}
+
 static void TestTransportAsString(unit_T *T, void *_arg) {
     const ArgTransportAsString *arg = _arg;
     const char *actual = pnet_GetTransportDescription(arg->t);
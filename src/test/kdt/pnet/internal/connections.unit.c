@@ -0,0 +1,319 @@
+#include <kdt/pnet/internal/connections.h>
+#include <unit/unit.h>
+
+#define _SOCKET(FD) ((_pnet_Socket) {.fd = (FD)})
+
+#define _ASSERT_ADD(T, CONNECTIONS, FD, NOW, EVICTED) do {                     \
+    _pnet_Socket _v;                                                          \
+    if (!_pnet_AddConnection((CONNECTIONS), &_SOCKET(FD), (NOW), &_v)) {      \
+        unit_FailF((T), "Expected socket %d to be added.", (FD));             \
+        return;                                                               \
+    }                                                                         \
+    if (_v.fd != (EVICTED)) {                                                 \
+        unit_FailF((T), "Expected evicted: %d; got: %d.", (EVICTED), _v.fd);  \
+        return;                                                               \
+    }                                                                         \
+} while (0)
+
+#define _ASSERT_CONTINUE(T, CONNECTIONS, FD, SIZE, IS_CONTINUED, OFFSET) do { \
+    size_t _o = _pnet_ContinueConnection((CONNECTIONS), &_SOCKET(FD), (SIZE), \
+                                         (IS_CONTINUED));                     \
+    if (_o != (OFFSET)) {                                                     \
+        unit_FailF((T), "Expected offset: %zu; got: %zu.",                    \
+                   (size_t) (OFFSET), _o);                                    \
+        return;                                                               \
+    }                                                                         \
+} while (0)
+
+#define _ASSERT_UNPARK(T, CONNECTIONS, FD, EVENT) do {                        \
+    size_t _e = SIZE_MAX;                                                     \
+    _pnet_UnparkConnectionEvent((CONNECTIONS), &_SOCKET(FD), &_e);            \
+    if (_e != (size_t) (EVENT)) {                                             \
+        unit_FailF((T), "Expected parked event: %zu; got: %zu.",              \
+                   (size_t) (EVENT), _e);                                     \
+        return;                                                               \
+    }                                                                         \
+} while (0)
+
+#define _ASSERT_POP(T, CONNECTIONS, BEFORE, FD) do {                          \
+    _pnet_Socket _s = SOCKET_EMPTY;                                           \
+    _pnet_PopIdleConnection((CONNECTIONS), (BEFORE), &_s);                    \
+    if (_s.fd != (FD)) {                                                      \
+        unit_FailF((T), "Expected idle: %d; got: %d.", (FD), _s.fd);          \
+        return;                                                               \
+    }                                                                         \
+} while (0)
+
+static _pnet_Connections connections;
+
+static void TestAddRemove(unit_T *T, void *_arg);
+static void TestTouch(unit_T *T, void *_arg);
+static void TestEvict(unit_T *T, void *_arg);
+static void TestContinue(unit_T *T, void *_arg);
+static void TestPark(unit_T *T, void *_arg);
+static void TestPin(unit_T *T, void *_arg);
+static void TestWriter(unit_T *T, void *_arg);
+static void TestWaiting(unit_T *T, void *_arg);
+
+void test_pnet_internal_connections_unit_c(unit_T *T) {
+    unit_RunTest(T, TestAddRemove, NULL);
+    unit_RunTest(T, TestTouch, NULL);
+    unit_RunTest(T, TestEvict, NULL);
+    unit_RunTest(T, TestContinue, NULL);
+    unit_RunTest(T, TestPark, NULL);
+    unit_RunTest(T, TestPin, NULL);
+    unit_RunTest(T, TestWriter, NULL);
+    unit_RunTest(T, TestWaiting, NULL);
+}
+
+static void TestAddRemove(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _ASSERT_ADD(T, &connections, 10, 1.0, -1);
+    _ASSERT_ADD(T, &connections, 11, 2.0, -1);
+    _ASSERT_ADD(T, &connections, 12, 3.0, -1);
+
+    _pnet_Socket evicted;
+    if (_pnet_AddConnection(&connections, &_SOCKET(KDT_N_SOCKETS), 4.0, &evicted)) {
+        unit_Fail(T, "Expected socket beyond KDT_N_SOCKETS not to be added.");
+        return;
+    }
+
+    _pnet_RemoveConnection(&connections, &_SOCKET(11));
+    _pnet_RemoveConnection(&connections, &_SOCKET(11));
+    _pnet_RemoveConnection(&connections, &_SOCKET(99));
+    if (connections.count != 2 ||
+        _pnet_GetConnection(&connections, &_SOCKET(11)) != NULL) {
+        unit_Fail(T, "Expected socket 11 to be removed.");
+        return;
+    }
+    _ASSERT_POP(T, &connections, 100.0, 10);
+    _ASSERT_POP(T, &connections, 100.0, 12);
+    _ASSERT_POP(T, &connections, 100.0, -1);
+}
+
+static void TestTouch(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _ASSERT_ADD(T, &connections, 10, 1.0, -1);
+    _ASSERT_ADD(T, &connections, 11, 2.0, -1);
+    _ASSERT_ADD(T, &connections, 12, 3.0, -1);
+
+    _pnet_TouchConnection(&connections, &_SOCKET(10), 4.0, 100, 0);
+    _pnet_TouchConnection(&connections, &_SOCKET(10), 5.0, 20, 30);
+    _pnet_TouchConnection(&connections, &_SOCKET(99), 5.0, 20, 30);
+
+    const _pnet_Connection *connection = _pnet_GetConnection(&connections, &_SOCKET(10));
+    if (connection == NULL || connection->accepted != 1.0 ||
+        connection->active != 5.0 || connection->bytes_received != 120 ||
+        connection->bytes_sent != 30) {
+        unit_Fail(T, "Expected socket 10 stats to be updated.");
+        return;
+    }
+
+    _ASSERT_POP(T, &connections, 1.5, -1);
+    _ASSERT_POP(T, &connections, 2.0, 11);
+    _ASSERT_POP(T, &connections, 4.0, 12);
+    _ASSERT_POP(T, &connections, 4.0, -1);
+    _ASSERT_POP(T, &connections, 5.0, 10);
+}
+
+static void TestEvict(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    for (int i = 0; i < KDT_N_CONNECTIONS; ++i) {
+        _ASSERT_ADD(T, &connections, 100 + i, (tims_t) i, -1);
+    }
+
+    // The least recently active connection is evicted.
+    _pnet_TouchConnection(&connections, &_SOCKET(100), 1000.0, 1, 0);
+    _ASSERT_ADD(T, &connections, 99, 1001.0, 101);
+    _ASSERT_ADD(T, &connections, 98, 1002.0, 102);
+
+    // Adding a tracked socket again only resets it.
+    _ASSERT_ADD(T, &connections, 103, 1003.0, -1);
+    _ASSERT_ADD(T, &connections, 97, 1004.0, 104);
+
+    if (connections.count != KDT_N_CONNECTIONS) {
+        unit_FailF(T, "Expected %d connections; got: %zu.", KDT_N_CONNECTIONS,
+                   connections.count);
+    }
+}
+
+static void TestContinue(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _ASSERT_ADD(T, &connections, 10, 1.0, -1);
+    _ASSERT_ADD(T, &connections, 11, 2.0, -1);
+
+    // Frames of different connections are kept apart.
+    _ASSERT_CONTINUE(T, &connections, 10, 100, true, 0);
+    _ASSERT_CONTINUE(T, &connections, 11, 50, false, 0);
+    _ASSERT_CONTINUE(T, &connections, 10, 100, true, 100);
+    _ASSERT_CONTINUE(T, &connections, 11, 70, true, 0);
+    _ASSERT_CONTINUE(T, &connections, 10, 30, false, 200);
+    _ASSERT_CONTINUE(T, &connections, 10, 30, false, 0);
+    _ASSERT_CONTINUE(T, &connections, 11, 10, false, 70);
+
+    // Adding a socket again forgets about any frames in progress.
+    _ASSERT_CONTINUE(T, &connections, 10, 100, true, 0);
+    _ASSERT_ADD(T, &connections, 10, 3.0, -1);
+    _ASSERT_CONTINUE(T, &connections, 10, 100, false, 0);
+
+    // Untracked sockets have frames in progress until closed.
+    _ASSERT_CONTINUE(T, &connections, 99, 100, true, 0);
+    _ASSERT_CONTINUE(T, &connections, 99, 100, false, 100);
+    _ASSERT_CONTINUE(T, &connections, 99, 100, true, 0);
+    _pnet_CloseConnection(&connections, &_SOCKET(99));
+    _ASSERT_CONTINUE(T, &connections, 99, 100, false, 0);
+
+    // Sockets that cannot be indexed have no frames in progress.
+    _ASSERT_CONTINUE(T, &connections, KDT_N_SOCKETS, 100, true, 0);
+    _ASSERT_CONTINUE(T, &connections, KDT_N_SOCKETS, 100, false, 0);
+}
+
+static void TestPark(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _ASSERT_ADD(T, &connections, 10, 1.0, -1);
+    _ASSERT_ADD(T, &connections, 11, 2.0, -1);
+    _ASSERT_UNPARK(T, &connections, 10, SIZE_MAX);
+
+    // Parked events are taken only once.
+    _pnet_ParkConnectionEvent(&connections, &_SOCKET(10), 3);
+    _pnet_ParkConnectionEvent(&connections, &_SOCKET(11), 0);
+    _ASSERT_UNPARK(T, &connections, 11, 0);
+    _ASSERT_UNPARK(T, &connections, 10, 3);
+    _ASSERT_UNPARK(T, &connections, 10, SIZE_MAX);
+    _ASSERT_UNPARK(T, &connections, 11, SIZE_MAX);
+
+    // Events outlive the tracking of their connections.
+    _pnet_ParkConnectionEvent(&connections, &_SOCKET(10), 5);
+    _pnet_RemoveConnection(&connections, &_SOCKET(10));
+    _ASSERT_UNPARK(T, &connections, 10, 5);
+
+    // Untracked sockets may have parked events, unless they cannot be indexed.
+    if (!_pnet_ParkConnectionEvent(&connections, &_SOCKET(99), 7) ||
+        _pnet_ParkConnectionEvent(&connections, &_SOCKET(-1), 8) ||
+        _pnet_ParkConnectionEvent(&connections, &_SOCKET(KDT_N_SOCKETS), 9)) {
+        unit_Fail(T, "Expected only socket 99 to be parked with.");
+        return;
+    }
+    _ASSERT_UNPARK(T, &connections, 99, 7);
+    _ASSERT_UNPARK(T, &connections, -1, SIZE_MAX);
+}
+
+static void TestPin(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _ASSERT_ADD(T, &connections, 10, 1.0, -1);
+
+    // Sockets neither pinned nor parked with may be closed at once.
+    if (!_pnet_CloseConnection(&connections, &_SOCKET(10)) ||
+        _pnet_IsConnectionClosing(&connections, &_SOCKET(10))) {
+        unit_Fail(T, "Expected socket 10 to be closable at once.");
+        return;
+    }
+
+    // Pinned sockets are closed by whoever removes their last pin.
+    _ASSERT_ADD(T, &connections, 10, 2.0, -1);
+    _pnet_PinConnection(&connections, &_SOCKET(10));
+    _pnet_PinConnection(&connections, &_SOCKET(10));
+    if (_pnet_CloseConnection(&connections, &_SOCKET(10)) ||
+        !_pnet_IsConnectionClosing(&connections, &_SOCKET(10)) ||
+        _pnet_GetConnection(&connections, &_SOCKET(10)) != NULL) {
+        unit_Fail(T, "Expected pinned socket 10 to be closing.");
+        return;
+    }
+    if (_pnet_PinConnection(&connections, &_SOCKET(10))) {
+        unit_Fail(T, "Expected closing socket 10 not to be pinned again.");
+        return;
+    }
+    if (_pnet_UnpinConnection(&connections, &_SOCKET(10)) ||
+        !_pnet_UnpinConnection(&connections, &_SOCKET(10)) ||
+        _pnet_IsConnectionClosing(&connections, &_SOCKET(10))) {
+        unit_Fail(T, "Expected socket 10 to be closed by its last unpin.");
+        return;
+    }
+
+    // Sockets parked with are closed by whoever takes their events.
+    _pnet_PinConnection(&connections, &_SOCKET(11));
+    _pnet_ParkConnectionEvent(&connections, &_SOCKET(11), 4);
+    if (_pnet_CloseConnection(&connections, &_SOCKET(11)) ||
+        _pnet_UnpinConnection(&connections, &_SOCKET(11))) {
+        unit_Fail(T, "Expected socket 11 to stay open while parked with.");
+        return;
+    }
+    _ASSERT_UNPARK(T, &connections, 11, 4);
+    if (!_pnet_CloseConnection(&connections, &_SOCKET(11))) {
+        unit_Fail(T, "Expected socket 11 to be closable once unparked.");
+        return;
+    }
+
+    // Sockets that cannot be indexed are never pinned.
+    if (_pnet_PinConnection(&connections, &_SOCKET(KDT_N_SOCKETS)) ||
+        !_pnet_CloseConnection(&connections, &_SOCKET(-1))) {
+        unit_Fail(T, "Expected sockets out of range not to be pinned.");
+        return;
+    }
+}
+
+static void TestWriter(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _ASSERT_ADD(T, &connections, 10, 1.0, -1);
+    if (_pnet_GetConnectionWriter(&connections, &_SOCKET(10)) != SIZE_MAX) {
+        unit_Fail(T, "Expected socket 10 to have no writer.");
+        return;
+    }
+
+    _pnet_SetConnectionWriter(&connections, &_SOCKET(10), 3);
+    if (_pnet_GetConnectionWriter(&connections, &_SOCKET(10)) != 3) {
+        unit_Fail(T, "Expected socket 10 to be written by message 3.");
+        return;
+    }
+
+    // Writers do not outlive their sockets.
+    if (!_pnet_CloseConnection(&connections, &_SOCKET(10)) ||
+        _pnet_GetConnectionWriter(&connections, &_SOCKET(10)) != SIZE_MAX) {
+        unit_Fail(T, "Expected closed socket 10 to have no writer.");
+        return;
+    }
+
+    _pnet_SetConnectionWriter(&connections, &_SOCKET(KDT_N_SOCKETS), 3);
+    if (_pnet_GetConnectionWriter(&connections, &_SOCKET(KDT_N_SOCKETS)) != SIZE_MAX) {
+        unit_Fail(T, "Expected sockets out of range to have no writer.");
+        return;
+    }
+}
+
+static void TestWaiting(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitConnections(&connections);
+    _pnet_SetConnectionWaiting(&connections, &_SOCKET(10), 5);
+    if (_pnet_GetConnectionWaiting(&connections, &_SOCKET(10)) != 5) {
+        unit_Fail(T, "Expected message 5 to wait for untracked socket 10.");
+        return;
+    }
+
+    // Waiting messages do not outlive their sockets.
+    if (!_pnet_CloseConnection(&connections, &_SOCKET(10)) ||
+        _pnet_GetConnectionWaiting(&connections, &_SOCKET(10)) != SIZE_MAX) {
+        unit_Fail(T, "Expected closed socket 10 to have no waiting messages.");
+        return;
+    }
+
+    _pnet_SetConnectionWaiting(&connections, &_SOCKET(-1), 5);
+    if (_pnet_GetConnectionWaiting(&connections, &_SOCKET(-1)) != SIZE_MAX) {
+        unit_Fail(T, "Expected sockets out of range to have no waiting messages.");
+        return;
+    }
+}
@@ -0,0 +1,141 @@
+#include <kdt/pnet/internal/pool.h>
+#include <unit/unit.h>
+
+#define _HOST(N) ((pnet_Host) {               \
+    .internet = PNET_INTERNET_IPV4,           \
+    .transport = PNET_TRANSPORT_TCP,          \
+    .address = {10, 0, (N) / 256, (N) % 256}, \
+    .port = 40000,                            \
+})
+#define _SOCKET(FD) ((_pnet_Socket) {.fd = (FD)})
+
+#define _ASSERT_TAKE(T, POOL, N, ERR, FD) do {                                \
+    _pnet_Socket _s = SOCKET_EMPTY;                                           \
+    err_t _e = (ERR);                                                         \
+    err_t _a = _pnet_TakePooledSocket((POOL), &_HOST(N), &_s);                \
+    if (_e != _a) {                                                           \
+        unit_FailF((T), "Expected: %s; got: %s.", err_GetDescription(_e),     \
+                   err_GetDescription(_a));                                   \
+        return;                                                               \
+    }                                                                         \
+    if (_a == ERR_NONE && _s.fd != (FD)) {                                    \
+        unit_FailF((T), "Expected socket: %d; got: %d.", (FD), _s.fd);        \
+        return;                                                               \
+    }                                                                         \
+} while (0)
+
+#define _ASSERT_ADD(T, POOL, N, FD, EVICTED) do {                             \
+    _pnet_Socket _v;                                                          \
+    if (!_pnet_AddPooledSocket((POOL), &_HOST(N), &_SOCKET(FD), &_v)) {       \
+        unit_FailF((T), "Expected socket %d to be added.", (FD));             \
+        return;                                                               \
+    }                                                                         \
+    if (_v.fd != (EVICTED)) {                                                 \
+        unit_FailF((T), "Expected evicted: %d; got: %d.", (EVICTED), _v.fd);  \
+        return;                                                               \
+    }                                                                         \
+} while (0)
+
+static _pnet_Pool pool;
+
+static void TestTakeReleaseRemove(unit_T *T, void *_arg);
+static void TestHostCap(unit_T *T, void *_arg);
+static void TestExpire(unit_T *T, void *_arg);
+static void TestEvict(unit_T *T, void *_arg);
+
+void test_pnet_internal_pool_unit_c(unit_T *T) {
+    unit_RunTest(T, TestTakeReleaseRemove, NULL);
+    unit_RunTest(T, TestHostCap, NULL);
+    unit_RunTest(T, TestExpire, NULL);
+    unit_RunTest(T, TestEvict, NULL);
+}
+
+static void TestTakeReleaseRemove(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitPool(&pool);
+    _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+
+    _ASSERT_ADD(T, &pool, 1, 10, -1);
+    _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+
+    if (!_pnet_ReleasePooledSocket(&pool, &_SOCKET(10), 5.0)) {
+        unit_Fail(T, "Expected socket 10 to be released.");
+        return;
+    }
+    _ASSERT_TAKE(T, &pool, 2, ERR_NOT_FOUND, -1);
+    _ASSERT_TAKE(T, &pool, 1, ERR_NONE, 10);
+    _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+
+    _pnet_RemovePooledSocket(&pool, &_SOCKET(10));
+    if (_pnet_ReleasePooledSocket(&pool, &_SOCKET(10), 5.0)) {
+        unit_Fail(T, "Expected removed socket 10 not to be released.");
+    }
+}
+
+static void TestHostCap(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitPool(&pool);
+    for (int i = 0; i < KDT_N_POOL_HOST; ++i) {
+        _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+        _ASSERT_ADD(T, &pool, 1, 10 + i, -1);
+    }
+    _ASSERT_TAKE(T, &pool, 1, ERR_TRY_AGAIN, -1);
+    _ASSERT_TAKE(T, &pool, 2, ERR_NOT_FOUND, -1);
+
+    _pnet_ReleasePooledSocket(&pool, &_SOCKET(11), 5.0);
+    _ASSERT_TAKE(T, &pool, 1, ERR_NONE, 11);
+    _ASSERT_TAKE(T, &pool, 1, ERR_TRY_AGAIN, -1);
+
+    _pnet_RemovePooledSocket(&pool, &_SOCKET(12));
+    _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+}
+
+static void TestExpire(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitPool(&pool);
+    _ASSERT_ADD(T, &pool, 1, 10, -1);
+    _ASSERT_ADD(T, &pool, 2, 11, -1);
+    _pnet_ReleasePooledSocket(&pool, &_SOCKET(10), 5.0);
+
+    _pnet_Socket socket;
+    if (_pnet_PopExpiredSocket(&pool, 4.0, &socket)) {
+        unit_FailF(T, "Expected no expired socket; got: %d.", socket.fd);
+        return;
+    }
+    if (!_pnet_PopExpiredSocket(&pool, 5.0, &socket) || socket.fd != 10) {
+        unit_Fail(T, "Expected socket 10 to be expired.");
+        return;
+    }
+    if (_pnet_PopExpiredSocket(&pool, 100.0, &socket)) {
+        unit_FailF(T, "Expected no expired socket; got: %d.", socket.fd);
+        return;
+    }
+    _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+}
+
+static void TestEvict(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitPool(&pool);
+    for (int i = 0; i < KDT_N_POOL; ++i) {
+        _ASSERT_ADD(T, &pool, i, 100 + i, -1);
+    }
+
+    // No socket is idle, and none can therefore be evicted.
+    _pnet_Socket evicted;
+    if (_pnet_AddPooledSocket(&pool, &_HOST(KDT_N_POOL), &_SOCKET(99), &evicted)) {
+        unit_Fail(T, "Expected full pool not to accept socket 99.");
+        return;
+    }
+
+    // The idle socket closest to expiring is evicted.
+    _pnet_ReleasePooledSocket(&pool, &_SOCKET(103), 9.0);
+    _pnet_ReleasePooledSocket(&pool, &_SOCKET(101), 7.0);
+    _pnet_ReleasePooledSocket(&pool, &_SOCKET(102), 8.0);
+    _ASSERT_ADD(T, &pool, KDT_N_POOL, 99, 101);
+    _ASSERT_TAKE(T, &pool, 1, ERR_NOT_FOUND, -1);
+    _ASSERT_TAKE(T, &pool, 2, ERR_NONE, 102);
+}
\ No newline at end of file
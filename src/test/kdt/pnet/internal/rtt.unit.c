@@ -0,0 +1,121 @@
+#include <kdt/pnet/internal/rtt.h>
+#include <unit/unit.h>
+
+#define _HOST(N) ((pnet_Host) {               \
+    .internet = PNET_INTERNET_IPV4,           \
+    .transport = PNET_TRANSPORT_TCP,          \
+    .address = {10, 0, (N) / 256, (N) % 256}, \
+    .port = 40000,                            \
+})
+#define _NONCE(A, B) ((kint_t) {.as_u8s = {0, 0, 0, (A), (B)}})
+
+#define _ASSERT_RTT(T, RTT, N, SRTT, RTTVAR) do {                            \
+    tims_t _s = -1.0, _v = -1.0;                                             \
+    _pnet_GetRtt((RTT), &_HOST(N), &_s, &_v);                                \
+    if (_s != (SRTT) || _v != (RTTVAR)) {                                    \
+        unit_FailF((T), "Expected RTT: %f/%f; got: %f/%f.", (SRTT),          \
+                   (RTTVAR), _s, _v);                                        \
+        return;                                                              \
+    }                                                                        \
+} while (0)
+
+#define _ASSERT_RTO(T, RTT, N, RTO) do {                                     \
+    tims_t _e = (RTO);                                                       \
+    tims_t _a = _pnet_GetRto((RTT), &_HOST(N));                              \
+    if (_e != _a) {                                                          \
+        unit_FailF((T), "Expected RTO: %f; got: %f.", _e, _a);               \
+        return;                                                              \
+    }                                                                        \
+} while (0)
+
+#define _ASSERT_MEASURE(T, RTT, NONCE, N, NOW, IS_MEASURED) do {             \
+    const bool _m = _pnet_MeasureRtt((RTT), &(NONCE), &_HOST(N), (NOW));     \
+    if (_m != (IS_MEASURED)) {                                               \
+        unit_FailF((T), "Expected measured: %d; got: %d.", (IS_MEASURED),    \
+                   _m);                                                      \
+        return;                                                              \
+    }                                                                        \
+} while (0)
+
+static _pnet_Rtt rtt;
+
+static void TestUpdate(unit_T *T, void *_arg);
+static void TestRto(unit_T *T, void *_arg);
+static void TestProbes(unit_T *T, void *_arg);
+
+void test_pnet_internal_rtt_unit_c(unit_T *T) {
+    unit_RunTest(T, TestUpdate, NULL);
+    unit_RunTest(T, TestRto, NULL);
+    unit_RunTest(T, TestProbes, NULL);
+}
+
+static void TestUpdate(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitRtt(&rtt);
+    _ASSERT_RTT(T, &rtt, 1, -1.0, -1.0);
+
+    _pnet_UpdateRtt(&rtt, &_HOST(1), 0.5);
+    _ASSERT_RTT(T, &rtt, 1, 0.5, 0.25);
+    _pnet_UpdateRtt(&rtt, &_HOST(1), 1.0);
+    _ASSERT_RTT(T, &rtt, 1, 0.5625, 0.3125);
+    _pnet_UpdateRtt(&rtt, &_HOST(1), 0.5625);
+    _ASSERT_RTT(T, &rtt, 1, 0.5625, 0.234375);
+
+    // Hosts sharing the same entry replace each other.
+    int other = 2;
+    while (pnet_HashHost(&_HOST(other)) % KDT_N_RTT_PEERS !=
+           pnet_HashHost(&_HOST(1)) % KDT_N_RTT_PEERS) {
+        other += 1;
+    }
+    _pnet_UpdateRtt(&rtt, &_HOST(other), 4.0);
+    _ASSERT_RTT(T, &rtt, other, 4.0, 2.0);
+    _ASSERT_RTT(T, &rtt, 1, -1.0, -1.0);
+}
+
+static void TestRto(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitRtt(&rtt);
+    _ASSERT_RTO(T, &rtt, 1, KDT_T_RETRANSMIT);
+
+    _pnet_UpdateRtt(&rtt, &_HOST(1), 0.5);
+    _ASSERT_RTO(T, &rtt, 1, 1.5);
+
+    _pnet_UpdateRtt(&rtt, &_HOST(2), 0.0);
+    _ASSERT_RTO(T, &rtt, 2, KDT_T_RTO_MIN);
+
+    _pnet_UpdateRtt(&rtt, &_HOST(3), 60.0);
+    _ASSERT_RTO(T, &rtt, 3, KDT_T_RTO_MAX);
+}
+
+static void TestProbes(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitRtt(&rtt);
+    const kint_t a = _NONCE(1, 1);
+    const kint_t b = _NONCE(2, 1);
+    const kint_t c = _NONCE(1, 2);
+
+    // Replies must come from request receivers, and are only measured once.
+    _pnet_AddRttProbe(&rtt, &a, &_HOST(1), 10.0);
+    _pnet_AddRttProbe(&rtt, &b, &_HOST(2), 10.0);
+    _ASSERT_MEASURE(T, &rtt, a, 2, 10.5, false);
+    _ASSERT_MEASURE(T, &rtt, a, 1, 10.5, true);
+    _ASSERT_MEASURE(T, &rtt, a, 1, 10.5, false);
+    _ASSERT_MEASURE(T, &rtt, b, 2, 10.25, true);
+    _ASSERT_RTT(T, &rtt, 1, 0.5, 0.25);
+    _ASSERT_RTT(T, &rtt, 2, 0.25, 0.125);
+
+    // Removed requests are not measured.
+    _pnet_AddRttProbe(&rtt, &a, &_HOST(1), 20.0);
+    _pnet_RemoveRttProbe(&rtt, &a);
+    _ASSERT_MEASURE(T, &rtt, a, 1, 21.0, false);
+
+    // Requests sharing the same entry replace each other.
+    _pnet_AddRttProbe(&rtt, &a, &_HOST(1), 30.0);
+    _pnet_AddRttProbe(&rtt, &c, &_HOST(1), 30.0);
+    _pnet_RemoveRttProbe(&rtt, &a);
+    _ASSERT_MEASURE(T, &rtt, a, 1, 31.0, false);
+    _ASSERT_MEASURE(T, &rtt, c, 1, 31.0, true);
+}
@@ -0,0 +1,92 @@
+#include <kdt/pnet/internal/slab.h>
+#include <unit/unit.h>
+
+#define _ASSERT_ALLOCATE(T, SLAB, SIZE, CAPACITY, OUT) do {                     \
+    size_t _c = 0;                                                              \
+    (OUT) = _pnet_AllocateSlab((SLAB), (SIZE), &_c);                            \
+    if ((OUT) == NULL) {                                                        \
+        unit_FailF((T), "Expected %zu bytes to be allocated.", (size_t) (SIZE)); \
+        return;                                                                 \
+    }                                                                           \
+    if (_c != (CAPACITY)) {                                                     \
+        unit_FailF((T), "Expected capacity: %zu; got: %zu.",                    \
+                   (size_t) (CAPACITY), _c);                                    \
+        return;                                                                 \
+    }                                                                           \
+} while (0)
+
+static _pnet_Slab slab;
+
+static void TestAllocateClasses(unit_T *T, void *_arg);
+static void TestAllocateFallback(unit_T *T, void *_arg);
+static void TestAllocateTooLarge(unit_T *T, void *_arg);
+
+void test_pnet_internal_slab_unit_c(unit_T *T) {
+    unit_RunTest(T, TestAllocateClasses, NULL);
+    unit_RunTest(T, TestAllocateFallback, NULL);
+    unit_RunTest(T, TestAllocateTooLarge, NULL);
+}
+
+static void TestAllocateClasses(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitSlab(&slab);
+
+    uint8_t *s, *m, *l;
+    _ASSERT_ALLOCATE(T, &slab, 1, _PNET_SLAB_S_SIZE, s);
+    _ASSERT_ALLOCATE(T, &slab, _PNET_SLAB_S_SIZE + 1, _PNET_SLAB_M_SIZE, m);
+    _ASSERT_ALLOCATE(T, &slab, _PNET_SLAB_L_SIZE, _PNET_SLAB_L_SIZE, l);
+    if (s == m || m == l || s == l) {
+        unit_Fail(T, "Expected distinct blocks.");
+        return;
+    }
+
+    // Freed blocks are reused.
+    _pnet_FreeSlab(&slab, m);
+    uint8_t *m2;
+    _ASSERT_ALLOCATE(T, &slab, _PNET_SLAB_M_SIZE, _PNET_SLAB_M_SIZE, m2);
+    if (m2 != m) {
+        unit_Fail(T, "Expected freed block to be reused.");
+    }
+}
+
+static void TestAllocateFallback(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitSlab(&slab);
+
+    uint8_t *block;
+    for (size_t i = 0; i < KDT_N_SLAB_S_COUNT; ++i) {
+        _ASSERT_ALLOCATE(T, &slab, 1, _PNET_SLAB_S_SIZE, block);
+    }
+    for (size_t i = 0; i < KDT_N_SLAB_M_COUNT; ++i) {
+        _ASSERT_ALLOCATE(T, &slab, 1, _PNET_SLAB_M_SIZE, block);
+    }
+    for (size_t i = 0; i < KDT_N_SLAB_L_COUNT; ++i) {
+        _ASSERT_ALLOCATE(T, &slab, 1, _PNET_SLAB_L_SIZE, block);
+    }
+    size_t capacity;
+    if (_pnet_AllocateSlab(&slab, 1, &capacity) != NULL) {
+        unit_Fail(T, "Expected exhausted slab not to allocate.");
+        return;
+    }
+
+    // Small blocks are preferred, once available again.
+    _pnet_FreeSlab(&slab, block);
+    _pnet_FreeSlab(&slab, &slab._blocks_s[7][0]);
+    _ASSERT_ALLOCATE(T, &slab, 1, _PNET_SLAB_S_SIZE, block);
+    if (block != &slab._blocks_s[7][0]) {
+        unit_Fail(T, "Expected freed small block to be reused.");
+    }
+}
+
+static void TestAllocateTooLarge(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    _pnet_InitSlab(&slab);
+
+    size_t capacity;
+    if (_pnet_AllocateSlab(&slab, _PNET_SLAB_L_SIZE + 1, &capacity) != NULL) {
+        unit_Fail(T, "Expected oversized block not to be allocated.");
+    }
+}
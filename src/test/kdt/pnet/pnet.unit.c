@@ -0,0 +1,353 @@
+#include <errno.h>
+#include <kdt/err.h>
+#include <kdt/pnet/pnet.h>
+#include <unit/unit.h>
+
+#define _ATTACHMENT_SIZE 200000
+
+#define _REQUEST_COUNT 8
+
+#define _TAG 7
+
+#define _TIMEOUT 5.0
+
+#define _TRY(T, CODE) do {                                                         \
+    err_t _c = (CODE);                                                             \
+    if (_c != ERR_NONE) {                                                          \
+        unit_FailF((T), "Expected: 0; got: %d (%s).", _c, err_GetDescription(_c)); \
+        goto leave;                                                                \
+    }                                                                              \
+} while (0)
+
+static const pnet_Host *DATA_TcpInterfaces[] = {
+    &(pnet_Host) {
+        .internet = PNET_INTERNET_IPV4,
+        .transport = PNET_TRANSPORT_TCP,
+        .address = {127, 0, 0, 1},
+    },
+    NULL
+};
+
+static const pnet_Host *DATA_Interfaces[] = {
+    &(pnet_Host) {
+        .internet = PNET_INTERNET_IPV4,
+        .transport = PNET_TRANSPORT_TCP,
+        .address = {127, 0, 0, 1},
+    },
+    &(pnet_Host) {
+        .internet = PNET_INTERNET_IPV4,
+        .transport = PNET_TRANSPORT_UDP,
+        .address = {127, 0, 0, 1},
+    },
+    NULL
+};
+
+static pnet_t client, server;
+static pnet_Host client_host, server_host;
+static bool is_open = false;
+static size_t answered;
+static uint8_t attachment[_ATTACHMENT_SIZE];
+static size_t attachment_size;
+
+static err_t Open(const pnet_Host *interface, const pnet_Profile *profile);
+static void Close(void);
+static err_t Request(uint32_t value, kint_t *nonce);
+static err_t Respond(void);
+static err_t AwaitResponse(const kint_t *nonce, uint32_t *value);
+static err_t AwaitAnswered(size_t count);
+static err_t Collect(size_t *count, uint32_t *sum);
+static err_t CollectAttached(const kint_t *nonces, size_t *offsets, size_t *count);
+
+static void TestRequestResponse(unit_T *T, void *_arg);
+static void TestPooledResponses(unit_T *T, void *_arg);
+static void TestLargeResponses(unit_T *T, void *_arg);
+
+void test_pnet_pnet_unit_c(unit_T *T) {
+    unit_RunTest(T, TestRequestResponse, (void **) DATA_Interfaces);
+    unit_RunTest(T, TestPooledResponses, (void **) DATA_TcpInterfaces);
+    unit_RunTest(T, TestLargeResponses, (void **) DATA_TcpInterfaces);
+}
+
+static void TestRequestResponse(unit_T *T, void *_arg) {
+    _TRY(T, Open(_arg, NULL));
+
+    // Every request is answered before the next is sent.
+    for (uint32_t i = 1; i <= 3; ++i) {
+        kint_t nonce;
+        uint32_t value = 0;
+        _TRY(T, Request(i, &nonce));
+        _TRY(T, AwaitResponse(&nonce, &value));
+        if (value != i) {
+            unit_FailF(T, "Expected response: %u; got: %u.", i, value);
+            goto leave;
+        }
+    }
+
+leave:
+    Close();
+}
+
+static void TestPooledResponses(unit_T *T, void *_arg) {
+    _TRY(T, Open(_arg, NULL));
+
+    // Each request takes the pooled connection of the previous one while the
+    // response to that request is yet to be read from it.
+    size_t count = 0;
+    uint32_t sum = 0;
+    for (uint32_t i = 1; i <= _REQUEST_COUNT; ++i) {
+        kint_t nonce;
+        _TRY(T, Request(i, &nonce));
+        _TRY(T, Collect(&count, &sum));
+        _TRY(T, AwaitAnswered(i));
+    }
+    const tims_t deadline = tims_Now() + _TIMEOUT;
+    while (count < _REQUEST_COUNT && tims_Now() < deadline) {
+        _TRY(T, Collect(&count, &sum));
+    }
+
+    const uint32_t expected = _REQUEST_COUNT * (_REQUEST_COUNT + 1) / 2;
+    if (count != _REQUEST_COUNT || sum != expected) {
+        unit_FailF(T, "Expected %d responses adding up to %u; got: %zu adding up to %u.",
+                   _REQUEST_COUNT, expected, count, sum);
+    }
+
+leave:
+    Close();
+}
+
+/*
+ * Only the server is opened with `profile`, which is NULL if the server is to
+ * use system defaults.
+ */
+static void TestLargeResponses(unit_T *T, void *_arg) {
+    // The server send buffer fits only a small part of each response, which
+    // makes the responses wait for their connection to become writable, and
+    // for each other to be sent in full.
+    _TRY(T, Open(_arg, &(pnet_Profile) {.send_buffer_size = 4096}));
+    for (size_t i = 0; i < _ATTACHMENT_SIZE; ++i) {
+        attachment[i] = (uint8_t) (i * 7 + i / 251);
+    }
+    attachment_size = _ATTACHMENT_SIZE;
+
+    kint_t nonces[_REQUEST_COUNT];
+    size_t offsets[_REQUEST_COUNT] = {0};
+    for (uint32_t i = 0; i < _REQUEST_COUNT; ++i) {
+        _TRY(T, Request(i, &nonces[i]));
+    }
+    size_t count = 0;
+    const tims_t deadline = tims_Now() + _TIMEOUT;
+    while (count < _REQUEST_COUNT && tims_Now() < deadline) {
+        _TRY(T, Respond());
+        _TRY(T, CollectAttached(nonces, offsets, &count));
+    }
+    if (count != _REQUEST_COUNT) {
+        unit_FailF(T, "Expected %d complete responses; got: %zu.", _REQUEST_COUNT, count);
+    }
+
+leave:
+    Close();
+}
+
+static err_t Open(const pnet_Host *interface, const pnet_Profile *profile) {
+    client_host = *interface;
+    server_host = *interface;
+
+    err_t err;
+    if ((err = pnet_Open(&client, &client_host)) != ERR_NONE) {
+        return err;
+    }
+    if ((err = pnet_OpenShardsWithProfile(&server, 1, &server_host, profile)) != ERR_NONE) {
+        pnet_Close(&client);
+        return err;
+    }
+    is_open = true;
+    answered = 0;
+    attachment_size = 0;
+    return ERR_NONE;
+}
+
+static void Close(void) {
+    if (is_open) {
+        pnet_Close(&client);
+        pnet_Close(&server);
+        is_open = false;
+    }
+}
+
+static err_t Request(uint32_t value, kint_t *nonce) {
+    pnet_Message *message = pnet_NewMessageWait(&client, sizeof(uint32_t), _TIMEOUT);
+    if (message == NULL) {
+        return ERR_TIMEOUT;
+    }
+    message->receiver = server_host;
+    message->nonce = kint_Random();
+    message->tag = _TAG;
+    mem_WriteU32BE(&message->data, value);
+    *nonce = message->nonce;
+    return pnet_SendWait(&client, message, _TIMEOUT);
+}
+
+/*
+ * Answers every request received by the server with a response carrying the
+ * same nonce and payload, followed by the first `attachment_size` bytes of
+ * `attachment`.
+ */
+static err_t Respond(void) {
+    pnet_Event *event;
+    err_t err;
+    while ((err = pnet_Poll(&server, &event)) == ERR_NONE && event != NULL) {
+        if (event->as_type != PNET_EVENT_MESSAGE) {
+            err = event->as_error.code;
+            pnet_FreeEvent(&server, event);
+            return err;
+        }
+        pnet_EventMessage *request = &event->as_message;
+        uint32_t value = 0;
+        mem_ReadU32BE(&request->data, &value);
+
+        pnet_Message *response = pnet_NewResponse(&server, request, sizeof(uint32_t));
+        if (response == NULL) {
+            pnet_FreeEvent(&server, event);
+            return ENOMEM;
+        }
+        response->nonce = request->nonce;
+        response->tag = _TAG;
+        mem_WriteU32BE(&response->data, value);
+        pnet_FreeEvent(&server, event);
+        if (attachment_size != 0 &&
+            (err = pnet_AttachPayload(&server, response, attachment, attachment_size,
+                                      NULL, NULL)) != ERR_NONE) {
+            return err;
+        }
+        if ((err = pnet_SendWait(&server, response, _TIMEOUT)) != ERR_NONE) {
+            return err;
+        }
+        answered += 1;
+    }
+    return err;
+}
+
+/*
+ * Waits for the response with the given `nonce` to be received by the client,
+ * while the server answers requests. Other messages, such as copies of earlier
+ * responses to retransmitted datagrams, are skipped. Any error event makes the
+ * wait fail.
+ */
+static err_t AwaitResponse(const kint_t *nonce, uint32_t *value) {
+    const tims_t deadline = tims_Now() + _TIMEOUT;
+    for (;;) {
+        if (tims_Now() >= deadline) {
+            return ERR_TIMEOUT;
+        }
+        err_t err;
+        if ((err = Respond()) != ERR_NONE) {
+            return err;
+        }
+        pnet_Event *event;
+        if ((err = pnet_PollWait(&client, &event, 0.001)) != ERR_NONE) {
+            return err;
+        }
+        if (event == NULL) {
+            continue;
+        }
+        if (event->as_type != PNET_EVENT_MESSAGE) {
+            err = event->as_error.code;
+            pnet_FreeEvent(&client, event);
+            return err;
+        }
+        const bool is_match = kint_EQU(&event->as_message.nonce, nonce);
+        if (is_match) {
+            mem_ReadU32BE(&event->as_message.data, value);
+        }
+        pnet_FreeEvent(&client, event);
+        if (is_match) {
+            return ERR_NONE;
+        }
+    }
+}
+
+/*
+ * Lets the server answer requests until `count` requests have been answered
+ * in total, after which the last response has been sent.
+ */
+static err_t AwaitAnswered(size_t count) {
+    const tims_t deadline = tims_Now() + _TIMEOUT;
+    while (answered < count) {
+        if (tims_Now() >= deadline) {
+            return ERR_TIMEOUT;
+        }
+        err_t err;
+        if ((err = Respond()) != ERR_NONE) {
+            return err;
+        }
+    }
+    return ERR_NONE;
+}
+
+/*
+ * Lets the client send and receive once, counting received responses in
+ * `count` and adding up their payloads in `sum`. Any error event makes the
+ * collection fail.
+ */
+static err_t Collect(size_t *count, uint32_t *sum) {
+    pnet_Event *event;
+    err_t err;
+    while ((err = pnet_Poll(&client, &event)) == ERR_NONE && event != NULL) {
+        if (event->as_type != PNET_EVENT_MESSAGE) {
+            err = event->as_error.code;
+            pnet_FreeEvent(&client, event);
+            return err;
+        }
+        uint32_t value = 0;
+        mem_ReadU32BE(&event->as_message.data, &value);
+        pnet_FreeEvent(&client, event);
+        *count += 1;
+        *sum += value;
+    }
+    return err;
+}
+
+/*
+ * Lets the client receive once, checking that every received part of the
+ * response to each request in `nonces` continues where the previous left off
+ * and carries the expected bytes. Offsets reached are kept in `offsets`, and
+ * complete responses are counted in `count`.
+ */
+static err_t CollectAttached(const kint_t *nonces, size_t *offsets, size_t *count) {
+    pnet_Event *event;
+    err_t err;
+    while ((err = pnet_PollWait(&client, &event, 0.001)) == ERR_NONE && event != NULL) {
+        if (event->as_type != PNET_EVENT_MESSAGE) {
+            err = event->as_error.code;
+            pnet_FreeEvent(&client, event);
+            return err;
+        }
+        pnet_EventMessage *message = &event->as_message;
+        size_t i = 0;
+        while (i < _REQUEST_COUNT && !kint_EQU(&nonces[i], &message->nonce)) {
+            i += 1;
+        }
+        const size_t size = mem_Capacity(&message->data);
+        bool is_valid = i < _REQUEST_COUNT && message->offset == offsets[i] &&
+                        message->offset + size <= sizeof(uint32_t) + _ATTACHMENT_SIZE;
+        for (size_t j = 0; is_valid && j < size; ++j) {
+            const size_t offset = message->offset + j;
+            const uint8_t expected = offset < sizeof(uint32_t)
+                ? (uint8_t) (i >> (8 * (sizeof(uint32_t) - 1 - offset)))
+                : attachment[offset - sizeof(uint32_t)];
+            is_valid = message->data.begin[j] == expected;
+        }
+        if (is_valid) {
+            offsets[i] += size;
+            if (!message->is_continued) {
+                is_valid = offsets[i] == sizeof(uint32_t) + _ATTACHMENT_SIZE;
+                *count += 1;
+            }
+        }
+        pnet_FreeEvent(&client, event);
+        if (!is_valid) {
+            return ERR_NOT_VALID;
+        }
+    }
+    return err;
+}
@@ -0,0 +1,201 @@
+#include <kdt/wheel.h>
+#include <unit/unit.h>
+
+typedef struct _Item _Item;
+
+struct _Item {
+    int value;
+    wheel_Timer timer;
+};
+
+#define _ASSERT_POP(T, WHEEL, NOW, VALUE) do {                               \
+    wheel_Timer *_t = wheel_Pop((WHEEL), (NOW));                             \
+    int _e = (VALUE);                                                        \
+    int _a = _t != NULL ? WHEEL_CONTAINER(_t, _Item, timer)->value : -1;     \
+    if (_e != _a) {                                                          \
+        unit_FailF((T), "At %f, expected: %d; got: %d.", (double) (NOW), _e, \
+                   _a);                                                      \
+        return;                                                              \
+    }                                                                        \
+} while (0)
+
+#define _ASSERT_NEXT(T, WHEEL, TIME) do {                                   \
+    tims_t _e = (TIME);                                                     \
+    tims_t _a = -1.0;                                                       \
+    wheel_Next((WHEEL), &_a);                                               \
+    if (_e != _a) {                                                         \
+        unit_FailF((T), "Expected next: %f; got: %f.", _e, _a);             \
+        return;                                                             \
+    }                                                                       \
+} while (0)
+
+static wheel_t wheel;
+static _Item items[512];
+
+static void TestArmAndPop(unit_T *T, void *_arg);
+static void TestCancel(unit_T *T, void *_arg);
+static void TestArmExpired(unit_T *T, void *_arg);
+static void TestFarFuture(unit_T *T, void *_arg);
+static void TestNext(unit_T *T, void *_arg);
+static void TestMany(unit_T *T, void *_arg);
+
+void test_wheel_unit_c(unit_T *T) {
+    unit_RunTest(T, TestArmAndPop, NULL);
+    unit_RunTest(T, TestCancel, NULL);
+    unit_RunTest(T, TestArmExpired, NULL);
+    unit_RunTest(T, TestFarFuture, NULL);
+    unit_RunTest(T, TestNext, NULL);
+    unit_RunTest(T, TestMany, NULL);
+}
+
+static void InitItems(void) {
+    for (size_t i = 0; i < sizeof(items) / sizeof(_Item); ++i) {
+        items[i].value = (int) i;
+        wheel_InitTimer(&items[i].timer);
+    }
+}
+
+static void TestArmAndPop(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    InitItems();
+    wheel_Init(&wheel, 1000.0, 1.0);
+
+    wheel_Arm(&wheel, &items[1].timer, 1005.0);
+    wheel_Arm(&wheel, &items[2].timer, 1003.0);
+    wheel_Arm(&wheel, &items[3].timer, 1070.0);
+    wheel_Arm(&wheel, &items[4].timer, 6000.0);
+    wheel_Arm(&wheel, &items[5].timer, 1002.5);
+
+    _ASSERT_POP(T, &wheel, 1001.0, -1);
+    _ASSERT_POP(T, &wheel, 1002.9, -1);
+    _ASSERT_POP(T, &wheel, 1003.0, 2);
+    _ASSERT_POP(T, &wheel, 1003.0, 5);
+    _ASSERT_POP(T, &wheel, 1003.0, -1);
+    _ASSERT_POP(T, &wheel, 1010.0, 1);
+    _ASSERT_POP(T, &wheel, 1069.0, -1);
+    _ASSERT_POP(T, &wheel, 1070.0, 3);
+    _ASSERT_POP(T, &wheel, 5999.9, -1);
+    _ASSERT_POP(T, &wheel, 6000.0, 4);
+    _ASSERT_POP(T, &wheel, 9000.0, -1);
+
+    if (wheel_IsArmed(&items[4].timer)) {
+        unit_Fail(T, "Expected popped timer to not be armed.");
+    }
+}
+
+static void TestCancel(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    InitItems();
+    wheel_Init(&wheel, 0.0, 0.5);
+
+    wheel_Arm(&wheel, &items[1].timer, 10.0);
+    wheel_Arm(&wheel, &items[2].timer, 10.0);
+    wheel_Arm(&wheel, &items[3].timer, 100.0);
+    wheel_Cancel(&wheel, &items[1].timer);
+    wheel_Cancel(&wheel, &items[3].timer);
+    wheel_Cancel(&wheel, &items[3].timer);
+
+    if (wheel_IsArmed(&items[1].timer) || !wheel_IsArmed(&items[2].timer)) {
+        unit_Fail(T, "Expected only timer 2 to be armed.");
+        return;
+    }
+    _ASSERT_POP(T, &wheel, 20.0, 2);
+    _ASSERT_POP(T, &wheel, 200.0, -1);
+
+    // Re-arming moves timer.
+    wheel_Arm(&wheel, &items[1].timer, 300.0);
+    wheel_Arm(&wheel, &items[1].timer, 250.0);
+    _ASSERT_POP(T, &wheel, 250.0, 1);
+    _ASSERT_POP(T, &wheel, 300.0, -1);
+}
+
+static void TestArmExpired(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    InitItems();
+    wheel_Init(&wheel, 50.0, 1.0);
+
+    wheel_Arm(&wheel, &items[1].timer, 50.0);
+    wheel_Arm(&wheel, &items[2].timer, 10.0);
+    wheel_Arm(&wheel, &items[3].timer, -1.0);
+    _ASSERT_POP(T, &wheel, 50.0, 1);
+    _ASSERT_POP(T, &wheel, 50.0, 2);
+    _ASSERT_POP(T, &wheel, 50.0, 3);
+    _ASSERT_POP(T, &wheel, 50.0, -1);
+}
+
+static void TestFarFuture(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    InitItems();
+    wheel_Init(&wheel, 0.0, 1.0);
+
+    // Beyond what the top wheel level can keep track of.
+    const tims_t far = 3.0 * (1u << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) + 17.0;
+    wheel_Arm(&wheel, &items[1].timer, far);
+    wheel_Arm(&wheel, &items[2].timer, 1.0);
+
+    _ASSERT_POP(T, &wheel, 1.0, 2);
+    _ASSERT_POP(T, &wheel, far / 2.0, -1);
+    _ASSERT_POP(T, &wheel, far - 1.0, -1);
+    _ASSERT_POP(T, &wheel, far, 1);
+}
+
+static void TestNext(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    InitItems();
+    wheel_Init(&wheel, 100.0, 1.0);
+
+    if (wheel_Next(&wheel, &(tims_t) {0})) {
+        unit_Fail(T, "Expected no next time.");
+        return;
+    }
+    wheel_Arm(&wheel, &items[1].timer, 5000.0);
+    _ASSERT_NEXT(T, &wheel, 4096.0);
+    wheel_Arm(&wheel, &items[2].timer, 120.0);
+    _ASSERT_NEXT(T, &wheel, 120.0);
+    _ASSERT_POP(T, &wheel, 120.0, 2);
+    _ASSERT_NEXT(T, &wheel, 4096.0);
+    _ASSERT_POP(T, &wheel, 4096.0, -1);
+    _ASSERT_NEXT(T, &wheel, 4992.0);
+    _ASSERT_POP(T, &wheel, 4992.0, -1);
+    _ASSERT_NEXT(T, &wheel, 5000.0);
+    wheel_Arm(&wheel, &items[3].timer, 0.0);
+    _ASSERT_NEXT(T, &wheel, 4992.0);
+}
+
+static void TestMany(unit_T *T, void *_arg) {
+    (void) _arg;
+
+    InitItems();
+    wheel_Init(&wheel, 0.0, 1.0);
+
+    const size_t count = sizeof(items) / sizeof(_Item);
+    uint32_t seed = 12345;
+    tims_t expires[sizeof(items) / sizeof(_Item)];
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        expires[i] = (tims_t) (seed % 300000u);
+        wheel_Arm(&wheel, &items[i].timer, expires[i]);
+    }
+
+    size_t popped = 0;
+    for (tims_t now = 0.0; now <= 300000.0; now += 7.0) {
+        wheel_Timer *timer;
+        while ((timer = wheel_Pop(&wheel, now)) != NULL) {
+            _Item *item = WHEEL_CONTAINER(timer, _Item, timer);
+            if (expires[item->value] > now || expires[item->value] <= now - 7.0) {
+                unit_FailF(T, "Timer %d expiring at %f popped at %f.",
+                           item->value, expires[item->value], now);
+                return;
+            }
+            popped += 1;
+        }
+    }
+    if (popped != count) {
+        unit_FailF(T, "Expected %zu timers popped; got %zu.", count, popped);
+    }
+}
@@ -3,11 +3,19 @@
 void test_kdm_internal_bucket_unit_c(unit_T *T);
 void test_kdm_contact_unit_c(unit_T *T);
 void test_kdm_internal_table_unit_c(unit_T *T);
+void test_pnet_internal_connections_unit_c(unit_T *T);
+void test_pnet_internal_pool_unit_c(unit_T *T);
+void test_pnet_internal_rtt_unit_c(unit_T *T);
+void test_pnet_internal_slab_unit_c(unit_T *T);
 void test_pnet_host_unit_c(unit_T *T);
+void test_pnet_pnet_unit_c(unit_T *T);
+void test_abitset_unit_c(unit_T *T);
 void test_bitset_unit_c(unit_T *T);
 void test_cbuf_unit_c(unit_T *T);
 void test_kint_unit_c(unit_T *T);
 void test_kvs_unit_c(unit_T *T);
+void test_mpmc_unit_c(unit_T *T);
+void test_wheel_unit_c(unit_T *T);
 
 int main() {
     unit_State state;
@@ -18,11 +26,23 @@ int main() {
     unit_RunSuite(&state, "test/kdm/internal/table.unit.c",
                   test_kdm_internal_table_unit_c);
     unit_RunSuite(&state, "test/kdm/contact.unit.c", test_kdm_contact_unit_c);
+    unit_RunSuite(&state, "test/pnet/internal/connections.unit.c",
+                  test_pnet_internal_connections_unit_c);
+    unit_RunSuite(&state, "test/pnet/internal/pool.unit.c",
+                  test_pnet_internal_pool_unit_c);
+    unit_RunSuite(&state, "test/pnet/internal/rtt.unit.c",
+                  test_pnet_internal_rtt_unit_c);
+    unit_RunSuite(&state, "test/pnet/internal/slab.unit.c",
+                  test_pnet_internal_slab_unit_c);
     unit_RunSuite(&state, "test/pnet/host.unit.c", test_pnet_host_unit_c);
+    unit_RunSuite(&state, "test/pnet/pnet.unit.c", test_pnet_pnet_unit_c);
+    unit_RunSuite(&state, "test/abitset.unit.c", test_abitset_unit_c);
     unit_RunSuite(&state, "test/bitset.unit.c", test_bitset_unit_c);
     unit_RunSuite(&state, "test/cbuf.unit.c", test_cbuf_unit_c);
     unit_RunSuite(&state, "test/kint.unit.c", test_kint_unit_c);
     unit_RunSuite(&state, "test/kvs.unit.c", test_kvs_unit_c);
+    unit_RunSuite(&state, "test/mpmc.unit.c", test_mpmc_unit_c);
+    unit_RunSuite(&state, "test/wheel.unit.c", test_wheel_unit_c);
 
     return unit_Term(&state);
 }
\ No newline at end of file